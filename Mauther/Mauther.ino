@@ -20,12 +20,16 @@
  */
 
 #include "config.h"
+#include "settings.h"
+#include "scheduler.h"
+#include "i2c_bus.h"
 #include "display.h"
 #include "actuators.h"
 #include "buttons.h"
 
 #ifdef FEATURE_DISTANCE_SENSOR
 #include "sensors.h"
+#include "alarm.h"
 #endif
 
 #ifdef FEATURE_RTC
@@ -36,19 +40,30 @@
 #include "badusb.h"
 #endif
 
+#ifdef FEATURE_LOGGER
+#include "logger.h"
+#endif
+
+#include "console.h"
+#include "power.h"
 #include "menu.h"
 
+#ifdef BENCH_MODE
+#include "bench.h"
+#endif
+
 void setup() {
+  Power::boot();  // Cold start or warm reset - before anything else
+
   #ifdef DEBUG_MODE
   Serial.begin(115200);
   #endif
 
+  // Fast boot: only what the main screen needs comes before the first
+  // frame. The distance sensor's blocking init and the rest follow it.
+  Settings::begin();  // RAM copy the other modules read from
+  I2CBus::begin();  // Shared by display, distance sensor and RTC
   Display::begin();
-  
-  #ifdef FEATURE_DISTANCE_SENSOR
-  Sensors::begin();
-  #endif
-  
   Actuators::begin();
   Buttons::begin();
   
@@ -56,25 +71,73 @@ void setup() {
   RTCModule::begin();
   #endif
   
+  Menu::begin();
+  Menu::update();  // First frame: time and temperature, distance once sampled
+  Power::bootFrameShown();
+
+  // LED/buzzer self-test after power on, or hold UP while booting
+  if (Power::isColdStart() || digitalRead(PIN_BUTTON_UP) == LOW) {
+    Buttons::swallowHeld();
+    Actuators::selfTest();
+  }
+  
+  #ifdef FEATURE_DISTANCE_SENSOR
+  Sensors::begin();
+  Alarm::begin();
+  #endif
+  
   #ifdef FEATURE_BADUSB
   BadUSB::begin();
   #endif
   
-  Menu::begin();
+  #ifdef FEATURE_LOGGER
+  Logger::begin();
+  #endif
 
-  Actuators::playBootSound();
-  delay(500);
-}
+  #ifdef FORMAT_BENCHMARK
+  while (!Serial && millis() < 5000) {}  // Give the host time to open the port
+  Format::benchmark();
+  #endif
 
-void loop() {
-  Buttons::update();
-  
+  // Periodic tasks: function, period (ms), deadline (us), profiler name
   #ifdef FEATURE_DISTANCE_SENSOR
-  Sensors::update();
+  Scheduler::add(Sensors::update, SCHED_TICK_MS, 1000, PROF_NAME("sensors"));
+  #endif
+  
+  Scheduler::add(Actuators::update, SCHED_TICK_MS, 500, PROF_NAME("actuators"));
+  Scheduler::add(Settings::update, 10, 5000, PROF_NAME("settings"));
+  
+  #ifdef FEATURE_RTC
+  Scheduler::add(RTCModule::update, 10, 1000, PROF_NAME("rtc"));
+  #endif
+  
+  #ifdef FEATURE_BADUSB
+  Scheduler::add(BadUSB::update, SCHED_TICK_MS, 5000, PROF_NAME("badusb"));
   #endif
   
-  Menu::update();
+  #ifdef FEATURE_LOGGER
+  Scheduler::add(Logger::update, 50, 5000, PROF_NAME("logger"));
+  #endif
+  
+  #if defined(FEATURE_CONSOLE) || defined(FEATURE_LOGGER)
+  Scheduler::add(Console::update, 20, 5000, PROF_NAME("console"));
+  #endif
   
-  delay(10);
+  Scheduler::add(Menu::update, 10, 30000, PROF_NAME("menu"));
+  
+  #ifdef FEATURE_PROFILER
+  Scheduler::add(Profiler::update, 100, 5000);
+  #endif
+
+  #ifdef BENCH_MODE
+  while (!Serial && millis() < 5000) {}  // Give the host time to open the port
+  Bench::run();
+  #endif
+}
+
+void loop() {
+  I2CBus::service();  // Keep queued I2C transfers moving between ticks
+  Scheduler::run();
+  Power::service();   // Sleeps here when the menu asked for it
 }
 
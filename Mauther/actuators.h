@@ -11,23 +11,259 @@
  *    - Requires Adafruit_NeoPixel library
  *    - True RGB color control
  *    - Used for status indicators
+ *
+ * LED effects (solid, breathing, blink codes, alarm strobe, self-test) are
+ * computed from millis() in update(), the actuators scheduler task. Levels
+ * go through a PROGMEM gamma table, then the color is scaled by the
+ * Settings brightness. strip.show() bit-bangs the WS2812 with interrupts
+ * off (~30us for the one pixel here), so it is only called when the output
+ * triple changes, and is put off to the next tick while an I2C transfer is
+ * on the wire. The button timer interrupt is held back by at most one
+ * show(), never lost. Each show() is timed as "led.show" in the profiler, and the
+ * debug screen's counters page shows how many there were and the longest.
+ *
+ * The buzzer plays melodies - PROGMEM tables of notes - in the background.
+ * tone() (Timer3) times each note to the microsecond and silences it; the
+ * sequencer in update() starts the next note at its scheduled time, which
+ * is counted from the previous schedule rather than from when the tick
+ * ran, so jitter stays within one SCHED_TICK_MS and never adds up.
  */
 
 #pragma once
 #include <Arduino.h>
 #include <Adafruit_NeoPixel.h>
 #include "config.h"
+#include "scheduler.h"
+#include "settings.h"
+#include "i2c_bus.h"
+#include "profiler.h"
 
 namespace Actuators {
   bool laserEnabled = false;
+
+  enum Effect {
+    FX_SOLID,
+    FX_BREATHE,      // Fades in and out over LED_BREATHE_MS
+    FX_BLINK,        // param flashes, then a pause
+    FX_STROBE,       // Short flashes - distance alarm
+    FX_SELFTEST      // Red, green, blue, then back to the color before it
+  };
+
   uint8_t ledR = 0, ledG = 0, ledB = 0;
-  
+  uint8_t effect = FX_SOLID;
+  uint8_t effectParam = 0;
+  unsigned long effectStart = 0;
+
   #ifdef FEATURE_LED
   // NeoPixel configuration
   #define NEOPIXEL_COUNT 1
   Adafruit_NeoPixel strip(NEOPIXEL_COUNT, PIN_RGB_LED, NEO_GRB + NEO_KHZ800);
+  uint8_t outR = 0, outG = 0, outB = 0;   // What the LED shows
+
+  // show() statistics since boot, on the debug screen's counters page
+  uint16_t showCount = 0;
+  uint16_t irqOffMaxUs = 0;
+  #ifdef FEATURE_PROFILER
+  uint8_t showProf = PROF_NONE;
+  #endif
+
+  // round(255 * (i / 255) ^ 2.2) - perceived brightness to PWM level
+  const uint8_t gamma8[256] PROGMEM = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+      3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+      6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+     12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+     20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+     30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+     42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+     56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+     73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+     91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+    113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+    163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+    192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255
+  };
+
+  // Rising half of a breath, 255 * (1 - cos(pi * i / 31)) / 2
+  #define BREATHE_STEPS 32
+  const uint8_t breatheWave[BREATHE_STEPS] PROGMEM = {
+      0,   1,   3,   6,  10,  16,  23,  31,  40,  49,  60,  71,  83,  96, 108, 121,
+    134, 147, 159, 172, 184, 195, 206, 215, 224, 232, 239, 245, 249, 252, 254, 255
+  };
+
+  // c * level / 255, exact at both ends
+  uint8_t scale(uint8_t c, uint8_t level) {
+    return ((uint16_t)c * (level + 1)) >> 8;
+  }
+
+  // Effect level (before gamma) t ms into the effect
+  uint8_t effectLevel(unsigned long t) {
+    switch (effect) {
+      case FX_BREATHE: {
+        uint8_t phase = (t % LED_BREATHE_MS) * (2 * BREATHE_STEPS) / LED_BREATHE_MS;
+        if (phase >= BREATHE_STEPS) phase = 2 * BREATHE_STEPS - 1 - phase;
+        return pgm_read_byte(&breatheWave[phase]);
+      }
+
+      case FX_BLINK: {
+        const uint16_t flash = LED_BLINK_ON_MS + LED_BLINK_OFF_MS;
+        uint16_t pos = t % ((unsigned long)effectParam * flash + LED_BLINK_PAUSE_MS);
+        return pos < effectParam * flash && pos % flash < LED_BLINK_ON_MS ? 255 : 0;
+      }
+
+      case FX_STROBE:
+        return t % LED_STROBE_MS < LED_STROBE_ON_MS ? 255 : 0;
+    }
+    return 255;
+  }
+
+  // Work out the output and show() it if it changed. force skips the wait
+  // for a quiet I2C bus (the output must be right before sleeping).
+  void render(bool force = false) {
+    unsigned long t = millis() - effectStart;
+    uint8_t r = ledR, g = ledG, b = ledB;
+    uint8_t level = 255;
+
+    if (effect == FX_SELFTEST) {
+      uint8_t step = t / LED_SELFTEST_STEP_MS;
+      if (step >= 4) {
+        effect = FX_SOLID;
+      } else {
+        r = step == 0 ? 255 : 0;
+        g = step == 1 ? 255 : 0;
+        b = step == 2 ? 255 : 0;
+      }
+    } else {
+      level = pgm_read_byte(&gamma8[effectLevel(t)]);
+    }
+
+    uint8_t brightness = Settings::values.ledBrightness;
+    r = scale(scale(r, level), brightness);
+    g = scale(scale(g, level), brightness);
+    b = scale(scale(b, level), brightness);
+    if (r == outR && g == outG && b == outB) return;
+
+    if (!force && !I2CBus::hardwareIdle()) return;
+
+    outR = r;
+    outG = g;
+    outB = b;
+    strip.setPixelColor(0, r, g, b);
+
+    unsigned long start = micros();
+    strip.show();
+    unsigned long us = micros() - start;
+    #ifdef FEATURE_PROFILER
+    Profiler::record(showProf, us);
+    #endif
+    showCount++;
+    if (us > irqOffMaxUs) irqOffMaxUs = us;
+  }
+
+  uint16_t getShowCount() {
+    return showCount;
+  }
+
+  // Longest show(), so the longest the button timer interrupt was held back
+  uint16_t getIrqOffMaxUs() {
+    return irqOffMaxUs;
+  }
   #endif
 
+  // ===== Buzzer Sequencer =====
+
+  struct Note {
+    uint16_t freq;   // Hz, 0 for a rest
+    uint16_t ms;     // 0 ends the melody
+  };
+
+  const Note melodyBoot[] PROGMEM = {
+    {BUZZER_BOOT_FREQ, 100}, {0, 0}
+  };
+
+  // Confirmation - two rising blips
+  const Note melodyChirp[] PROGMEM = {
+    {BUZZER_BEEP_FREQ, 30}, {0, 20}, {BUZZER_BEEP_FREQ * 3 / 2, 40}, {0, 0}
+  };
+
+  // Looped while the distance alarm is on (ALARM_BUZZER)
+  const Note melodyAlarm[] PROGMEM = {
+    {BUZZER_ALARM_FREQ, BUZZER_ALARM_DURATION},
+    {0, BUZZER_ALARM_INTERVAL - BUZZER_ALARM_DURATION},
+    {0, 0}
+  };
+
+  // Close or closing in fast - four times the rate
+  const Note melodyAlarmFast[] PROGMEM = {
+    {BUZZER_ALARM_FREQ, BUZZER_ALARM_DURATION / 2},
+    {0, BUZZER_ALARM_INTERVAL / 4 - BUZZER_ALARM_DURATION / 2},
+    {0, 0}
+  };
+
+  #ifdef FEATURE_BUZZER
+  const Note* melody = 0;          // Playing melody, 0 when silent
+  const Note* note = 0;
+  bool melodyLoop = false;
+  unsigned long noteStart = 0;     // Scheduled start of note
+  uint16_t noteMs = 0;
+
+  // Start note, or stop / loop at the end of the melody. late is how far
+  // behind its schedule the note starts; it comes off the tone so the
+  // note still ends on time.
+  void startNote(uint16_t late) {
+    noteMs = pgm_read_word(&note->ms);
+    if (!noteMs) {
+      if (!melodyLoop || note == melody) {
+        melody = 0;
+        noTone(PIN_BUZZER);
+        return;
+      }
+      note = melody;
+      noteMs = pgm_read_word(&note->ms);
+    }
+
+    uint16_t freq = pgm_read_word(&note->freq);
+    if (freq && late < noteMs) tone(PIN_BUZZER, freq, noteMs - late);
+    else noTone(PIN_BUZZER);
+  }
+
+  void updateSound() {
+    while (melody && millis() - noteStart >= noteMs) {
+      noteStart += noteMs;
+      note++;
+      startNote(millis() - noteStart);
+    }
+  }
+  #endif
+
+  // Play m from flash in the background, replacing anything playing
+  void play(const Note* m, bool loop = false) {
+    #ifdef FEATURE_BUZZER
+    melody = note = m;
+    melodyLoop = loop;
+    noteStart = millis();
+    startNote(0);
+    #endif
+  }
+
+  void stopSound() {
+    #ifdef FEATURE_BUZZER
+    melody = 0;
+    noTone(PIN_BUZZER);
+    #endif
+  }
+
+  bool isPlaying(const Note* m) {
+    #ifdef FEATURE_BUZZER
+    return melody == m;
+    #else
+    return false;
+    #endif
+  }
+
   void begin() {
     #ifdef FEATURE_BUZZER
     pinMode(PIN_BUZZER, OUTPUT);
@@ -35,23 +271,14 @@ namespace Actuators {
     #endif
     
     #ifdef FEATURE_LED
+    // Brightness is applied in render() - the strip's own setBrightness()
+    // rescales destructively
     strip.begin();
-    strip.setBrightness(50);
     strip.clear();
     strip.show();
-    
-    // Boot LED test - blink and turn off
-    strip.setPixelColor(0, strip.Color(255, 0, 0)); // Red
-    strip.show();
-    delay(200);
-    strip.setPixelColor(0, strip.Color(0, 255, 0)); // Green
-    strip.show();
-    delay(200);
-    strip.setPixelColor(0, strip.Color(0, 0, 255)); // Blue
-    strip.show();
-    delay(200);
-    strip.clear(); // Turn OFF
-    strip.show();
+    #ifdef FEATURE_PROFILER
+    showProf = Profiler::add(PROF_NAME("led.show"));
+    #endif
     #endif
     
     #ifdef FEATURE_LASER
@@ -61,22 +288,53 @@ namespace Actuators {
   }
 
 
-  void playBootSound() {
+  // Scheduler task - advances the LED effect and the melody
+  void update() {
     #ifdef FEATURE_BUZZER
-    tone(PIN_BUZZER, BUZZER_BOOT_FREQ, 100);
-    delay(150);
-    noTone(PIN_BUZZER);
+    updateSound();
+    #endif
+
+    #ifdef FEATURE_LED
+    render();
     #endif
   }
 
+  // Push the current LED state out now, e.g. before the MCU sleeps
+  void refresh() {
+    #ifdef FEATURE_LED
+    render(true);
+    #endif
+  }
+
+  void playBootSound() {
+    play(melodyBoot);
+  }
+
+  // Boot sound plus LED self-test (red, green, blue, back to the color
+  // before it). Only run after a cold start or on request - see setup().
+  void selfTest() {
+    playBootSound();
+    effect = FX_SELFTEST;
+    effectStart = millis();
+  }
+
 
   // ===== RGB LED Functions (NeoPixel) =====
-  
+
+  // Show color with an effect from the next update() on. Setting the
+  // effect that is already running leaves its timing alone.
+  void setEffect(uint8_t fx, uint8_t r, uint8_t g, uint8_t b, uint8_t param = 0) {
+    if (fx != effect || param != effectParam) effectStart = millis();
+    effect = fx;
+    effectParam = param;
+    ledR = r;
+    ledG = g;
+    ledB = b;
+  }
+
+  // Explicit colors win over the self-test
   void setLED(uint8_t r, uint8_t g, uint8_t b) {
-    #ifdef FEATURE_LED
-    strip.setPixelColor(0, strip.Color(r, g, b));
-    strip.show();
-    #endif
+    setEffect(FX_SOLID, r, g, b);
   }
 
   void setLEDRed() { setLED(255, 0, 0); }
@@ -0,0 +1,252 @@
+/*
+ * Alarm module - Distance alarm zones and time-to-contact
+ * Only include if FEATURE_DISTANCE_SENSOR is defined
+ *
+ * Runs from Sensors::onSample, right after every new filtered distance,
+ * so it fires on any screen and never waits for a redraw. Each zone has
+ * an enter and a clear value (hysteresis), a dwell time the condition must
+ * hold before the zone fires, and actions (ALARM_LED, ALARM_BUZZER,
+ * ALARM_WAKE). Zones are listed from mild to severe; the most severe
+ * active zone drives the LED and buzzer.
+ *
+ * The approach zone watches time to contact instead of distance: the
+ * approach speed is the EWMA of the change in filtered distance between
+ * samples, and time to contact is distance / speed.
+ *
+ * Sample-to-alarm latency (Sensors::readyUs to the end of the zone update)
+ * is kept per sample; the LED or buzzer follows on the next actuators
+ * tick (SCHED_TICK_MS). With the profiler it is the "alarm.lat" section.
+ */
+
+#pragma once
+
+#ifdef FEATURE_DISTANCE_SENSOR
+
+#include <Arduino.h>
+#include <util/atomic.h>
+#include "config.h"
+#include "sensors.h"
+#include "actuators.h"
+#include "settings.h"
+#include "profiler.h"
+
+namespace Alarm {
+  enum ZoneId {
+    ZONE_NEAR,
+    ZONE_APPROACH,
+    ZONE_CLOSE,
+    ZONE_COUNT,
+    ZONE_NONE = 0xFF
+  };
+
+  enum Kind {
+    KIND_DISTANCE,       // enter/clear in mm, 0 = alarm_mm / clear_mm
+    KIND_TTC             // enter/clear in ms to contact
+  };
+
+  struct Zone {
+    const char* name;    // PROGMEM
+    uint8_t kind;
+    uint16_t enter;      // Fires below this ...
+    uint16_t clear;      // ... clears above this
+    uint16_t dwellMs;
+    uint8_t actions;
+    uint8_t effect;      // Actuators::Effect with ALARM_LED
+    uint8_t r, g, b;
+    const Actuators::Note* melody;   // Looped with ALARM_BUZZER
+  };
+
+  const char nameNear[] PROGMEM = "near";
+  const char nameApproach[] PROGMEM = "approach";
+  const char nameClose[] PROGMEM = "close";
+
+  // Indexed by ZoneId, mild to severe
+  const Zone zones[] PROGMEM = {
+    {nameNear, KIND_DISTANCE, 0, 0, ALARM_NEAR_DWELL_MS, ALARM_NEAR_ACTIONS,
+     Actuators::FX_STROBE, LED_RED, Actuators::melodyAlarm},
+    {nameApproach, KIND_TTC, ALARM_TTC_MS, ALARM_TTC_CLEAR_MS, ALARM_TTC_DWELL_MS, ALARM_TTC_ACTIONS,
+     Actuators::FX_STROBE, LED_YELLOW, Actuators::melodyAlarmFast},
+    {nameClose, KIND_DISTANCE, ALARM_CLOSE_MM, ALARM_CLOSE_CLEAR_MM, ALARM_CLOSE_DWELL_MS, ALARM_CLOSE_ACTIONS,
+     Actuators::FX_SOLID, LED_RED, Actuators::melodyAlarmFast}
+  };
+  static_assert(sizeof(zones) / sizeof(zones[0]) == ZONE_COUNT, "zones out of sync with ZoneId");
+
+  uint8_t activeMask = 0;
+  uint8_t pendingMask = 0;       // Condition met, dwell running
+  unsigned long pendingSince[ZONE_COUNT];
+  uint8_t shown = ZONE_NONE;     // Zone driving the outputs
+  bool wakeRequested = false;
+
+  // Approach speed (mm/s, positive when closing in) and time to contact
+  uint16_t prevDistance = DISTANCE_MAX_RANGE + 1;
+  unsigned long prevUs = 0;
+  int32_t speed = 0;
+  bool speedValid = false;
+  uint16_t ttcMs = 0xFFFF;
+
+  uint16_t lastLatencyUs = 0;
+  uint16_t maxLatencyUs = 0;
+  #ifdef FEATURE_PROFILER
+  uint8_t latencyProf = PROF_NONE;
+  #endif
+
+  void updateSpeed(uint16_t distance, unsigned long us) {
+    if (distance > DISTANCE_MAX_RANGE || prevDistance > DISTANCE_MAX_RANGE) {
+      speed = 0;
+      speedValid = false;
+    } else if (us - prevUs > 0) {
+      int32_t now = ((int32_t)prevDistance - distance) * 1000000L / (int32_t)(us - prevUs);
+      // The first pair in range seeds the filter instead of ramping from 0
+      speed = speedValid ? speed + ((now - speed) >> ALARM_VELOCITY_SHIFT) : now;
+      speedValid = true;
+    }
+    prevDistance = distance;
+    prevUs = us;
+
+    ttcMs = 0xFFFF;
+    if (speed >= ALARM_TTC_MIN_SPEED) {
+      ttcMs = min((uint32_t)distance * 1000UL / speed, 0xFFFFUL);
+    }
+  }
+
+  // Drive LED and buzzer from zone z (ZONE_NONE: release them)
+  void show(uint8_t z) {
+    uint8_t prevActions = shown == ZONE_NONE ? 0 : pgm_read_byte(&zones[shown].actions);
+    uint8_t actions = z == ZONE_NONE ? 0 : pgm_read_byte(&zones[z].actions);
+    shown = z;
+
+    if (actions & ALARM_LED) {
+      Actuators::setEffect(pgm_read_byte(&zones[z].effect), pgm_read_byte(&zones[z].r),
+                           pgm_read_byte(&zones[z].g), pgm_read_byte(&zones[z].b));
+    } else if (prevActions & ALARM_LED) {
+      Actuators::setLEDOff();
+    }
+
+    if (actions & ALARM_BUZZER) {
+      const Actuators::Note* m = (const Actuators::Note*)pgm_read_ptr(&zones[z].melody);
+      if (!Actuators::isPlaying(m)) Actuators::play(m, true);
+    } else if (prevActions & ALARM_BUZZER) {
+      Actuators::stopSound();
+    }
+
+    #ifdef DEBUG_MODE
+    Serial.print(F("Alarm: "));
+    if (z == ZONE_NONE) Serial.print(F("clear"));
+    else Serial.print((const __FlashStringHelper*)pgm_read_ptr(&zones[z].name));
+    Serial.print(F(", latency (us): "));
+    Serial.println(lastLatencyUs);
+    #endif
+  }
+
+  // Sensors::onSample
+  void onSample() {
+    uint16_t distance = Sensors::getDistance();
+    unsigned long now = millis();
+    // Four bytes the data-ready interrupt may rewrite - copy them once
+    unsigned long readyUs;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      readyUs = Sensors::readyUs;
+    }
+    updateSpeed(distance, readyUs);
+
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      uint8_t bit = 1 << z;
+      uint16_t enter = pgm_read_word(&zones[z].enter);
+      uint16_t clear = pgm_read_word(&zones[z].clear);
+      uint16_t value = distance;
+      if (pgm_read_byte(&zones[z].kind) == KIND_TTC) {
+        value = ttcMs;
+      } else if (!enter) {
+        enter = Settings::values.alarmMm;
+        clear = Settings::values.alarmClearMm;
+      }
+
+      if (activeMask & bit) {
+        if (value > clear) activeMask &= ~bit;
+      } else if (value > 0 && value < enter) {
+        if (!(pendingMask & bit)) {
+          pendingMask |= bit;
+          pendingSince[z] = now;
+        }
+        if (now - pendingSince[z] >= pgm_read_word(&zones[z].dwellMs)) {
+          pendingMask &= ~bit;
+          activeMask |= bit;
+          if (pgm_read_byte(&zones[z].actions) & ALARM_WAKE) wakeRequested = true;
+        }
+      } else {
+        pendingMask &= ~bit;
+      }
+    }
+
+    uint8_t top = ZONE_NONE;
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      if (activeMask & (1 << z)) top = z;
+    }
+
+    lastLatencyUs = min(micros() - readyUs, 0xFFFFUL);
+    if (lastLatencyUs > maxLatencyUs) maxLatencyUs = lastLatencyUs;
+    #ifdef FEATURE_PROFILER
+    Profiler::record(latencyProf, lastLatencyUs);
+    #endif
+
+    if (top != shown) show(top);
+  }
+
+  void begin() {
+    #ifdef FEATURE_PROFILER
+    latencyProf = Profiler::add(PROF_NAME("alarm.lat"));
+    #endif
+    Sensors::onSample = onSample;
+  }
+
+  // Drop every zone and release the outputs (before sleep)
+  void reset() {
+    activeMask = pendingMask = 0;
+    speed = 0;
+    speedValid = false;
+    ttcMs = 0xFFFF;
+    prevDistance = DISTANCE_MAX_RANGE + 1;
+    if (shown != ZONE_NONE) show(ZONE_NONE);
+  }
+
+  // Put the outputs back after something else used the LED or buzzer
+  void restore() {
+    uint8_t z = shown;
+    shown = ZONE_NONE;
+    if (z != ZONE_NONE) show(z);
+  }
+
+  bool isActive() {
+    return activeMask != 0;
+  }
+
+  // Most severe active zone, ZONE_NONE if none
+  uint8_t getZone() {
+    return shown;
+  }
+
+  const char* getZoneName(uint8_t z) {
+    return (const char*)pgm_read_ptr(&zones[z].name);
+  }
+
+  uint16_t getTimeToContactMs() {
+    return ttcMs;
+  }
+
+  // True once per zone firing with ALARM_WAKE - Menu returns to the main screen
+  bool takeWake() {
+    bool w = wakeRequested;
+    wakeRequested = false;
+    return w;
+  }
+
+  uint16_t getLatencyUs() {
+    return lastLatencyUs;
+  }
+
+  uint16_t getMaxLatencyUs() {
+    return maxLatencyUs;
+  }
+}
+
+#endif // FEATURE_DISTANCE_SENSOR
@@ -2,6 +2,22 @@
  * BadUSB module - Handles keyboard emulation and DuckyScript execution
  * Based on WiFiDuck keyboard implementation
  * 
+ * Scripts are compiled from DuckyScript text by Tools/ducky_compile.py into
+ * badusb_scripts.h. The bytecode is read straight from flash, one keystroke
+ * or command per scheduler tick, so the menu can show progress and cancel.
+ * Scripts tagged for one OS are only listed while the badusb_os setting
+ * selects it; script indexes below count listed scripts only.
+ *
+ * Keystrokes bypass Keyboard.write: the module builds the 8-byte boot
+ * keyboard reports itself and sends them with HID().SendReport. STRING text
+ * packs up to six consecutive characters into one report when they share the
+ * same modifiers and no key repeats, with a report every
+ * BADUSB_REPORT_INTERVAL_US: report times advance from a target, so a tick
+ * sends up to BADUSB_REPORTS_PER_TICK reports to catch up with the gap
+ * since the last one. Key combos are held for BADUSB_KEYS_HOLD_MS.
+ * BADUSB_BENCHMARK adds a benchmark script and mirrors every report over
+ * serial for Tools/hid_check.py.
+ *
  * NOTE: This module adds ~2KB to flash size due to Keyboard library
  * Only include if FEATURE_BADUSB is defined in config.h
  */
@@ -13,58 +29,322 @@
 #include <Arduino.h>
 #include <Keyboard.h>
 #include "config.h"
+#include "scheduler.h"
+#include "settings.h"
+#include "badusb_scripts.h"
 
 namespace BadUSB {
+  enum Opcode {
+    OP_END,
+    OP_DELAY,          // u16 ms
+    OP_DEFAULT_DELAY,  // u16 ms
+    OP_STRING,         // u8 length, characters
+    OP_KEYS            // u8 count, key codes - pressed together
+  };
+
+  // Boot keyboard report (HID report id 2 in the Arduino HID core)
+  struct KeyReport {
+    uint8_t modifiers;
+    uint8_t reserved;
+    uint8_t keys[6];
+  };
+
+  // Flags in the Keyboard library's ASCII layout tables
+  #define LAYOUT_SHIFT   0x80
+  #define LAYOUT_ALT_GR  0x40
+  #define MOD_LEFT_SHIFT 0x02
+  #define MOD_RIGHT_ALT  0x40
+  #define HID_ISO_KEY         0x64
+  #define HID_ISO_REPLACEMENT 0x32
+
   bool isRunning = false;
 
+  // Interpreter state - the bytecode itself stays in flash
+  BadUSBScript script;
+  uint16_t pc = 0;
+  uint8_t stringLeft = 0;       // Characters of the current STRING still to type
+  bool keysHeld = false;
+  uint16_t defaultDelay = DEFAULT_DELAY_MS;
+  Timer wait;
+
+  // Report engine state
+  KeyReport lastReport;         // What the host currently sees as held
+  uint8_t lastKeyCount = 0;
+  unsigned long nextReportUs = 0;  // When the next STRING report is due
+
+  // Stats of the last STRING typed
+  uint16_t statChars = 0;
+  uint16_t statReports = 0;
+  unsigned long statStartUs = 0;
+  unsigned long statUs = 0;
+
   void begin() {
     Keyboard.begin();
   }
 
+  bool isListed(uint8_t i) {
+    uint8_t os = pgm_read_byte(&badusbScripts[i].os);
+    return os == BADUSB_OS_ANY || os == Settings::values.badusbOs;
+  }
+
+  // Table entry of the index-th listed script, BADUSB_SCRIPT_COUNT if none
+  uint8_t tableIndex(uint8_t index) {
+    for (uint8_t i = 0; i < BADUSB_SCRIPT_COUNT; i++) {
+      if (isListed(i) && index-- == 0) return i;
+    }
+    return BADUSB_SCRIPT_COUNT;
+  }
 
-  void runBrowserScript() {
-    if (isRunning) return;
-    isRunning = true;
-    
-    delay(500);
-    
-    #ifdef BADUSB_TARGET_MAC
-    // macOS: Open Spotlight (CMD+Space)
-    Keyboard.press(KEY_LEFT_GUI);
-    Keyboard.press(' ');
-    delay(100);
-    Keyboard.releaseAll();
-    delay(1000);  // Wait for Spotlight to open
-    
-    #elif defined(BADUSB_TARGET_WINDOWS)
-    // Windows: Open Run dialog (WIN+R)
-    Keyboard.press(KEY_LEFT_GUI);
-    Keyboard.press('r');
-    delay(100);
-    Keyboard.releaseAll();
-    delay(700);  // Wait for Run dialog
-    
-    #else
-    // Default: Try Windows method
-    Keyboard.press(KEY_LEFT_GUI);
-    Keyboard.press('r');
-    delay(100);
-    Keyboard.releaseAll();
-    delay(700);
+  uint8_t getScriptCount() {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < BADUSB_SCRIPT_COUNT; i++) n += isListed(i);
+    return n;
+  }
+
+  // Copy a script name out of flash
+  void getScriptName(uint8_t index, char* buffer, size_t bufferSize) {
+    uint8_t i = tableIndex(index);
+    if (i >= BADUSB_SCRIPT_COUNT) {
+      buffer[0] = '\0';
+      return;
+    }
+    const char* name = (const char*)pgm_read_ptr(&badusbScripts[i].name);
+    strncpy_P(buffer, name, bufferSize - 1);
+    buffer[bufferSize - 1] = '\0';
+  }
+
+  // HID usage and modifiers for an ASCII character. Returns false for
+  // characters the layout cannot type.
+  bool lookup(uint8_t c, uint8_t& usage, uint8_t& modifiers) {
+    if (c >= 128) return false;
+    uint8_t k = pgm_read_byte(KeyboardLayout_en_US + c);
+    if (!k) return false;
+
+    modifiers = 0;
+    if (k & LAYOUT_ALT_GR) {
+      modifiers = MOD_RIGHT_ALT;
+      k &= 0x3F;
+    } else if (k & LAYOUT_SHIFT) {
+      modifiers = MOD_LEFT_SHIFT;
+      k &= 0x7F;
+    }
+    if (k == HID_ISO_REPLACEMENT) k = HID_ISO_KEY;
+    usage = k;
+    return true;
+  }
+
+  bool lastReportHolds(uint8_t usage) {
+    for (uint8_t i = 0; i < lastKeyCount; i++) {
+      if (lastReport.keys[i] == usage) return true;
+    }
+    return false;
+  }
+
+  void sendReport(const KeyReport& r, uint8_t keyCount) {
+    HID().SendReport(2, &r, sizeof(r));
+    lastReport = r;
+    lastKeyCount = keyCount;
+    statReports++;
+
+    #ifdef BADUSB_BENCHMARK
+    // Mirror the report for Tools/hid_check.py
+    Serial.print('R');
+    for (uint8_t i = 0; i < sizeof(r); i++) {
+      Serial.print(' ');
+      Serial.print(((const uint8_t*)&r)[i], HEX);
+    }
+    Serial.println();
     #endif
-    
-    // Type the URL (works on both)
-    Keyboard.print("https://www.youtube.com/watch?v=e-xoYTHebs8&autoplay=1&mute=1");
-    delay(600);  // Longer delay after typing
-    
-    // Press Enter to open (explicit press and release)
-    Keyboard.press(KEY_RETURN);
-    delay(200);
-    Keyboard.release(KEY_RETURN);
-    
+  }
+
+  uint8_t next() {
+    return pgm_read_byte(script.code + pc++);
+  }
+
+  uint16_t nextWord() {
+    uint16_t lo = next();
+    return lo | (next() << 8);
+  }
+
+  // Pack as many of the next STRING characters as one report allows. A key
+  // still held from the previous report would not register as a new press,
+  // and a modifier change must not apply to keys still going down, so both
+  // end the report; an empty report (all keys up) is sent in between.
+  uint8_t buildReport(KeyReport& r) {
+    memset(&r, 0, sizeof(r));
+    uint8_t count = 0;
+
+    while (count < 6 && stringLeft) {
+      uint8_t usage, modifiers;
+      if (!lookup(pgm_read_byte(script.code + pc), usage, modifiers)) {
+        pc++;
+        stringLeft--;
+        continue;
+      }
+
+      if (count == 0) {
+        if (lastKeyCount && modifiers != lastReport.modifiers) break;
+        r.modifiers = modifiers;
+      } else if (modifiers != r.modifiers) {
+        break;
+      }
+      if (lastReportHolds(usage)) break;
+
+      bool repeated = false;
+      for (uint8_t i = 0; i < count; i++) {
+        if (r.keys[i] == usage) repeated = true;
+      }
+      if (repeated) break;
+
+      r.keys[count++] = usage;
+      pc++;
+      stringLeft--;
+      statChars++;
+    }
+    return count;
+  }
+
+  // Type the current STRING. Returns true once it is done and all keys are up.
+  // The due time advances by the interval per report, not from when the
+  // last one went out; a stall earns at most one tick's worth of reports.
+  bool typeStep() {
+    const unsigned long credit = (unsigned long)BADUSB_REPORT_INTERVAL_US * BADUSB_REPORTS_PER_TICK;
+    unsigned long now = micros();
+    if ((long)(now - nextReportUs) > (long)credit) nextReportUs = now - credit;
+
+    for (uint8_t i = 0; i < BADUSB_REPORTS_PER_TICK; i++) {
+      if (!stringLeft && !lastKeyCount) {
+        statUs = micros() - statStartUs;
+        return true;
+      }
+      if ((long)(micros() - nextReportUs) < 0) return false;
+
+      KeyReport r;
+      uint8_t count = buildReport(r);
+      if (count == 0) r.modifiers = 0;  // Release everything first
+      sendReport(r, count);
+      nextReportUs += BADUSB_REPORT_INTERVAL_US;
+    }
+    return false;
+  }
+
+  void run(uint8_t index) {
+    uint8_t i = tableIndex(index);
+    if (isRunning || i >= BADUSB_SCRIPT_COUNT) return;
+    memcpy_P(&script, &badusbScripts[i], sizeof(script));
+    pc = 0;
+    stringLeft = 0;
+    keysHeld = false;
+    defaultDelay = DEFAULT_DELAY_MS;
+    wait.set(0);
+    isRunning = true;
+  }
+
+  void releaseAll() {
+    KeyReport none = {};
+    sendReport(none, 0);
+    stringLeft = 0;
+    keysHeld = false;
+  }
+
+  void cancel() {
+    releaseAll();
     isRunning = false;
   }
+
+  // Percent of the bytecode executed
+  uint8_t getProgress() {
+    if (!isRunning || script.size == 0) return 0;
+    return (uint32_t)pc * 100 / script.size;
+  }
+
+  // Execute one step: a single keystroke or command.
+  // Returns true when the script has finished.
+  bool step() {
+    if (!wait.expired()) return false;
+
+    if (keysHeld) {
+      KeyReport none = {};
+      sendReport(none, 0);
+      keysHeld = false;
+      wait.set(defaultDelay);
+      return false;
+    }
+
+    if (stringLeft || lastKeyCount) {
+      if (typeStep()) {
+        wait.set(defaultDelay);
+
+        #ifdef BADUSB_BENCHMARK
+        Serial.print(F("BENCH chars="));
+        Serial.print(statChars);
+        Serial.print(F(" reports="));
+        Serial.print(statReports);
+        Serial.print(F(" us="));
+        Serial.print(statUs);
+        Serial.print(F(" cps="));
+        Serial.println(statUs ? statChars * 1000000UL / statUs : 0);
+        #endif
+      }
+      return false;
+    }
+
+    if (pc >= script.size) return true;
+
+    switch (next()) {
+      case OP_DELAY:
+        wait.set(nextWord());
+        break;
+      case OP_DEFAULT_DELAY:
+        defaultDelay = nextWord();
+        break;
+      case OP_STRING:
+        stringLeft = next();
+        statChars = 0;
+        statReports = 0;
+        statStartUs = micros();
+        nextReportUs = statStartUs;
+        break;
+      case OP_KEYS: {
+        // Keyboard.h key codes; held for BADUSB_KEYS_HOLD_MS, then released
+        KeyReport r = {};
+        uint8_t count = next();
+        uint8_t held = 0;
+        while (count--) {
+          uint8_t k = next();
+          uint8_t usage, modifiers;
+          if (k >= 0x88) {
+            if (held < 6) r.keys[held++] = k - 0x88;
+          } else if (k >= 0x80) {
+            r.modifiers |= 1 << (k - 0x80);
+          } else if (lookup(k, usage, modifiers) && held < 6) {
+            r.modifiers |= modifiers;
+            r.keys[held++] = usage;
+          }
+        }
+        sendReport(r, held);
+        keysHeld = true;
+        wait.set(BADUSB_KEYS_HOLD_MS);
+        break;
+      }
+      default:  // OP_END or unknown opcode
+        return true;
+    }
+    return false;
+  }
+
+  // Characters per second of the last STRING
+  uint16_t getLastTypingRate() {
+    return statUs ? statChars * 1000000UL / statUs : 0;
+  }
+
+  // Scheduler task
+  void update() {
+    if (isRunning && step()) {
+      releaseAll();
+      isRunning = false;
+    }
+  }
 }
 
 #endif // FEATURE_BADUSB
-
@@ -0,0 +1,114 @@
+/*
+ * BadUSB scripts - bytecode for the BadUSB interpreter
+ * Generated by Tools/ducky_compile.py from Tools/scripts - do not edit
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+#include "ui_text.h"
+
+struct BadUSBScript {
+  const char* name;      // PROGMEM
+  const uint8_t* code;   // PROGMEM
+  uint16_t size;
+  uint8_t os;            // BADUSB_OS_* the script is for
+};
+
+#ifdef BADUSB_BENCHMARK
+// benchmark.txt (446 bytes)
+UI_PSTR(badusbScript0Name, "Benchmark");
+const uint8_t badusbScript0Code[] PROGMEM = {
+  0x01, 0xD0, 0x07, 0x03, 0x36, 0x54, 0x68, 0x65, 0x20, 0x71, 0x75, 0x69,
+  0x63, 0x6B, 0x20, 0x62, 0x72, 0x6F, 0x77, 0x6E, 0x20, 0x66, 0x6F, 0x78,
+  0x20, 0x6A, 0x75, 0x6D, 0x70, 0x73, 0x20, 0x6F, 0x76, 0x65, 0x72, 0x20,
+  0x74, 0x68, 0x65, 0x20, 0x6C, 0x61, 0x7A, 0x79, 0x20, 0x64, 0x6F, 0x67,
+  0x20, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x04,
+  0x01, 0xB0, 0x03, 0x5F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27,
+  0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33,
+  0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F,
+  0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B,
+  0x4C, 0x4D, 0x4E, 0x4F, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57,
+  0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F, 0x60, 0x61, 0x62, 0x63,
+  0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F,
+  0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x7B,
+  0x7C, 0x7D, 0x7E, 0x04, 0x01, 0xB0, 0x03, 0x2A, 0x4D, 0x69, 0x73, 0x73,
+  0x69, 0x73, 0x73, 0x69, 0x70, 0x70, 0x69, 0x20, 0x62, 0x6F, 0x6F, 0x6B,
+  0x6B, 0x65, 0x65, 0x70, 0x65, 0x72, 0x20, 0x61, 0x61, 0x61, 0x61, 0x20,
+  0x41, 0x41, 0x41, 0x41, 0x20, 0x61, 0x41, 0x61, 0x41, 0x20, 0x31, 0x21,
+  0x31, 0x21, 0x04, 0x01, 0xB0, 0x03, 0xE7, 0x4C, 0x6F, 0x72, 0x65, 0x6D,
+  0x20, 0x69, 0x70, 0x73, 0x75, 0x6D, 0x20, 0x64, 0x6F, 0x6C, 0x6F, 0x72,
+  0x20, 0x73, 0x69, 0x74, 0x20, 0x61, 0x6D, 0x65, 0x74, 0x2C, 0x20, 0x63,
+  0x6F, 0x6E, 0x73, 0x65, 0x63, 0x74, 0x65, 0x74, 0x75, 0x72, 0x20, 0x61,
+  0x64, 0x69, 0x70, 0x69, 0x73, 0x63, 0x69, 0x6E, 0x67, 0x20, 0x65, 0x6C,
+  0x69, 0x74, 0x2C, 0x20, 0x73, 0x65, 0x64, 0x20, 0x64, 0x6F, 0x20, 0x65,
+  0x69, 0x75, 0x73, 0x6D, 0x6F, 0x64, 0x20, 0x74, 0x65, 0x6D, 0x70, 0x6F,
+  0x72, 0x20, 0x69, 0x6E, 0x63, 0x69, 0x64, 0x69, 0x64, 0x75, 0x6E, 0x74,
+  0x20, 0x75, 0x74, 0x20, 0x6C, 0x61, 0x62, 0x6F, 0x72, 0x65, 0x20, 0x65,
+  0x74, 0x20, 0x64, 0x6F, 0x6C, 0x6F, 0x72, 0x65, 0x20, 0x6D, 0x61, 0x67,
+  0x6E, 0x61, 0x20, 0x61, 0x6C, 0x69, 0x71, 0x75, 0x61, 0x2E, 0x20, 0x55,
+  0x74, 0x20, 0x65, 0x6E, 0x69, 0x6D, 0x20, 0x61, 0x64, 0x20, 0x6D, 0x69,
+  0x6E, 0x69, 0x6D, 0x20, 0x76, 0x65, 0x6E, 0x69, 0x61, 0x6D, 0x2C, 0x20,
+  0x71, 0x75, 0x69, 0x73, 0x20, 0x6E, 0x6F, 0x73, 0x74, 0x72, 0x75, 0x64,
+  0x20, 0x65, 0x78, 0x65, 0x72, 0x63, 0x69, 0x74, 0x61, 0x74, 0x69, 0x6F,
+  0x6E, 0x20, 0x75, 0x6C, 0x6C, 0x61, 0x6D, 0x63, 0x6F, 0x20, 0x6C, 0x61,
+  0x62, 0x6F, 0x72, 0x69, 0x73, 0x20, 0x6E, 0x69, 0x73, 0x69, 0x20, 0x75,
+  0x74, 0x20, 0x61, 0x6C, 0x69, 0x71, 0x75, 0x69, 0x70, 0x20, 0x65, 0x78,
+  0x20, 0x65, 0x61, 0x20, 0x63, 0x6F, 0x6D, 0x6D, 0x6F, 0x64, 0x6F, 0x20,
+  0x63, 0x6F, 0x6E, 0x73, 0x65, 0x71, 0x75, 0x61, 0x74, 0x2E, 0x04, 0x01,
+  0xB0, 0x00,
+};
+static_assert(sizeof(badusbScript0Code) <= MAX_SCRIPT_SIZE, "benchmark.txt too large");
+#endif
+
+// browser_mac.txt (80 bytes)
+UI_PSTR(badusbScript1Name, "Browser");
+const uint8_t badusbScript1Code[] PROGMEM = {
+  0x01, 0xF4, 0x01, 0x04, 0x02, 0x83, 0x20, 0x01, 0xE8, 0x03, 0x03, 0x3D,
+  0x68, 0x74, 0x74, 0x70, 0x73, 0x3A, 0x2F, 0x2F, 0x77, 0x77, 0x77, 0x2E,
+  0x79, 0x6F, 0x75, 0x74, 0x75, 0x62, 0x65, 0x2E, 0x63, 0x6F, 0x6D, 0x2F,
+  0x77, 0x61, 0x74, 0x63, 0x68, 0x3F, 0x76, 0x3D, 0x65, 0x2D, 0x78, 0x6F,
+  0x59, 0x54, 0x48, 0x65, 0x62, 0x73, 0x38, 0x26, 0x61, 0x75, 0x74, 0x6F,
+  0x70, 0x6C, 0x61, 0x79, 0x3D, 0x31, 0x26, 0x6D, 0x75, 0x74, 0x65, 0x3D,
+  0x31, 0x01, 0x58, 0x02, 0x04, 0x01, 0xB0, 0x00,
+};
+static_assert(sizeof(badusbScript1Code) <= MAX_SCRIPT_SIZE, "browser_mac.txt too large");
+
+// browser_windows.txt (80 bytes)
+UI_PSTR(badusbScript2Name, "Browser");
+const uint8_t badusbScript2Code[] PROGMEM = {
+  0x01, 0xF4, 0x01, 0x04, 0x02, 0x83, 0x72, 0x01, 0xBC, 0x02, 0x03, 0x3D,
+  0x68, 0x74, 0x74, 0x70, 0x73, 0x3A, 0x2F, 0x2F, 0x77, 0x77, 0x77, 0x2E,
+  0x79, 0x6F, 0x75, 0x74, 0x75, 0x62, 0x65, 0x2E, 0x63, 0x6F, 0x6D, 0x2F,
+  0x77, 0x61, 0x74, 0x63, 0x68, 0x3F, 0x76, 0x3D, 0x65, 0x2D, 0x78, 0x6F,
+  0x59, 0x54, 0x48, 0x65, 0x62, 0x73, 0x38, 0x26, 0x61, 0x75, 0x74, 0x6F,
+  0x70, 0x6C, 0x61, 0x79, 0x3D, 0x31, 0x26, 0x6D, 0x75, 0x74, 0x65, 0x3D,
+  0x31, 0x01, 0x58, 0x02, 0x04, 0x01, 0xB0, 0x00,
+};
+static_assert(sizeof(badusbScript2Code) <= MAX_SCRIPT_SIZE, "browser_windows.txt too large");
+
+// lock_mac.txt (6 bytes)
+UI_PSTR(badusbScript3Name, "Lock");
+const uint8_t badusbScript3Code[] PROGMEM = {
+  0x04, 0x03, 0x80, 0x83, 0x71, 0x00,
+};
+static_assert(sizeof(badusbScript3Code) <= MAX_SCRIPT_SIZE, "lock_mac.txt too large");
+
+// lock_windows.txt (5 bytes)
+UI_PSTR(badusbScript4Name, "Lock");
+const uint8_t badusbScript4Code[] PROGMEM = {
+  0x04, 0x02, 0x83, 0x6C, 0x00,
+};
+static_assert(sizeof(badusbScript4Code) <= MAX_SCRIPT_SIZE, "lock_windows.txt too large");
+
+const BadUSBScript badusbScripts[] PROGMEM = {
+  #ifdef BADUSB_BENCHMARK
+  {badusbScript0Name, badusbScript0Code, sizeof(badusbScript0Code), BADUSB_OS_ANY},
+  #endif
+  {badusbScript1Name, badusbScript1Code, sizeof(badusbScript1Code), BADUSB_OS_MAC},
+  {badusbScript2Name, badusbScript2Code, sizeof(badusbScript2Code), BADUSB_OS_WINDOWS},
+  {badusbScript3Name, badusbScript3Code, sizeof(badusbScript3Code), BADUSB_OS_MAC},
+  {badusbScript4Name, badusbScript4Code, sizeof(badusbScript4Code), BADUSB_OS_WINDOWS},
+};
+
+#define BADUSB_SCRIPT_COUNT (sizeof(badusbScripts) / sizeof(badusbScripts[0]))
@@ -0,0 +1,244 @@
+/*
+ * Bench module - Cycle counts, I2C bytes and stack depth for fixed scenarios
+ * Only included with BENCH_MODE
+ *
+ * Runs once at the end of setup(), with every module up and every task
+ * registered, and prints one line per scenario over serial:
+ *
+ *   BENCH name=<scenario> runs=<n> cycles=<min> max=<max> i2c=<bytes> stack=<bytes> free=<bytes>
+ *   BENCH done
+ *
+ * cycles is the fastest run and max the slowest, counted by Timer1 at
+ * F_CPU with no prescaler (overflows counted in software), less the cost
+ * of timing an empty call. Interrupts stay on, so max includes whatever
+ * millis, USB and the button tick took during the run. i2c is the I2C
+ * payload the last run queued (display bytes per frame), stack how far the
+ * deepest run went below the caller and free the RAM it never touched
+ * between the heap and that point. The I2C queue is drained, the
+ * scenario's preparation done and free RAM painted before every run,
+ * none of which is timed.
+ *
+ * Timer1 is taken over while the suite runs and put back afterwards.
+ * Tools/bench_report.py turns the lines into JSON and compares two runs.
+ * The host simulator runs the suite as well (Sim/tests/test_bench.cpp),
+ * with cycles from simulated time.
+ */
+
+#pragma once
+
+#ifdef BENCH_MODE
+
+#include <Arduino.h>
+#include "config.h"
+#include "i2c_bus.h"
+#include "display.h"
+#include "view.h"
+#include "buttons.h"
+#include "actuators.h"
+#include "scheduler.h"
+#include "menu.h"
+
+#ifdef FEATURE_DISTANCE_SENSOR
+#include "sensors.h"
+#include "alarm.h"
+#endif
+
+extern char __heap_start;
+extern char* __brkval;
+
+namespace Bench {
+  #define BENCH_RUNS 16
+  #define BENCH_PAINT 0xA5            // Free RAM fill for the stack high-water mark
+  #define BENCH_PAINT_MARGIN 16       // Left unpainted below paint()'s own frame
+
+  typedef void (*Fn)();
+
+  volatile uint16_t overflows = 0;
+  uint32_t emptyCycles = 0;           // Cost of timing an empty call
+  uint8_t step = 0;                   // Varies the input from run to run
+
+  // Timer1 count plus overflows, safe with interrupts on or off
+  uint32_t cycles() {
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t t = TCNT1;
+    uint16_t ovf = overflows;
+    if ((TIFR1 & _BV(TOV1)) && t < 0x8000) ovf++;   // Wrapped, ISR not run yet
+    SREG = sreg;
+    return ((uint32_t)ovf << 16) | t;
+  }
+
+  uint8_t* heapEnd() {
+    return __brkval ? (uint8_t*)__brkval : (uint8_t*)&__heap_start;
+  }
+
+  __attribute__((noinline)) void paint() {
+    uint8_t* end = (uint8_t*)SP - BENCH_PAINT_MARGIN;
+    for (uint8_t* p = heapEnd(); p < end; p++) *p = BENCH_PAINT;
+  }
+
+  // Lowest byte the runs overwrote
+  uint8_t* deepest(uint8_t* top) {
+    uint8_t* p = heapEnd();
+    while (p < top && *p == BENCH_PAINT) p++;
+    return p;
+  }
+
+  void measure(const __FlashStringHelper* name, Fn fn, Fn prepare = 0) {
+    uint32_t best = 0xFFFFFFFFUL, worst = 0;
+    unsigned long bytes = 0;
+    uint8_t* top = (uint8_t*)SP;
+    uint8_t* low = top;
+
+    for (uint8_t i = 0; i < BENCH_RUNS; i++) {
+      step = i;
+      I2CBus::flush();
+      if (prepare) prepare();
+      I2CBus::flush();
+      paint();
+
+      unsigned long before = Display::getTotalBytes();
+      uint32_t start = cycles();
+      fn();
+      uint32_t took = cycles() - start;
+      bytes = Display::getTotalBytes() - before;
+
+      took = took > emptyCycles ? took - emptyCycles : 0;
+      if (took < best) best = took;
+      if (took > worst) worst = took;
+      uint8_t* d = deepest(top);
+      if (d < low) low = d;
+    }
+
+    Serial.print(F("BENCH name="));
+    Serial.print(name);
+    Serial.print(F(" runs="));
+    Serial.print(BENCH_RUNS);
+    Serial.print(F(" cycles="));
+    Serial.print(best);
+    Serial.print(F(" max="));
+    Serial.print(worst);
+    Serial.print(F(" i2c="));
+    Serial.print(bytes);
+    Serial.print(F(" stack="));
+    Serial.print(top - low);
+    Serial.print(F(" free="));
+    Serial.println(low - heapEnd());
+  }
+
+  // ===== Scenarios =====
+
+  void nothing() {}
+
+  // Watch face: full frame, one second, a minute rollover, info line only
+  // and nothing changed
+  const char faceBefore[] = "12:34:58";
+  const char faceSecond[] = "12:34:59";
+  const char faceMinute[] = "12:35:00";
+
+  void drawFace(const char* time, uint16_t distance) {
+    Display::drawWatchFace(time, 93, distance, false);
+  }
+
+  void faceFullPrep()   { Display::invalidate(); }
+  void faceFullRun()    { drawFace(faceBefore, 850); }
+  void faceBeforePrep() { drawFace(faceBefore, 850); }
+  void faceSecondRun()  { drawFace(faceSecond, 850); }
+  void faceSecondPrep() { drawFace(faceSecond, 850); }
+  void faceMinuteRun()  { drawFace(faceMinute, 850); }
+  void faceInfoRun()    { drawFace(faceBefore, 600 + step); }
+  void faceIdleRun()    { drawFace(faceBefore, 850); }
+
+  // The current menu list (main menu at boot), selection moving down
+  void menuRun() {
+    uint8_t count = pgm_read_byte(&Menu::menuLists[Menu::currentList].count);
+    Display::drawMenuP("Menu", count, step % count, Menu::currentLabel);
+  }
+
+  // One pass of the 1kHz debounce tick, as the Timer0 ISR runs it
+  void buttonsTick() {
+    cli();
+    Buttons::onTick();
+    sei();
+  }
+
+  #ifdef FEATURE_LED
+  // LED colour change pushed out to the NeoPixel
+  void ledPrep() { Actuators::setLED(step & 1 ? 255 : 0, 64, 0); }
+  void ledRun()  { Actuators::render(true); }
+  #endif
+
+  #ifdef FEATURE_DISTANCE_SENSOR
+  void alarmPrep() { Sensors::readyUs = micros(); }
+  void alarmRun()  { Alarm::onSample(); }
+  #endif
+
+  // loop(): nothing due, and every task due with a full frame to draw
+  void loopIdlePrep() { Scheduler::lastTick = millis(); }
+  void loopAllPrep() {
+    Scheduler::resume();
+    Display::invalidate();
+    View::invalidate();
+    View::lastFrame = millis() - DISPLAY_UPDATE_MS;
+  }
+
+  void run() {
+    uint8_t tccr1a = TCCR1A, tccr1b = TCCR1B, timsk1 = TIMSK1;
+    TCCR1A = 0;
+    TCCR1B = _BV(CS10);              // Normal mode, F_CPU
+    TCNT1 = 0;
+    TIFR1 = _BV(TOV1);
+    TIMSK1 = _BV(TOIE1);
+
+    // Cheapest of a few empty timings is the offset taken off every run
+    emptyCycles = 0xFFFFFFFFUL;
+    for (uint8_t i = 0; i < BENCH_RUNS; i++) {
+      uint32_t start = cycles();
+      nothing();
+      uint32_t took = cycles() - start;
+      if (took < emptyCycles) emptyCycles = took;
+    }
+    Serial.print(F("BENCH f_cpu="));
+    Serial.print(F_CPU);
+    Serial.print(F(" overhead="));
+    Serial.println(emptyCycles);
+
+    measure(F("face_full"), faceFullRun, faceFullPrep);
+    measure(F("face_second"), faceSecondRun, faceBeforePrep);
+    measure(F("face_minute"), faceMinuteRun, faceSecondPrep);
+    measure(F("face_info"), faceInfoRun, faceBeforePrep);
+    measure(F("face_idle"), faceIdleRun, faceBeforePrep);
+    measure(F("menu"), menuRun);
+    measure(F("buttons_tick"), buttonsTick);
+    #ifdef FEATURE_LED
+    measure(F("led_render"), ledRun, ledPrep);
+    #endif
+    #ifdef FEATURE_DISTANCE_SENSOR
+    measure(F("alarm"), alarmRun, alarmPrep);
+    #endif
+    measure(F("loop_idle"), loop, loopIdlePrep);
+    measure(F("loop_all"), loop, loopAllPrep);
+    Serial.println(F("BENCH done"));
+
+    TIMSK1 = timsk1;
+    TCCR1A = tccr1a;
+    TCCR1B = tccr1b;
+
+    // Put back what the scenarios disturbed
+    #ifdef FEATURE_DISTANCE_SENSOR
+    Alarm::reset();
+    #endif
+    Actuators::setLEDOff();
+    Display::invalidate();
+    View::invalidate();
+    Scheduler::maxPassUs = 0;
+    Scheduler::windowMaxUs = 0;
+    Scheduler::resume();
+  }
+}
+
+ISR(TIMER1_OVF_vect) {
+  Bench::overflows++;
+}
+
+#endif // BENCH_MODE
@@ -1,5 +1,12 @@
 /*
  * Buttons module - Handles button inputs with debouncing
+ *
+ * Interrupt driven: a pin-change interrupt records raw edges, and a 1kHz
+ * timer interrupt (Timer0 compare A, next to the millis() overflow) debounces
+ * them and pushes timestamped events into a small ring buffer. Nothing is
+ * lost if several presses arrive before Menu gets to them.
+ *
+ * All three buttons (pins 8, 9, 10) sit on PORTB / PCINT0 on the Leonardo.
  */
 
 #pragma once
@@ -21,69 +28,190 @@ namespace Buttons {
     EVT_LONG_PRESS
   };
 
+  struct Event {
+    uint8_t button;       // Button
+    uint8_t type;         // ButtonEvent
+    unsigned long time;   // millis() when the event was detected
+  };
+
   struct ButtonState {
     uint8_t pin;
-    bool lastState;
-    bool currentState;
+    uint8_t mask;         // Bit in the PCINT port
+    bool rawState;        // Last level seen by the pin-change ISR
+    bool currentState;    // Debounced state
+    uint8_t changeTime;   // Low byte of millis() at the last raw edge
     unsigned long pressTime;
     bool longPressTriggered;
   };
 
-  ButtonState buttons[3] = {
-    {PIN_BUTTON_UP, HIGH, HIGH, 0, false},
-    {PIN_BUTTON_DOWN, HIGH, HIGH, 0, false},
-    {PIN_BUTTON_SEL, HIGH, HIGH, 0, false}
+  volatile ButtonState buttons[3] = {
+    {PIN_BUTTON_UP, 0, HIGH, HIGH, 0, 0, false},
+    {PIN_BUTTON_DOWN, 0, HIGH, HIGH, 0, 0, false},
+    {PIN_BUTTON_SEL, 0, HIGH, HIGH, 0, 0, false}
   };
 
-  Button lastPressed = BTN_NONE;
+  volatile uint8_t* inputPort;
+
+  // Event ring buffer - written by the timer ISR, read by the main loop
+  volatile Event queue[BUTTON_QUEUE_SIZE];
+  volatile uint8_t queueHead = 0;
+  volatile uint8_t queueTail = 0;
+  volatile uint8_t droppedEvents = 0;
+  volatile uint8_t swallowMask = 0;   // Buttons whose current press is ignored
+
+  // Copy of every event as button << 4 | type for telemetry, which must
+  // not take them from Menu. Drained by takeTrace(); events that find it
+  // full are counted as lost instead.
+  volatile uint8_t trace[BUTTON_TRACE_SIZE];
+  volatile uint8_t traceHead = 0;
+  volatile uint8_t traceCount = 0;
+  volatile bool traceLost = false;
+
   ButtonEvent lastEvent = EVT_NONE;
 
+  // Called from the timer ISR, or with interrupts off
+  void push(uint8_t button, uint8_t type, unsigned long time) {
+    if (traceCount < BUTTON_TRACE_SIZE) {
+      trace[(traceHead + traceCount++) & (BUTTON_TRACE_SIZE - 1)] = (button << 4) | type;
+    } else {
+      traceLost = true;
+    }
+
+    uint8_t next = (queueHead + 1) & (BUTTON_QUEUE_SIZE - 1);
+    if (next == queueTail) {
+      droppedEvents++;
+      return;
+    }
+    queue[queueHead].button = button;
+    queue[queueHead].type = type;
+    queue[queueHead].time = time;
+    queueHead = next;
+  }
+
   void begin() {
     pinMode(PIN_BUTTON_UP, INPUT_PULLUP);
     pinMode(PIN_BUTTON_DOWN, INPUT_PULLUP);
     pinMode(PIN_BUTTON_SEL, INPUT_PULLUP);
+
+    inputPort = portInputRegister(digitalPinToPort(PIN_BUTTON_UP));
+
+    for (int i = 0; i < 3; i++) {
+      uint8_t pin = buttons[i].pin;
+      buttons[i].mask = digitalPinToBitMask(pin);
+      buttons[i].rawState = (*inputPort & buttons[i].mask) ? HIGH : LOW;
+      *digitalPinToPCMSK(pin) |= _BV(digitalPinToPCMSKbit(pin));
+      *digitalPinToPCICR(pin) |= _BV(digitalPinToPCICRbit(pin));
+    }
+
+    // Debounce tick: Timer0 already runs for millis(), borrow compare A
+    OCR0A = 0x80;
+    TIMSK0 |= _BV(OCIE0A);
   }
 
-  void update() {
-    unsigned long now = millis();
-    
+  // Raw edge capture
+  void onPinChange() {
+    uint8_t pins = *inputPort;
+    uint8_t now = millis();
+
     for (int i = 0; i < 3; i++) {
-      bool reading = digitalRead(buttons[i].pin);
-      
-      // Only update if state is stable (debouncing)
-      if (reading != buttons[i].lastState) {
-        delay(BUTTON_DEBOUNCE_MS);  // Simple debounce delay
-        reading = digitalRead(buttons[i].pin);
-      }
-      
-      if (reading == LOW && buttons[i].lastState == HIGH) {
-        buttons[i].currentState = LOW;
-        buttons[i].pressTime = now;
-        buttons[i].longPressTriggered = false;
+      bool level = (pins & buttons[i].mask) ? HIGH : LOW;
+      if (level != buttons[i].rawState) {
+        buttons[i].rawState = level;
+        buttons[i].changeTime = now;
       }
-      else if (reading == HIGH && buttons[i].lastState == LOW) {
-        buttons[i].currentState = HIGH;
-        unsigned long pressDuration = now - buttons[i].pressTime;
-        
-        if (pressDuration > BUTTON_LONG_PRESS_MS) {
-          lastPressed = (Button)(i + 1);
-          lastEvent = EVT_LONG_PRESS;
-        } else if (pressDuration > BUTTON_DEBOUNCE_MS) {
-          lastPressed = (Button)(i + 1);
-          lastEvent = EVT_RELEASE;
+    }
+  }
+
+  // Debounce and long-press detection, ~1kHz
+  void onTick() {
+    unsigned long now = millis();
+
+    for (int i = 0; i < 3; i++) {
+      volatile ButtonState& b = buttons[i];
+
+      bool stable = (uint8_t)((uint8_t)now - b.changeTime) >= BUTTON_DEBOUNCE_MS;
+
+      if (b.rawState != b.currentState) {
+        // Only accept the level once it has been stable long enough
+        if (!stable) continue;
+        b.currentState = b.rawState;
+
+        if (b.currentState == LOW) {
+          b.pressTime = now;
+          // A swallowed press produces no events at all
+          b.longPressTriggered = swallowMask & _BV(i);
+          if (!b.longPressTriggered) push(i + 1, EVT_PRESS, now);
+        } else {
+          swallowMask &= ~_BV(i);
+          if (!b.longPressTriggered) push(i + 1, EVT_RELEASE, now);
         }
+      } else if (b.currentState == HIGH) {
+        // Tap too short to get through the debounce
+        if (stable) swallowMask &= ~_BV(i);
+      } else if (b.currentState == LOW && !b.longPressTriggered &&
+                 now - b.pressTime >= BUTTON_LONG_PRESS_MS) {
+        // Fire while still held - the release is then swallowed
+        b.longPressTriggered = true;
+        push(i + 1, EVT_LONG_PRESS, now);
       }
-      
-      buttons[i].lastState = reading;
     }
   }
 
+  // Queue a click (press + release) or a long press as if the button had
+  // been used - for scripted input over the console
+  void inject(Button btn, bool longPress) {
+    unsigned long now = millis();
+    noInterrupts();
+    push(btn, EVT_PRESS, now);
+    push(btn, longPress ? EVT_LONG_PRESS : EVT_RELEASE, now);
+    interrupts();
+  }
+
+  // True while any button pin reads pressed, debounced or not
+  bool anyHeld() {
+    uint8_t pins = *inputPort;
+    for (int i = 0; i < 3; i++) {
+      if (!(pins & buttons[i].mask)) return true;
+    }
+    return false;
+  }
+
+  // Ignore the presses in progress (e.g. the one that woke the watch) -
+  // they produce no press, release or long press events
+  void swallowHeld() {
+    uint8_t pins = *inputPort;
+    noInterrupts();
+    for (int i = 0; i < 3; i++) {
+      if (pins & buttons[i].mask) continue;
+      swallowMask |= _BV(i);
+      if (buttons[i].currentState == LOW) buttons[i].longPressTriggered = true;
+    }
+    interrupts();
+  }
+
+  // Pop the next event of any type. Returns false if the queue is empty.
+  bool pollEvent(Event& evt) {
+    if (queueTail == queueHead) return false;
+    evt.button = queue[queueTail].button;
+    evt.type = queue[queueTail].type;
+    evt.time = queue[queueTail].time;
+    queueTail = (queueTail + 1) & (BUTTON_QUEUE_SIZE - 1);
+    return true;
+  }
+
+  // Next completed press (click or long press); press-down events are skipped
   Button getLastPressed() {
-    Button btn = lastPressed;
-    lastPressed = BTN_NONE;
-    return btn;
+    Event evt;
+    while (pollEvent(evt)) {
+      if (evt.type != EVT_PRESS) {
+        lastEvent = (ButtonEvent)evt.type;
+        return (Button)evt.button;
+      }
+    }
+    return BTN_NONE;
   }
 
+  // Kind of the press last returned by getLastPressed()
   ButtonEvent getLastEvent() {
     ButtonEvent evt = lastEvent;
     lastEvent = EVT_NONE;
@@ -94,5 +222,31 @@ namespace Buttons {
     if (btn == BTN_NONE || btn > BTN_SELECT) return false;
     return buttons[btn - 1].currentState == LOW;
   }
+
+  // Move the traced events, oldest first, to out (BUTTON_TRACE_SIZE
+  // bytes). Returns how many; lost is set if any were lost since the
+  // previous call.
+  uint8_t takeTrace(uint8_t* out, bool& lost) {
+    noInterrupts();
+    uint8_t n = traceCount;
+    for (uint8_t i = 0; i < n; i++) out[i] = trace[(traceHead + i) & (BUTTON_TRACE_SIZE - 1)];
+    traceHead = (traceHead + n) & (BUTTON_TRACE_SIZE - 1);
+    traceCount = 0;
+    lost = traceLost;
+    traceLost = false;
+    interrupts();
+    return n;
+  }
+
+  uint8_t getDroppedEvents() {
+    return droppedEvents;
+  }
 }
 
+ISR(PCINT0_vect) {
+  Buttons::onPinChange();
+}
+
+ISR(TIMER0_COMPA_vect) {
+  Buttons::onTick();
+}
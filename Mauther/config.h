@@ -11,22 +11,30 @@
 // ===== Debug Mode =====
 // #define DEBUG_MODE  // Uncomment ONLY for development (costs ~1KB)
 // Keep disabled for production to save space!
+// #define BENCH_MODE  // Cycle counts, I2C bytes, stack depth per scenario at boot (serial)
 
 // ===== Optional Features (comment out to save space) =====
 // Enable only what you need to fit in 28KB flash:
 #define FEATURE_DISTANCE_SENSOR  // VL53L0X support (~2KB)
 #define FEATURE_RTC              // DS3231 RTC support (~1KB)
 #define FEATURE_BADUSB           // BadUSB keyboard emulation (~2KB)
-#define FEATURE_BUZZER           // Buzzer - ONLY for boot sound
+#define FEATURE_BUZZER           // Buzzer - boot sound (more below)
 #define FEATURE_LED              // RGB LED control
 #define FEATURE_LASER            // Laser pointer control
+// #define FEATURE_LOGGER        // Distance/temperature history log (~1KB)
+// #define FEATURE_CONSOLE       // Scripted buttons, screenshots, control protocol over USB serial
+// #define FEATURE_PROFILER      // Run time histograms + debug screen (~1KB)
 
-// Note: Buzzer only plays on device startup, all other sounds disabled
+// Note: By default the buzzer only plays on a cold start - see Buzzer Settings
 
 // ===== BadUSB Target OS =====
-// Choose target OS for BadUSB scripts (only one should be defined)
+// Default target OS for BadUSB scripts (only one should be defined).
+// Scripts for both are built in; switch at runtime in System > Settings.
 #define BADUSB_TARGET_MAC        // macOS (CMD+Space → Spotlight)
 // #define BADUSB_TARGET_WINDOWS // Windows (WIN+R → Run dialog)
+#define BADUSB_OS_MAC     0      // Script OS tags = values of the badusb_os setting
+#define BADUSB_OS_WINDOWS 1
+#define BADUSB_OS_ANY     0xFF
 
 // ===== Pin Definitions =====
 #define PIN_BUZZER      12
@@ -46,19 +54,101 @@
 #define VL53L0X_ADDR    0x29
 #define DS3231_ADDR     0x68
 
+// ===== I2C Bus Settings =====
+#define I2C_CLOCK_HZ   400000
+#define I2C_QUEUE_LEN  2       // Pending high priority transactions (sensor, RTC)
+#define I2C_LOW_QUEUE_LEN 7    // Display: a page row is a command + 6 data transfers
+#define I2C_MAX_XFER   32      // Bytes per transaction (Wire buffer size)
+#define I2C_TIMEOUT_US 5000    // Wire timeout for a single transfer
+#define I2C_STUCK_MS   25      // Background write still busy -> recover the bus
+
+// ===== RTC Settings =====
+// #define PIN_RTC_SQW 7         // DS3231 INT/SQW wired to an interrupt pin (optional)
+#define RTC_RESYNC_MS     60000  // Burst-read time + temperature this often
+#define RTC_ALIGN_POLL_MS 20     // Seconds-register polling while finding the tick
+
 // ===== Display Settings =====
 #define SCREEN_WIDTH    128
 #define SCREEN_HEIGHT   64
-#define DISPLAY_UPDATE_MS 100
+#define DISPLAY_UPDATE_MS 40       // Minimum time between frames (max 25 fps)
+#define DISPLAY_DEFAULT_CONTRAST 255
+#define VIEW_MAX_INPUT_BYTES 16    // Largest per-screen inputs struct (view.h)
+#define DISPLAY_DIRTY_TILES        // Send only changed parts of each page over I2C
+#define DISPLAY_CHUNK_TILES 4      // 8x8 tiles per tracked chunk (2 bytes RAM per chunk)
+// #define FORMAT_BENCHMARK        // Time number formatting vs snprintf at boot (serial)
 
 // ===== Distance Sensor Settings =====
+// Alarm defaults - adjustable in System > Settings, stored in EEPROM
 #define DISTANCE_ALARM_THRESHOLD 1000  // mm (1 meter) - trigger alarm
 #define DISTANCE_ALARM_CLEAR     1100  // mm - clear alarm (hysteresis to prevent buzzing)
 #define DISTANCE_MAX_RANGE       1200  // mm (1.2 meters)
+#define SENSOR_TIMEOUT_MS        500   // No new sample for this long -> out of range
+// #define PIN_VL53_GPIO1 1              // VL53L0X GPIO1 (data ready) wired to an interrupt pin
+#define SENSOR_POLL_MS           10    // Data-ready polling when GPIO1 is not wired
+#define SENSOR_RING_SIZE         8     // Timestamped samples kept for filtering
+#define SENSOR_MEDIAN_WINDOW     5     // Newest samples used by the median filter
+#define SENSOR_EWMA_SHIFT        2     // EWMA weight of a new sample = 1/2^shift
+#define SENSOR_DEFAULT_FILTER    1     // 0 none, 1 median, 2 EWMA (until changed in Settings)
+
+// ===== Distance Alarm Zones =====
+// Checked after every sample, on any screen. A zone fires once its
+// condition has held for its dwell time and clears past its clear value;
+// the most severe active zone (lowest in this list) drives the outputs.
+// Actions: ALARM_LED, ALARM_BUZZER (add it for an audible alarm), and
+// ALARM_WAKE (jump back to the main screen from any menu).
+#define ALARM_LED    0x01
+#define ALARM_BUZZER 0x02
+#define ALARM_WAKE   0x04
+// Near: DISTANCE_ALARM_THRESHOLD / _CLEAR, i.e. alarm_mm / clear_mm in Settings
+#define ALARM_NEAR_DWELL_MS      100
+#define ALARM_NEAR_ACTIONS       (ALARM_LED)
+// Approach: time to contact at the filtered approach speed
+#define ALARM_TTC_MS             800   // Fires below this many ms to contact
+#define ALARM_TTC_CLEAR_MS       1500
+#define ALARM_TTC_DWELL_MS       60    // About two samples
+#define ALARM_TTC_MIN_SPEED      150   // mm/s - slower approaches never fire
+#define ALARM_TTC_ACTIONS        (ALARM_LED)
+#define ALARM_VELOCITY_SHIFT     2     // EWMA weight of a new speed = 1/2^shift
+// Close
+#define ALARM_CLOSE_MM           300
+#define ALARM_CLOSE_CLEAR_MM     400
+#define ALARM_CLOSE_DWELL_MS     0
+#define ALARM_CLOSE_ACTIONS      (ALARM_LED | ALARM_WAKE)
+
+// ===== EEPROM Layout =====
+#define EEPROM_ADDR_SETTINGS 0        // Settings records, wear leveled over the slots
+#define SETTINGS_SLOTS       4
+#define SETTINGS_SLOT_SIZE   16
+#define EEPROM_ADDR_LOG      64        // Logger blocks, up to the end of EEPROM
+
+// ===== Settings =====
+#define SETTINGS_SAVE_DELAY_MS 5000    // Save once values are left alone this long
+
+// ===== Logger Settings =====
+#define LOG_INTERVAL_MS   60000   // One sample per minute
+#define LOG_BLOCK_SIZE    32      // Bytes per block: 11 byte header + deltas + CRC
+#define LOG_RAM_BLOCKS    4       // RAM ring (LOG_RAM_BLOCKS * LOG_BLOCK_SIZE bytes)
+#define LOG_EEPROM_FLUSH          // Copy full blocks to EEPROM (~10h at 1/min)
+
+// ===== Scheduler Settings =====
+#define SCHED_TICK_MS          5      // Base tick - task periods are multiples of this
+#define SCHED_MAX_TASKS        10
+#define SCHED_LATENCY_BOUND_US 30000  // Worst loop pass allowed before DEBUG_MODE warns
+
+// ===== Control Protocol Settings =====
+#define CONTROL_FRAME_MAX          40   // Largest decoded frame, bytes (RX and TX)
+#define CONTROL_FRAME_TIMEOUT_MS   100  // Drop a frame whose closing delimiter never came
+#define CONTROL_TELEMETRY_MIN_MS   20   // Fastest telemetry period a host may ask for
+
+// ===== Profiler Settings =====
+#define PROF_MAX_SECTIONS 24      // Tasks + menu handlers + frame + LED + alarm (28 bytes each)
+#define PROF_WINDOW_MS    5000    // Statistics window (printed with DEBUG_MODE)
 
 // ===== Button Settings =====
 #define BUTTON_DEBOUNCE_MS 20   // Reduced for faster response
-#define BUTTON_LONG_PRESS_MS 800  // Reduced from 1000ms
+#define BUTTON_LONG_PRESS_MS 800  // Reduced from 1000ms - fires while held
+#define BUTTON_QUEUE_SIZE 8       // Pending button events (power of two)
+#define BUTTON_TRACE_SIZE 8       // Events kept for one telemetry frame (power of two)
 
 // ===== Buzzer Settings =====
 #define BUZZER_ALARM_FREQ 1500  // Hz (reduced from 2000 - less annoying)
@@ -66,8 +156,10 @@
 #define BUZZER_BOOT_FREQ  400   // Hz (reduced from 500 - quieter)
 #define BUZZER_ALARM_DURATION 200  // ms - short beep duration
 #define BUZZER_ALARM_INTERVAL 1000 // ms - time between alarm beeps
+// #define BUZZER_CHIRPS            // Chirp when a setting is confirmed
 
 // ===== RGB LED Colors =====
+#define LED_DEFAULT_BRIGHTNESS 50  // 0-255 (until changed in Settings)
 #define LED_OFF         0, 0, 0
 #define LED_RED         255, 0, 0
 #define LED_GREEN       0, 255, 0
@@ -77,29 +169,23 @@
 #define LED_MAGENTA     255, 0, 255
 #define LED_WHITE       255, 255, 255
 
-// ===== Menu Settings =====
-// Calculate menu items based on enabled features
-#define MENU_ITEMS_BASE 3  // Back, Laser, LED
-#ifdef FEATURE_DISTANCE_SENSOR
-  #define MENU_ITEMS_DIST 1
-#else
-  #define MENU_ITEMS_DIST 0
-#endif
-#ifdef FEATURE_BADUSB
-  #define MENU_ITEMS_BADUSB 1
-#else
-  #define MENU_ITEMS_BADUSB 0
-#endif
-#ifdef FEATURE_RTC
-  #define MENU_ITEMS_RTC 1
-#else
-  #define MENU_ITEMS_RTC 0
-#endif
-#define MENU_ITEMS (MENU_ITEMS_BASE + MENU_ITEMS_DIST + MENU_ITEMS_BADUSB + MENU_ITEMS_RTC + 1)  // +1 for Sleep
+// ===== RGB LED Effects =====
+#define LED_BREATHE_MS     2000  // One breath, dark to dark
+#define LED_BLINK_ON_MS    150   // Blink codes: n flashes ...
+#define LED_BLINK_OFF_MS   250
+#define LED_BLINK_PAUSE_MS 1000  // ... then a pause before they repeat
+#define LED_STROBE_MS      250   // Alarm strobe period
+#define LED_STROBE_ON_MS   40    // ... of which the LED is on
+#define LED_SELFTEST_STEP_MS 200 // Red, green, blue, off
 
+// ===== Menu Settings =====
 #define MENU_TIMEOUT_MS 30000  // Return to main screen after 30s
 
 // ===== BadUSB Settings =====
 #define MAX_SCRIPT_SIZE 2048
 #define DEFAULT_DELAY_MS 5
+#define BADUSB_REPORT_INTERVAL_US 1000  // Minimum gap between HID reports (USB polls every 1ms)
+#define BADUSB_REPORTS_PER_TICK   4     // Reports sent per scheduler run while typing
+#define BADUSB_KEYS_HOLD_MS       100   // How long a key combo (GUI r, CTRL ALT DEL) is held
+// #define BADUSB_BENCHMARK             // Benchmark script; typing stats + reports over serial
 
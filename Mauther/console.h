@@ -0,0 +1,74 @@
+/*
+ * Console module - Single-byte commands over USB serial
+ *
+ * One reader for everything that listens on the CDC port, so modules never
+ * steal each other's bytes. With FEATURE_CONSOLE the watch can be driven
+ * from the host (Tools/watch_remote.py) - scripted button presses and PBM
+ * screenshots of the next frame - to check UI flows on the real hardware.
+ * Without a watch, the same flows run in the host simulator (Sim/).
+ *
+ *   u d s    click UP / DOWN / SELECT
+ *   U D S    long press UP / DOWN / SELECT
+ *   p        send the next frame as a binary PBM (P4, 128x64)
+ *   L        dump the history log (FEATURE_LOGGER)
+ *
+ * A 0x00 byte starts a control protocol frame (control.h): the clock,
+ * settings and telemetry, used by Tools/watch_ctl.py. Bytes inside a frame
+ * are never taken as commands.
+ */
+
+#pragma once
+
+#if defined(FEATURE_CONSOLE) || defined(FEATURE_LOGGER)
+
+#include <Arduino.h>
+#include "config.h"
+#include "buttons.h"
+#include "display.h"
+#include "view.h"
+
+#ifdef FEATURE_CONSOLE
+#include "control.h"
+#endif
+
+#ifdef FEATURE_LOGGER
+#include "logger.h"
+#endif
+
+namespace Console {
+  // Scheduler task
+  void update() {
+    while (Serial.available()) {
+      uint8_t c = Serial.read();
+
+      #ifdef FEATURE_CONSOLE
+      if (Control::feed(c)) continue;
+      #endif
+
+      switch (c) {
+        #ifdef FEATURE_CONSOLE
+        case 'u': Buttons::inject(Buttons::BTN_UP, false); break;
+        case 'd': Buttons::inject(Buttons::BTN_DOWN, false); break;
+        case 's': Buttons::inject(Buttons::BTN_SELECT, false); break;
+        case 'U': Buttons::inject(Buttons::BTN_UP, true); break;
+        case 'D': Buttons::inject(Buttons::BTN_DOWN, true); break;
+        case 'S': Buttons::inject(Buttons::BTN_SELECT, true); break;
+        case 'p':
+          Display::requestCapture();
+          View::invalidate();
+          break;
+        #endif
+
+        #ifdef FEATURE_LOGGER
+        case 'L': Logger::dump(); break;
+        #endif
+      }
+    }
+
+    #ifdef FEATURE_CONSOLE
+    Control::update();
+    #endif
+  }
+}
+
+#endif // FEATURE_CONSOLE || FEATURE_LOGGER
@@ -0,0 +1,351 @@
+/*
+ * Control module - Framed binary protocol over USB serial
+ * Only included with FEATURE_CONSOLE
+ *
+ * Lets a host program (Tools/watch_ctl.py) set the clock, read and write
+ * Settings and subscribe to telemetry, alongside the single-byte console
+ * commands and the HID keyboard. Frames are COBS encoded and enclosed in
+ * 0x00 bytes, so they never collide with a console command, and end in a
+ * CRC-16/CCITT (init 0xFFFF, as _crc_ccitt_update computes it) of the
+ * decoded bytes:
+ *
+ *   0x00  COBS(type, payload..., crc lo, crc hi)  0x00
+ *
+ * Frames with a bad CRC are dropped without a reply. Any other request is
+ * answered with type | 0x80, a Status byte and the payload below. All
+ * integers are little endian.
+ *
+ *   type  request                      response payload
+ *   0x01  PING                         protocol version, VERSION text
+ *   0x02  SET_TIME y:u16 mo d h mi s   -
+ *   0x03  GET_TIME                     y:u16 mo d h mi s
+ *   0x04  GET_SETTING id               id value:i16 min:i16 max:i16 name
+ *   0x05  SET_SETTING id value:i16     id value:i16 (after clamping)
+ *   0x06  TELEMETRY period:u16         - (period in ms, 0 stops the stream)
+ *   0x07  GET_STATUS                   bootUs:u32 wakeUs:u16 uptimeMs:u32
+ *                                      maxLoopUs:u32 flags (bit 0: cold start)
+ *                                      alarmUs:u16
+ *
+ * bootUs is sketch start to the first frame on the panel, wakeUs the last
+ * wake from sleep to its first frame, maxLoopUs the worst scheduler pass
+ * and alarmUs the worst sample-to-alarm latency since boot.
+ *
+ * While subscribed, 0x90 frames (no status byte) carry
+ *   ms:u32 distance:u16 tempQuarters:i16 loopMaxUs:u16 events:u8 event:u8...
+ * loopMaxUs is the worst scheduler pass since the previous frame. The low
+ * bits of events count the button events that follow (button << 4 | type,
+ * oldest first, at most BUTTON_TRACE_SIZE); bit 7 is set if more happened
+ * since the previous frame than fit. Telemetry stops when the host closes
+ * the port, and a frame is skipped rather than blocking the loop when the
+ * USB endpoint is full.
+ */
+
+#pragma once
+
+#ifdef FEATURE_CONSOLE
+
+#include <Arduino.h>
+#include <util/crc16.h>
+#include "config.h"
+#include "buttons.h"
+#include "scheduler.h"
+#include "settings.h"
+#include "power.h"
+
+#ifdef FEATURE_DISTANCE_SENSOR
+#include "sensors.h"
+#include "alarm.h"
+#endif
+
+#ifdef FEATURE_RTC
+#include "rtc_module.h"
+#endif
+
+// COBS code bytes cover at most 254 data bytes - one block per frame here
+static_assert(CONTROL_FRAME_MAX < 254, "Control frames must fit one COBS block");
+
+// Longest telemetry frame: type, 10 bytes of readings, event count and
+// list, CRC; on the wire a COBS code byte and two delimiters more
+#define CONTROL_TELEMETRY_MAX  (1 + 10 + 1 + BUTTON_TRACE_SIZE + 2)
+static_assert(CONTROL_TELEMETRY_MAX <= CONTROL_FRAME_MAX, "Telemetry frame too long");
+static_assert(BUTTON_TRACE_SIZE < 0x80, "Event count shares a byte with the lost flag");
+
+namespace Control {
+  #define CONTROL_PROTOCOL_VERSION 2
+
+  enum MsgType {
+    MSG_PING = 0x01,
+    MSG_SET_TIME,
+    MSG_GET_TIME,
+    MSG_GET_SETTING,
+    MSG_SET_SETTING,
+    MSG_TELEMETRY,
+    MSG_GET_STATUS,
+    MSG_RESPONSE = 0x80,        // Or'd into the request type
+    MSG_TELEMETRY_DATA = 0x90
+  };
+
+  enum Status {
+    ST_OK,
+    ST_BAD_LENGTH,
+    ST_UNKNOWN_TYPE,
+    ST_BAD_ID,
+    ST_BAD_VALUE,
+    ST_UNAVAILABLE              // Feature compiled out or hardware missing
+  };
+
+  uint8_t rx[CONTROL_FRAME_MAX + 1];  // Encoded frame, decoded in place
+  uint8_t rxLen = 0;
+  bool inFrame = false;
+  bool overflow = false;
+  unsigned long frameStart = 0;
+
+  uint8_t tx[CONTROL_FRAME_MAX];
+  uint16_t badFrames = 0;
+
+  uint16_t telemetryPeriodMs = 0;
+  unsigned long lastTelemetry = 0;
+  uint16_t skippedTelemetry = 0;
+
+  uint16_t crc(const uint8_t* data, uint8_t len) {
+    uint16_t c = 0xFFFF;
+    while (len--) c = _crc_ccitt_update(c, *data++);
+    return c;
+  }
+
+  uint8_t* put16(uint8_t* p, uint16_t v) {
+    *p++ = v;
+    *p++ = v >> 8;
+    return p;
+  }
+
+  uint8_t* put32(uint8_t* p, uint32_t v) {
+    return put16(put16(p, v), v >> 16);
+  }
+
+  uint16_t get16(const uint8_t* p) {
+    return p[0] | ((uint16_t)p[1] << 8);
+  }
+
+  // Append the CRC to tx[0..len) and write it as one delimited COBS frame
+  void send(uint8_t len) {
+    uint16_t c = crc(tx, len);
+    put16(tx + len, c);
+    len += 2;
+
+    uint8_t out[CONTROL_FRAME_MAX + 3];
+    uint8_t n = 0;
+    out[n++] = 0;
+    uint8_t code = n++;           // Pending code byte: distance to the next zero
+    for (uint8_t i = 0; i < len; i++) {
+      if (tx[i] == 0) {
+        out[code] = n - code;
+        code = n++;
+      } else {
+        out[n++] = tx[i];
+      }
+    }
+    out[code] = n - code;
+    out[n++] = 0;
+    Serial.write(out, n);
+  }
+
+  // COBS decode rx in place. Returns the decoded length, 0 if malformed.
+  uint8_t decode() {
+    uint8_t in = 0, out = 0;
+    while (in < rxLen) {
+      uint8_t code = rx[in++];
+      if ((uint16_t)in + code - 1 > rxLen) return 0;
+      for (uint8_t i = 1; i < code; i++) rx[out++] = rx[in++];
+      if (code < 0xFF && in < rxLen) rx[out++] = 0;
+    }
+    return out;
+  }
+
+  // Fills tx after the type and status bytes; returns the status
+  uint8_t handle(uint8_t type, const uint8_t* in, uint8_t len, uint8_t& n) {
+    switch (type) {
+      case MSG_PING: {
+        static const char version[] PROGMEM = VERSION;
+        tx[n++] = CONTROL_PROTOCOL_VERSION;
+        memcpy_P(tx + n, version, sizeof(version) - 1);
+        n += sizeof(version) - 1;
+        return ST_OK;
+      }
+
+      case MSG_SET_TIME: {
+        if (len != 7) return ST_BAD_LENGTH;
+        #ifdef FEATURE_RTC
+        uint16_t year = get16(in);
+        if (year < 2000 || year > 2099 || in[2] < 1 || in[2] > 12 || in[3] < 1 || in[3] > 31 ||
+            in[4] > 23 || in[5] > 59 || in[6] > 59) {
+          return ST_BAD_VALUE;
+        }
+        if (!RTCModule::isAvailable()) return ST_UNAVAILABLE;
+        RTCModule::setTime(year, in[2], in[3], in[4], in[5], in[6]);
+        return ST_OK;
+        #else
+        return ST_UNAVAILABLE;
+        #endif
+      }
+
+      case MSG_GET_TIME: {
+        #ifdef FEATURE_RTC
+        if (!RTCModule::isAvailable()) return ST_UNAVAILABLE;
+        RTCModule::Time t = RTCModule::getTime();
+        uint8_t* p = put16(tx + n, t.year);
+        *p++ = t.month;
+        *p++ = t.day;
+        *p++ = t.hour;
+        *p++ = t.minute;
+        *p++ = t.second;
+        n = p - tx;
+        return ST_OK;
+        #else
+        return ST_UNAVAILABLE;
+        #endif
+      }
+
+      case MSG_GET_SETTING: {
+        if (len != 1) return ST_BAD_LENGTH;
+        uint8_t id = in[0];
+        int16_t value;
+        if (id >= Settings::SET_COUNT) return ST_BAD_ID;
+        if (!Settings::get(id, value)) return ST_UNAVAILABLE;
+        tx[n++] = id;
+        uint8_t* p = put16(put16(put16(tx + n, value), Settings::getMin(id)), Settings::getMax(id));
+        n = p - tx;
+        uint8_t nameLen = min(strlen_P(Settings::getName(id)), (size_t)(sizeof(tx) - 2 - n));
+        memcpy_P(tx + n, Settings::getName(id), nameLen);
+        n += nameLen;
+        return ST_OK;
+      }
+
+      case MSG_SET_SETTING: {
+        if (len != 3) return ST_BAD_LENGTH;
+        uint8_t id = in[0];
+        int16_t value;
+        if (id >= Settings::SET_COUNT) return ST_BAD_ID;
+        if (!Settings::set(id, get16(in + 1)) || !Settings::get(id, value)) return ST_UNAVAILABLE;
+        tx[n++] = id;
+        n = put16(tx + n, value) - tx;
+        return ST_OK;
+      }
+
+      case MSG_TELEMETRY: {
+        if (len != 2) return ST_BAD_LENGTH;
+        uint16_t period = get16(in);
+        telemetryPeriodMs = period ? max(period, (uint16_t)CONTROL_TELEMETRY_MIN_MS) : 0;
+        lastTelemetry = millis() - telemetryPeriodMs;   // First frame right away
+        Scheduler::takeWindowMaxUs();
+        uint8_t stale[BUTTON_TRACE_SIZE];
+        bool lost;
+        Buttons::takeTrace(stale, lost);                 // Only events from now on
+        return ST_OK;
+      }
+
+      case MSG_GET_STATUS: {
+        uint8_t* p = put32(tx + n, Power::getBootToFrameUs());
+        p = put16(p, Power::getWakeToFrameUs());
+        p = put32(p, millis());
+        p = put32(p, Scheduler::getMaxLatencyUs());
+        *p++ = Power::isColdStart();
+        #ifdef FEATURE_DISTANCE_SENSOR
+        p = put16(p, Alarm::getMaxLatencyUs());
+        #else
+        p = put16(p, 0);
+        #endif
+        n = p - tx;
+        return ST_OK;
+      }
+    }
+    return ST_UNKNOWN_TYPE;
+  }
+
+  // A complete encoded frame is in rx
+  void process() {
+    uint8_t len = overflow ? 0 : decode();
+    if (len < 3 || crc(rx, len - 2) != get16(rx + len - 2)) {
+      badFrames++;
+      return;
+    }
+
+    uint8_t type = rx[0];
+    uint8_t n = 2;
+    tx[0] = type | MSG_RESPONSE;
+    tx[1] = handle(type, rx + 1, len - 3, n);
+    if (tx[1] != ST_OK) n = 2;
+    send(n);
+  }
+
+  // Console passes every byte it reads through here first. Returns true if
+  // the byte belongs to a frame; otherwise it is a console command.
+  bool feed(uint8_t c) {
+    if (inFrame && millis() - frameStart > CONTROL_FRAME_TIMEOUT_MS) inFrame = false;
+
+    if (c == 0) {
+      if (inFrame && rxLen) {
+        process();
+        inFrame = false;
+      } else {
+        inFrame = true;
+        rxLen = 0;
+        overflow = false;
+        frameStart = millis();
+      }
+      return true;
+    }
+
+    if (!inFrame) return false;
+    if (rxLen < sizeof(rx)) rx[rxLen++] = c;
+    else overflow = true;
+    return true;
+  }
+
+  void sendTelemetry() {
+    uint8_t* p = tx;
+    *p++ = MSG_TELEMETRY_DATA;
+    p = put32(p, millis());
+
+    #ifdef FEATURE_DISTANCE_SENSOR
+    p = put16(p, Sensors::getDistance());
+    #else
+    p = put16(p, 0);
+    #endif
+
+    #ifdef FEATURE_RTC
+    p = put16(p, RTCModule::getTemperatureQuarters());
+    #else
+    p = put16(p, 0);
+    #endif
+
+    p = put16(p, min(Scheduler::takeWindowMaxUs(), 0xFFFFUL));
+
+    bool lost;
+    uint8_t events = Buttons::takeTrace(p + 1, lost);
+    *p = events | (lost ? 0x80 : 0);
+    p += 1 + events;
+
+    send(p - tx);
+  }
+
+  // Called from Console::update()
+  void update() {
+    if (!telemetryPeriodMs) return;
+    if (!Serial) {
+      telemetryPeriodMs = 0;   // Host went away
+      return;
+    }
+    if (millis() - lastTelemetry < telemetryPeriodMs) return;
+    lastTelemetry = millis();
+
+    // Never wait for the host; the events stay traced for the next frame
+    if (Serial.availableForWrite() < CONTROL_TELEMETRY_MAX + 3) {
+      skippedTelemetry++;
+      return;
+    }
+    sendTelemetry();
+  }
+}
+
+#endif // FEATURE_CONSOLE
@@ -1,19 +1,63 @@
 /*
  * Display module - Handles OLED SH1106 display
+ *
+ * Frames are drawn with Display::firstPage()/nextPage(), which mirror the
+ * U8g2 page loop. With DISPLAY_DIRTY_TILES each rendered page is split into
+ * chunks of DISPLAY_CHUNK_TILES 8x8 tiles; a CRC of every chunk is kept and
+ * only chunks whose CRC changed are sent over I2C. This assumes the page
+ * buffer (_1_) constructor, i.e. one 8-row page per pass.
+ *
+ * requestCapture() (FEATURE_CONSOLE) sends the next frame over USB serial as
+ * a binary PBM image, page by page as it is rendered.
+ *
+ * Text uses DISPLAY_FONT: the glyph subset from font_subset.h (generated
+ * by Tools/font_subset.py, required to build), or the stock 6x10 font when
+ * that header holds only the glyph list. UI literals are checked against
+ * the list at compile time (ui_text.h).
+ *
+ * The main screen is a watch face with HH:MM:SS in 16x32 digits from
+ * face_digits.h (Tools/face_digits.py), stored in the panel's own tile
+ * format. It is drawn in full once; after that only the digit cells whose
+ * value changed are copied out of flash and sent with u8x8_DrawTile(), and
+ * the info line below is rendered (two pages) only when it changed - a
+ * new second costs 64 bytes of I2C and no page rendering.
+ *
+ * With FEATURE_PROFILER every frame, firstPage() to the last nextPage(), is
+ * recorded as the "frame" profiler section.
  */
 
 #pragma once
 #include <Arduino.h>
 #include <U8g2lib.h>
-#include <Wire.h>
+#include <util/crc16.h>
 #include "config.h"
+#include "i2c_bus.h"
+#include "profiler.h"
+#include "format.h"
+#include "settings.h"
+#include "face_digits.h"
+#include "ui_text.h"
+
+#ifdef FONT_SUBSET_FONT
+#define DISPLAY_FONT FONT_SUBSET_FONT
+#else
+#define DISPLAY_FONT u8g2_font_6x10_tf
+#endif
+
+// SH1106 page buffer display whose I2C transfers go through I2CBus
+class U8G2_SH1106_128X64_NONAME_1_I2CBUS : public U8G2 {
+  public:
+    U8G2_SH1106_128X64_NONAME_1_I2CBUS(const u8g2_cb_t* rotation) : U8G2() {
+      u8g2_Setup_sh1106_i2c_128x64_noname_1(&u8g2, rotation, I2CBus::u8x8Byte,
+                                            u8x8_gpio_and_delay_arduino);
+    }
+};
 
 // Make u8g2 globally accessible
-U8G2_SH1106_128X64_NONAME_1_HW_I2C u8g2(U8G2_R0, U8X8_PIN_NONE);
+U8G2_SH1106_128X64_NONAME_1_I2CBUS u8g2(U8G2_R0);
 
 namespace Display {
-  // Option 1: Hardware I2C (recommended - uses Arduino Wire library)
-  // U8G2_SH1106_128X64_NONAME_1_HW_I2C u8g2(U8G2_R0, U8X8_PIN_NONE);
+  // Option 1: Hardware I2C through I2CBus (above, recommended)
   
   // Option 2: Software I2C with current pins (if Option 1 doesn't work)
   // U8G2_SH1106_128X64_NONAME_1_SW_I2C u8g2(U8G2_R0, PIN_OLED_SCL, PIN_OLED_SDA, U8X8_PIN_NONE);
@@ -21,84 +65,420 @@ namespace Display {
   // Option 3: Try SSD1306 instead of SH1106 (some boards mislabeled)
   // U8G2_SSD1306_128X64_NONAME_1_HW_I2C u8g2(U8G2_R0, U8X8_PIN_NONE);
 
+  #define DISPLAY_PAGES       (SCREEN_HEIGHT / 8)
+  #define DISPLAY_CHUNK_BYTES (DISPLAY_CHUNK_TILES * 8)
+  #define DISPLAY_CHUNKS      (SCREEN_WIDTH / DISPLAY_CHUNK_BYTES)
+
+  #ifdef DISPLAY_DIRTY_TILES
+  uint16_t chunkHash[DISPLAY_PAGES][DISPLAY_CHUNKS];
+  bool fullRefresh = true;
+  #endif
+  uint8_t currentPage = 0;
+  uint8_t contrast;          // Applied Settings::values.contrast
+
+  #ifdef FEATURE_CONSOLE
+  bool captureRequested = false;
+  bool capturing = false;
+  #endif
+
+  #ifdef FEATURE_PROFILER
+  uint8_t frameProf = PROF_NONE;
+  unsigned long frameStart = 0;
+  #endif
+
+  // I2C payload statistics (a full frame is SCREEN_WIDTH * DISPLAY_PAGES bytes)
+  uint16_t frameBytes = 0;
+  uint16_t lastFrameBytes = 0;
+  unsigned long totalBytes = 0;
+
+  // Watch face on the panel, valid until another frame is drawn
+  #define FACE_TOP_PAGE   1          // Digits on pages 1-4
+  #define FACE_INFO_PAGE  6          // Temperature, distance, laser on 6-7
+  #define FACE_INFO_PAGES 2
+  #define FACE_LEFT       8          // x of the first digit
+
+  struct FaceInfo {
+    int16_t temp;
+    uint16_t distance;
+    bool laserOn;
+  };
+
+  bool faceValid = false;
+  char faceTime[9];                 // "HH:MM:SS" on the panel
+  FaceInfo faceInfo;
+
+  // Needs I2CBus::begin() and Settings::begin() first
   void begin() {
-    Wire.begin();
-    Wire.setClock(400000);
     u8g2.begin();
-    u8g2.setContrast(255);
-    u8g2.setFont(u8g2_font_6x10_tf);
+    contrast = Settings::values.contrast;
+    u8g2.setContrast(contrast);
+    u8g2.setFont(DISPLAY_FONT);
     u8g2.setFontPosTop();
+
+    #ifdef FEATURE_PROFILER
+    frameProf = Profiler::add(PROF_NAME("frame"));
+    #endif
+  }
+
+  // Resend everything on the next frame (display RAM no longer matches)
+  void invalidate() {
+    #ifdef DISPLAY_DIRTY_TILES
+    fullRefresh = true;
+    #endif
+    faceValid = false;
+  }
+
+  #ifdef FEATURE_CONSOLE
+  void requestCapture() {
+    captureRequested = true;
+  }
+
+  // Page buffer is column bytes (LSB at the top); PBM wants rows, MSB left.
+  // PBM 1 is black, so lit pixels are inverted to look like the screen.
+  void capturePage() {
+    uint8_t* buf = u8g2.getBufferPtr();
+    for (uint8_t row = 0; row < 8; row++) {
+      for (uint8_t x = 0; x < SCREEN_WIDTH; x += 8) {
+        uint8_t out = 0;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+          out = (out << 1) | (((buf[x + bit] >> row) & 1) ^ 1);
+        }
+        Serial.write(out);
+      }
+    }
+  }
+  #endif
+
+  #ifdef DISPLAY_DIRTY_TILES
+  // Send the changed chunks of the page just rendered, merging neighbours
+  void flushPage(uint8_t page) {
+    uint8_t* buf = u8g2.getBufferPtr();
+    int8_t runStart = -1;
+
+    for (uint8_t c = 0; c <= DISPLAY_CHUNKS; c++) {
+      bool dirty = false;
+
+      if (c < DISPLAY_CHUNKS) {
+        uint16_t crc = 0xFFFF;
+        uint8_t* p = buf + c * DISPLAY_CHUNK_BYTES;
+        for (uint8_t i = 0; i < DISPLAY_CHUNK_BYTES; i++) {
+          crc = _crc_ccitt_update(crc, p[i]);
+        }
+        dirty = fullRefresh || crc != chunkHash[page][c];
+        chunkHash[page][c] = crc;
+      }
+
+      if (dirty && runStart < 0) {
+        runStart = c;
+      } else if (!dirty && runStart >= 0) {
+        uint8_t count = c - runStart;
+        u8x8_DrawTile(u8g2.getU8x8(), runStart * DISPLAY_CHUNK_TILES, page,
+                      count * DISPLAY_CHUNK_TILES, buf + runStart * DISPLAY_CHUNK_BYTES);
+        frameBytes += count * DISPLAY_CHUNK_BYTES;
+        runStart = -1;
+      }
+    }
+  }
+  #endif
+
+  // Contrast, statistics - start of every frame, full or partial
+  void beginFrame() {
+    if (contrast != Settings::values.contrast) {
+      contrast = Settings::values.contrast;
+      u8g2.setContrast(contrast);
+    }
+
+    #ifdef FEATURE_PROFILER
+    frameStart = micros();
+    #endif
+    frameBytes = 0;
+  }
+
+  void endFrame() {
+    lastFrameBytes = frameBytes;
+    totalBytes += frameBytes;
+    #ifdef FEATURE_PROFILER
+    Profiler::record(frameProf, micros() - frameStart);
+    #endif
+  }
+
+  // Page loop: Display::firstPage(); do { ... } while (Display::nextPage());
+  void firstPage() {
+    beginFrame();
+    currentPage = 0;
+    faceValid = false;              // Whatever is drawn replaces the face
+
+    #ifdef FEATURE_CONSOLE
+    capturing = captureRequested;
+    captureRequested = false;
+    if (capturing) Serial.print(F("P4\n128 64\n"));
+    #endif
+
+    #ifdef DISPLAY_DIRTY_TILES
+    u8g2.clearBuffer();
+    u8g2.setBufferCurrTileRow(0);
+    #else
+    u8g2.firstPage();
+    #endif
+  }
+
+  bool nextPage() {
+    #ifdef FEATURE_CONSOLE
+    if (capturing) capturePage();
+    #endif
+
+    #ifdef DISPLAY_DIRTY_TILES
+    flushPage(currentPage);
+    bool more = ++currentPage < DISPLAY_PAGES;
+    if (more) {
+      u8g2.clearBuffer();
+      u8g2.setBufferCurrTileRow(currentPage);
+    } else {
+      fullRefresh = false;
+      u8x8_RefreshDisplay(u8g2.getU8x8());
+    }
+    #else
+    frameBytes += SCREEN_WIDTH;
+    bool more = u8g2.nextPage();
+    #endif
+
+    if (!more) endFrame();
+    return more;
+  }
+
+  uint16_t getLastFrameBytes() {
+    return lastFrameBytes;
+  }
+
+  unsigned long getTotalBytes() {
+    return totalBytes;
   }
 
   // Removed clear() and show() - not needed with page buffer mode
 
+  // All text goes through here. With a font subset and DEBUG_MODE, glyphs
+  // the subset lacks (U8g2 silently skips them) are reported over serial.
+  void drawStr(u8g2_uint_t x, u8g2_uint_t y, const char* s) {
+    #if defined(FONT_SUBSET_FONT) && defined(DEBUG_MODE)
+    for (const char* p = s; *p; p++) {
+      if (!strchr_P(PSTR(FONT_SUBSET_GLYPHS), *p)) {
+        Serial.print(F("Glyph not in font subset: "));
+        Serial.println(*p);
+      }
+    }
+    #endif
+    u8g2.drawStr(x, y, s);
+  }
+
   void showSplash(const char* line1, const char* line2) {
-    u8g2.firstPage();
+    firstPage();
     do {
-      u8g2.setFont(u8g2_font_6x10_tf);
-      u8g2.drawStr(30, 25, line1);
-      u8g2.drawStr(40, 40, line2);
-    } while (u8g2.nextPage());
+      u8g2.setFont(DISPLAY_FONT);
+      drawStr(30, 25, line1);
+      drawStr(40, 40, line2);
+    } while (nextPage());
   }
 
-  void drawMainScreen(const char* time, float temp, uint16_t distance, bool laserOn) {
-    char buf[12];
-    
-    u8g2.firstPage();
+  // ===== Watch face =====
+
+  // Glyph and width of character i of "HH:MM:SS"
+  const uint8_t* faceGlyph(const char* time, uint8_t i, uint8_t& width) {
+    if (time[i] == ':') {
+      width = FACE_COLON_WIDTH;
+      return &faceColon[0][0];
+    }
+    width = FACE_DIGIT_WIDTH;
+    return &faceDigits[(uint8_t)(time[i] - '0') % 10][0][0];
+  }
+
+  // Temperature left, distance in the middle, laser right
+  void drawFaceInfo(const FaceInfo& info) {
+    char buf[8];
+    uint8_t y = FACE_INFO_PAGE * 8 + 3;
+    Format::putChar(Format::putQuarters(buf, info.temp), 'C');
+    drawStr(0, y, buf);
+    if (info.distance > DISTANCE_MAX_RANGE) {
+      strcpy(buf, UI_TEXT("---"));
+    } else {
+      Format::putStr(Format::putUInt(buf, info.distance), UI_TEXT("mm"));
+    }
+    drawStr(48, y, buf);
+    if (info.laserOn) drawStr(SCREEN_WIDTH - 18, y, UI_TEXT("LSR"));
+  }
+
+  // Whole face through the page loop - on entry, after another screen,
+  // and for screenshots
+  void drawFaceFull(const char* time, const FaceInfo& info) {
+    firstPage();
     do {
-      u8g2.setFont(u8g2_font_6x10_tf);
-      // Time
-      u8g2.drawStr(0, 0, time);
-      
-      // Temperature
-      snprintf(buf, sizeof(buf), "%.1fC", temp);
-      u8g2.drawStr(0, 20, buf);
-      
-      // Distance
-      if (distance > DISTANCE_MAX_RANGE) {
-        u8g2.drawStr(0, 35, "---");
-      } else {
-        snprintf(buf, sizeof(buf), "%dmm", distance);
-        u8g2.drawStr(0, 35, buf);
+      uint8_t page = u8g2.getBufferCurrTileRow();
+      if (page >= FACE_TOP_PAGE && page < FACE_TOP_PAGE + FACE_DIGIT_PAGES) {
+        uint8_t* buf = u8g2.getBufferPtr();
+        uint8_t x = FACE_LEFT;
+        for (uint8_t i = 0; i < 8; i++) {
+          uint8_t w;
+          const uint8_t* glyph = faceGlyph(time, i, w);
+          memcpy_P(buf + x, glyph + (page - FACE_TOP_PAGE) * w, w);
+          x += w;
+        }
       }
-      
-      // Laser
-      if (laserOn) u8g2.drawStr(0, 50, "LSR");
-    } while (u8g2.nextPage());
+      u8g2.setFont(DISPLAY_FONT);
+      drawFaceInfo(info);
+    } while (nextPage());
   }
 
-  void drawMenu(const char* title, const char* items[], int itemCount, int selected) {
-    int maxVis = 5;
-    int offset = (itemCount > maxVis && selected >= maxVis) ? min(selected - maxVis + 1, itemCount - maxVis) : 0;
+  // time is "HH:MM:SS", temp in DS3231 quarter degrees
+  void drawWatchFace(const char* time, int16_t temp, uint16_t distance, bool laserOn) {
+    FaceInfo info;
+    memset(&info, 0, sizeof(info));   // Padding too - compared with memcmp
+    info.temp = temp;
+    info.distance = distance;
+    info.laserOn = laserOn;
+
+    bool full = !faceValid;
+    #ifdef FEATURE_CONSOLE
+    full = full || captureRequested;
+    #endif
+    if (full) {
+      drawFaceFull(time, info);
+      faceValid = true;
+    } else {
+      beginFrame();
+      u8x8_t* u8x8 = u8g2.getU8x8();
+
+      // Changed digit cells, straight from flash - only the pages in
+      // which the old and new glyph differ (8 -> 9 is one page)
+      uint8_t tile[FACE_DIGIT_WIDTH];
+      uint8_t x = FACE_LEFT;
+      for (uint8_t i = 0; i < 8; i++) {
+        uint8_t w;
+        const uint8_t* glyph = faceGlyph(time, i, w);
+        if (time[i] != faceTime[i]) {
+          const uint8_t* old = faceGlyph(faceTime, i, w);
+          for (uint8_t p = 0; p < FACE_DIGIT_PAGES; p++) {
+            memcpy_P(tile, glyph + p * w, w);
+            bool same = true;
+            for (uint8_t b = 0; b < w && same; b++) same = (tile[b] == pgm_read_byte(old + p * w + b));
+            if (same) continue;
+            u8x8_DrawTile(u8x8, x / 8, FACE_TOP_PAGE + p, w / 8, tile);
+            frameBytes += w;
+          }
+        }
+        x += w;
+      }
+
+      // Info line: render just its pages
+      if (memcmp(&info, &faceInfo, sizeof(info))) {
+        u8g2.setFont(DISPLAY_FONT);
+        for (uint8_t p = FACE_INFO_PAGE; p < FACE_INFO_PAGE + FACE_INFO_PAGES; p++) {
+          u8g2.clearBuffer();
+          u8g2.setBufferCurrTileRow(p);
+          drawFaceInfo(info);
+          u8x8_DrawTile(u8x8, 0, p, SCREEN_WIDTH / 8, u8g2.getBufferPtr());
+          frameBytes += SCREEN_WIDTH;
+        }
+      }
+
+      #ifdef DISPLAY_DIRTY_TILES
+      if (frameBytes) fullRefresh = true;   // Chunk hashes no longer match the panel
+      #endif
+      endFrame();
+    }
+
+    memcpy(faceTime, time, sizeof(faceTime) - 1);
+    faceTime[sizeof(faceTime) - 1] = '\0';
+    faceInfo = info;
+  }
+
+  // Menu list with PROGMEM labels; label(i) returns the i-th label
+  void drawMenuP(const char* title, uint8_t itemCount, uint8_t selected,
+                 const char* (*label)(uint8_t)) {
+    uint8_t maxVis = 5;
+    uint8_t offset = (itemCount > maxVis && selected >= maxVis) ? min(selected - maxVis + 1, itemCount - maxVis) : 0;
+    char buf[16];
     
-    u8g2.firstPage();
+    firstPage();
     do {
-      u8g2.setFont(u8g2_font_6x10_tf);
-      u8g2.drawStr(0, 0, title);
+      u8g2.setFont(DISPLAY_FONT);
+      drawStr(0, 0, title);
       
-      int y = 12;
-      for (int i = offset; i < min(offset + maxVis, itemCount); i++) {
-        if (i == selected) u8g2.drawStr(0, y, ">");
-        u8g2.drawStr(8, y, items[i]);
+      uint8_t y = 12;
+      for (uint8_t i = offset; i < min(offset + maxVis, (int)itemCount); i++) {
+        if (i == selected) drawStr(0, y, UI_TEXT(">"));
+        strncpy_P(buf, label(i), sizeof(buf) - 1);
+        buf[sizeof(buf) - 1] = '\0';
+        drawStr(8, y, buf);
         y += 10;
       }
-    } while (u8g2.nextPage());
+    } while (nextPage());
+  }
+
+  // Title line plus two hint lines (LED test, BadUSB)
+  void drawInfo(const char* title, const char* line1, const char* line2) {
+    firstPage();
+    do {
+      u8g2.setFont(DISPLAY_FONT);
+      drawStr(0, 0, title);
+      drawStr(0, 20, line1);
+      drawStr(0, 35, line2);
+    } while (nextPage());
+  }
+
+  #ifdef FEATURE_PROFILER
+  // Profiler section: name, stats line and a bar per histogram bucket
+  // scaled to the fullest one (bucket b holds runs under 16 * 4^b us)
+  void drawProfile(const char* title, const char* stats, const uint16_t* buckets) {
+    uint16_t top = 1;
+    for (uint8_t b = 0; b < PROF_BUCKETS; b++) top = max(top, buckets[b]);
+
+    firstPage();
+    do {
+      u8g2.setFont(DISPLAY_FONT);
+      drawStr(0, 0, title);
+      drawStr(0, 11, stats);
+      for (uint8_t b = 0; b < PROF_BUCKETS; b++) {
+        uint8_t h = (uint32_t)buckets[b] * 38 / top;
+        if (buckets[b] && !h) h = 1;
+        u8g2.drawBox(b * 16 + 1, SCREEN_HEIGHT - 1 - h, 14, h);
+      }
+      u8g2.drawHLine(0, SCREEN_HEIGHT - 1, SCREEN_WIDTH);
+    } while (nextPage());
+  }
+
+  // Title and up to four lines of figures (debug screen counters)
+  void drawLines(const char* title, const char* const* lines, uint8_t count) {
+    firstPage();
+    do {
+      u8g2.setFont(DISPLAY_FONT);
+      drawStr(0, 0, title);
+      for (uint8_t i = 0; i < count; i++) drawStr(0, 14 + i * 12, lines[i]);
+    } while (nextPage());
+  }
+  #endif
+
+  void drawSleepScreen() {
+    firstPage();
+    do {
+      u8g2.setFont(DISPLAY_FONT);
+      drawStr(20, 25, UI_TEXT("Sleep Mode"));
+      drawStr(10, 40, UI_TEXT("Press any btn"));
+    } while (nextPage());
   }
 
   void drawText(const char* text) {
-    u8g2.firstPage();
+    firstPage();
     do {
-      u8g2.setFont(u8g2_font_6x10_tf);
-      u8g2.drawStr(0, 0, text);
-    } while (u8g2.nextPage());
+      u8g2.setFont(DISPLAY_FONT);
+      drawStr(0, 0, text);
+    } while (nextPage());
   }
 
   void drawCentered(const char* text) {
-    u8g2.firstPage();
+    firstPage();
     do {
-      u8g2.setFont(u8g2_font_6x10_tf);
-      u8g2.drawStr(30, 32, text);
-    } while (u8g2.nextPage());
+      u8g2.setFont(DISPLAY_FONT);
+      drawStr(30, 32, text);
+    } while (nextPage());
   }
 
   void turnOff() {
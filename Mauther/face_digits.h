@@ -0,0 +1,94 @@
+/*
+ * Watch face digits - 16x32 seven segment glyphs and a 8x32 colon
+ * Generated by Tools/face_digits.py - do not edit
+ *
+ * Stored in the SH1106 tile format: FACE_DIGIT_PAGES pages of column bytes,
+ * LSB at the top, ready for u8x8_DrawTile().
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#define FACE_DIGIT_WIDTH 16
+#define FACE_COLON_WIDTH 8
+#define FACE_DIGIT_PAGES 4
+
+const uint8_t faceDigits[10][FACE_DIGIT_PAGES][FACE_DIGIT_WIDTH] PROGMEM = {
+  // 0
+  {
+    {0x00, 0xF0, 0xF8, 0xF0, 0x02, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x02, 0xF0, 0xF8, 0xF0, 0x00},
+    {0x00, 0x1F, 0x3F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x3F, 0x1F, 0x00},
+    {0x00, 0xFC, 0xFE, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFC, 0xFE, 0xFC, 0x00},
+    {0x00, 0x0F, 0x1F, 0x0F, 0x40, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0x40, 0x0F, 0x1F, 0x0F, 0x00}
+  },
+  // 1
+  {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF8, 0xF0, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x3F, 0x1F, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFC, 0xFE, 0xFC, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x1F, 0x0F, 0x00}
+  },
+  // 2
+  {
+    {0x00, 0x00, 0x00, 0x00, 0x02, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x02, 0xF0, 0xF8, 0xF0, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x80, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x80, 0x1F, 0x3F, 0x1F, 0x00},
+    {0x00, 0xFC, 0xFE, 0xFC, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x0F, 0x1F, 0x0F, 0x40, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0x40, 0x00, 0x00, 0x00, 0x00}
+  },
+  // 3
+  {
+    {0x00, 0x00, 0x00, 0x00, 0x02, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x02, 0xF0, 0xF8, 0xF0, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x80, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x80, 0x1F, 0x3F, 0x1F, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0xFC, 0xFE, 0xFC, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x40, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0x40, 0x0F, 0x1F, 0x0F, 0x00}
+  },
+  // 4
+  {
+    {0x00, 0xF0, 0xF8, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF8, 0xF0, 0x00},
+    {0x00, 0x1F, 0x3F, 0x1F, 0x80, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x80, 0x1F, 0x3F, 0x1F, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0xFC, 0xFE, 0xFC, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x1F, 0x0F, 0x00}
+  },
+  // 5
+  {
+    {0x00, 0xF0, 0xF8, 0xF0, 0x02, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x02, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x1F, 0x3F, 0x1F, 0x80, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x80, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0xFC, 0xFE, 0xFC, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x40, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0x40, 0x0F, 0x1F, 0x0F, 0x00}
+  },
+  // 6
+  {
+    {0x00, 0xF0, 0xF8, 0xF0, 0x02, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x02, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x1F, 0x3F, 0x1F, 0x80, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x80, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0xFC, 0xFE, 0xFC, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0xFC, 0xFE, 0xFC, 0x00},
+    {0x00, 0x0F, 0x1F, 0x0F, 0x40, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0x40, 0x0F, 0x1F, 0x0F, 0x00}
+  },
+  // 7
+  {
+    {0x00, 0x00, 0x00, 0x00, 0x02, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x02, 0xF0, 0xF8, 0xF0, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x3F, 0x1F, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFC, 0xFE, 0xFC, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x1F, 0x0F, 0x00}
+  },
+  // 8
+  {
+    {0x00, 0xF0, 0xF8, 0xF0, 0x02, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x02, 0xF0, 0xF8, 0xF0, 0x00},
+    {0x00, 0x1F, 0x3F, 0x1F, 0x80, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x80, 0x1F, 0x3F, 0x1F, 0x00},
+    {0x00, 0xFC, 0xFE, 0xFC, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0xFC, 0xFE, 0xFC, 0x00},
+    {0x00, 0x0F, 0x1F, 0x0F, 0x40, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0x40, 0x0F, 0x1F, 0x0F, 0x00}
+  },
+  // 9
+  {
+    {0x00, 0xF0, 0xF8, 0xF0, 0x02, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x02, 0xF0, 0xF8, 0xF0, 0x00},
+    {0x00, 0x1F, 0x3F, 0x1F, 0x80, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x80, 0x1F, 0x3F, 0x1F, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0xFC, 0xFE, 0xFC, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x40, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0x40, 0x0F, 0x1F, 0x0F, 0x00}
+  }
+};
+
+const uint8_t faceColon[FACE_DIGIT_PAGES][FACE_COLON_WIDTH] PROGMEM = {
+  {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+  {0x00, 0x00, 0x00, 0x0E, 0x0E, 0x0E, 0x00, 0x00},
+  {0x00, 0x00, 0x00, 0x70, 0x70, 0x70, 0x00, 0x00},
+  {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}
+};
@@ -0,0 +1,10 @@
+/*
+ * Font subset - the glyphs the UI can draw, from u8g2_font_6x10_tf
+ * Generated by Tools/font_subset.py --glyphs-only - do not edit
+ * 66 glyphs. No font data: display.h draws with the stock font until this
+ * is regenerated with U8g2 installed; ui_text.h checks UI text either way.
+ */
+
+#pragma once
+
+#define FONT_SUBSET_GLYPHS " %-./0123456789:<>?ABCDEFGHIJKLMNOPRSUWY_abcdefghiklmnoprstuvwxyz|"
@@ -0,0 +1,143 @@
+/*
+ * Format module - Integer and fixed-point text formatting
+ *
+ * Replaces snprintf on the display paths: no float, no varargs, no
+ * vfprintf (~1.5KB of flash once no snprintf is left in the sketch). Every
+ * put*() writes at p, NUL-terminates and returns the new end, so a line is
+ * built by chaining calls:
+ *
+ *   char buf[8];
+ *   Format::putStr(Format::putUInt(buf, distance), "mm");   // "123mm"
+ *
+ * The caller sizes the buffer: a uint16_t needs 5 characters, an int16_t 6.
+ *
+ * FORMAT_BENCHMARK times each formatter against the snprintf call it
+ * replaced at boot and prints BENCH lines over serial. The temperature
+ * reference is the old float "%.1fC", so link the float printf for that
+ * build (-Wl,-u,vfprintf -lprintf_flt -lm); without it avr-libc prints
+ * '?' and the reference looks cheaper than it was.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+namespace Format {
+  char* putStr(char* p, const char* s) {
+    while ((*p = *s++)) p++;
+    return p;
+  }
+
+  char* putChar(char* p, char c) {
+    *p++ = c;
+    *p = '\0';
+    return p;
+  }
+
+  // Unsigned decimal, zero-padded to at least width digits
+  char* putUInt(char* p, uint16_t v, uint8_t width = 1) {
+    char tmp[5];
+    uint8_t n = 0;
+    do {
+      tmp[n++] = '0' + v % 10;
+      v /= 10;
+    } while (v);
+    while (width > n) {
+      *p++ = '0';
+      width--;
+    }
+    while (n) *p++ = tmp[--n];
+    *p = '\0';
+    return p;
+  }
+
+  // Counters; 32-bit division, so kept off the per-frame paths
+  char* putULong(char* p, uint32_t v) {
+    char tmp[10];
+    uint8_t n = 0;
+    do {
+      tmp[n++] = '0' + v % 10;
+      v /= 10;
+    } while (v);
+    while (n) *p++ = tmp[--n];
+    *p = '\0';
+    return p;
+  }
+
+  char* putInt(char* p, int16_t v) {
+    if (v < 0) {
+      *p++ = '-';
+      return putUInt(p, -(int32_t)v);
+    }
+    return putUInt(p, v);
+  }
+
+  // Value in tenths as "12.3" (v = 123)
+  char* putTenths(char* p, int16_t v) {
+    if (v < 0) {
+      *p++ = '-';
+      v = -v;
+    }
+    p = putUInt(p, (uint16_t)v / 10);
+    *p++ = '.';
+    return putUInt(p, (uint16_t)v % 10);
+  }
+
+  // DS3231 quarter degrees as tenths, rounded half away from zero
+  // ("25.3" for 101, i.e. 25.25)
+  char* putQuarters(char* p, int16_t q) {
+    int16_t tenths = (q * 5 + (q < 0 ? -1 : 1)) / 2;
+    return putTenths(p, tenths);
+  }
+
+  #ifdef FORMAT_BENCHMARK
+  // Cycles per formatted value, snprintf against the formatter
+  // BENCH fmt=<name> snprintf=<cycles> format=<cycles>
+  #define FORMAT_BENCH_RUNS 500
+
+  volatile int16_t benchValue;   // Keeps the compiler from folding the loops
+
+  void report(const __FlashStringHelper* name, unsigned long refUs, unsigned long fmtUs) {
+    Serial.print(F("BENCH fmt="));
+    Serial.print(name);
+    Serial.print(F(" snprintf="));
+    Serial.print(refUs * (F_CPU / 1000000UL) / FORMAT_BENCH_RUNS);
+    Serial.print(F(" format="));
+    Serial.println(fmtUs * (F_CPU / 1000000UL) / FORMAT_BENCH_RUNS);
+  }
+
+  void benchmark() {
+    char buf[16];
+    unsigned long start, ref;
+
+    start = micros();
+    for (int i = 0; i < FORMAT_BENCH_RUNS; i++) snprintf(buf, sizeof(buf), "%dmm", benchValue + i);
+    ref = micros() - start;
+    start = micros();
+    for (int i = 0; i < FORMAT_BENCH_RUNS; i++) putStr(putUInt(buf, benchValue + i), "mm");
+    report(F("distance"), ref, micros() - start);
+
+    start = micros();
+    for (int i = 0; i < FORMAT_BENCH_RUNS; i++) snprintf(buf, sizeof(buf), "%.1fC", (benchValue + i) / 4.0f);
+    ref = micros() - start;
+    start = micros();
+    for (int i = 0; i < FORMAT_BENCH_RUNS; i++) putChar(putQuarters(buf, benchValue + i), 'C');
+    report(F("temp"), ref, micros() - start);
+
+    start = micros();
+    for (int i = 0; i < FORMAT_BENCH_RUNS; i++) {
+      uint8_t v = benchValue + i;
+      snprintf(buf, sizeof(buf), "%02d:%02d:%02d", v % 24, v % 60, v % 60);
+    }
+    ref = micros() - start;
+    start = micros();
+    for (int i = 0; i < FORMAT_BENCH_RUNS; i++) {
+      uint8_t v = benchValue + i;
+      char* p = putUInt(buf, v % 24, 2);
+      p = putUInt(putChar(p, ':'), v % 60, 2);
+      putUInt(putChar(p, ':'), v % 60, 2);
+    }
+    report(F("time"), ref, micros() - start);
+  }
+  #endif
+}
@@ -0,0 +1,343 @@
+/*
+ * I2C bus module - Shared transaction manager for OLED, VL53L0X and DS3231
+ *
+ * I2CBus::begin() is the only place the bus is set up. Transactions wait in
+ * two queues - high priority (sensor, RTC) is always served before low
+ * priority (display, sized for a whole page row) - and are started from
+ * service(), which loop() calls on every pass, and from the completion
+ * interrupt.
+ *
+ * Writes run in the background: they are handed to Wire's interrupt-driven
+ * TWI driver without waiting for completion (twi_writeTo with wait = 0), so
+ * the CPU keeps rendering while bytes are on the wire. Reads are short and
+ * complete in place. The TWI vector itself belongs to Wire (the VL53L0X
+ * library still links it for its init sequence) and Wire has no completion
+ * callback, so each background write arms Timer0 compare B for when its
+ * bytes should be out. That interrupt finishes the write and starts the
+ * next queued one, so a page row drains while loop() renders the next. It
+ * only starts writes without a callback; reads and callbacks wait for
+ * service().
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+#include <U8g2lib.h>
+#include <util/atomic.h>
+#include "config.h"
+
+extern "C" {
+  #include <utility/twi.h>
+}
+
+namespace I2CBus {
+  enum Priority {
+    PRIO_HIGH,
+    PRIO_LOW
+  };
+
+  // status: 0 = ok, otherwise a Wire error code (2 = address NACK,
+  // 4 = bus error, 5 = timeout - the bus was recovered, ...).
+  // data points into the queue slot - copy it before queuing new transfers.
+  typedef void (*Callback)(uint8_t status, const uint8_t* data, uint8_t len);
+
+  struct Transaction {
+    uint8_t addr;
+    uint8_t txLen;
+    uint8_t rxLen;       // > 0: read back after a repeated start
+    Callback done;
+    uint8_t data[I2C_MAX_XFER];
+  };
+
+  struct Queue {
+    Transaction* slots;
+    uint8_t size;
+    uint8_t head;
+    uint8_t count;
+  };
+
+  Transaction highSlots[I2C_QUEUE_LEN];
+  Transaction lowSlots[I2C_LOW_QUEUE_LEN];
+  Queue queues[2] = {
+    {highSlots, I2C_QUEUE_LEN, 0, 0},
+    {lowSlots, I2C_LOW_QUEUE_LEN, 0, 0}
+  };
+
+  // Shared with the completion interrupt
+  volatile bool inFlight = false; // Background write not yet seen complete
+  Callback inFlightDone = 0;
+  uint8_t inFlightStatus = 0;     // What twi_writeTo() returned for it
+  unsigned long inFlightStart = 0;
+  volatile bool foreground = false;  // Blocking transfer using the driver
+
+  Transaction* building = 0;      // Display transfer being assembled
+
+  unsigned long transactions = 0;
+  uint16_t busErrors = 0;
+  uint8_t lastStatus = 0;         // Of the last transaction to finish
+
+  // Timer0 counts every 64 CPU clocks; 9 SCL periods per byte
+  #define I2C_TICKS_PER_BYTE ((9UL * F_CPU / 64 + I2C_CLOCK_HZ - 1) / I2C_CLOCK_HZ)
+
+  void begin() {
+    Wire.begin();
+    Wire.setClock(I2C_CLOCK_HZ);
+    Wire.setWireTimeout(I2C_TIMEOUT_US, true);
+  }
+
+  // After a STOP the TWI reports "no relevant state" (0xF8)
+  bool hardwareIdle() {
+    return (TWSR & 0xF8) == 0xF8 && !(TWCR & (_BV(TWSTA) | _BV(TWSTO)));
+  }
+
+  // Fire the completion interrupt when `bytes` should be on the wire. A
+  // long write at a slow clock may not be done yet; the interrupt then
+  // checks again a byte later.
+  void armCompletion(uint8_t bytes) {
+    uint16_t ticks = bytes * I2C_TICKS_PER_BYTE + 1;
+    OCR0B = TCNT0 + (ticks > 255 ? 255 : ticks);
+    TIFR0 = _BV(OCF0B);
+    TIMSK0 |= _BV(OCIE0B);
+  }
+
+  // Clock out a slave that is holding SDA low, then restart the TWI. A
+  // write still in flight finishes with `status`.
+  void recoverBus(uint8_t status = 5) {
+    busErrors++;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      TIMSK0 &= ~_BV(OCIE0B);
+    }
+    if (inFlight) {
+      inFlight = false;
+      lastStatus = status;
+      if (inFlightDone) inFlightDone(status, 0, 0);
+    }
+    Wire.end();
+
+    pinMode(SDA, INPUT_PULLUP);
+    for (uint8_t i = 0; i < 9 && digitalRead(SDA) == LOW; i++) {
+      pinMode(SCL, OUTPUT);
+      digitalWrite(SCL, LOW);
+      delayMicroseconds(5);
+      pinMode(SCL, INPUT_PULLUP);
+      delayMicroseconds(5);
+    }
+
+    // STOP: SDA rises while SCL is high
+    pinMode(SDA, OUTPUT);
+    digitalWrite(SDA, LOW);
+    delayMicroseconds(5);
+    pinMode(SDA, INPUT_PULLUP);
+
+    begin();
+  }
+
+  void checkTimeout() {
+    if (Wire.getWireTimeoutFlag()) {
+      Wire.clearWireTimeoutFlag();
+      recoverBus();
+    }
+  }
+
+  // Foreground write + repeated start + read
+  uint8_t transfer(uint8_t addr, uint8_t* data, uint8_t txLen, uint8_t rxLen) {
+    transactions++;
+    uint8_t status = twi_writeTo(addr, data, txLen, 1, 0);
+    if (status == 0 && twi_readFrom(addr, data, rxLen, 1) != rxLen) {
+      status = 4;
+    }
+    checkTimeout();
+    return status;
+  }
+
+  // Background write. Wire copies the bytes, so the slot can be reused
+  // right away. A write Wire refuses (too long, or a NACK where the driver
+  // reports one) is finished by the next service() with Wire's status.
+  void startWrite(Transaction& t) {
+    transactions++;
+    inFlight = true;
+    inFlightDone = t.done;
+    inFlightStatus = twi_writeTo(t.addr, t.data, t.txLen, 0, 1);
+    inFlightStart = millis();
+    if (inFlightStatus == 0) armCompletion(t.txLen + 1);
+  }
+
+  // Start queued writes, high queue first, until one is on the wire. A
+  // read is taken off the queue and returned for the caller to run in the
+  // foreground; nothing behind it starts first. The interrupt leaves reads
+  // and writes with a callback queued.
+  Transaction* startQueued(bool fromIsr) {
+    for (uint8_t q = PRIO_HIGH; q <= PRIO_LOW && !inFlight; q++) {
+      Queue& queue = queues[q];
+      while (queue.count && !inFlight) {
+        Transaction& t = queue.slots[queue.head];
+        if (fromIsr && (t.rxLen || t.done)) return 0;
+        queue.head = (queue.head + 1) % queue.size;
+        queue.count--;
+        if (t.rxLen) {
+          foreground = true;
+          return &t;
+        }
+        startWrite(t);
+      }
+    }
+    return 0;
+  }
+
+  // Completion interrupt (Timer0 compare B)
+  void onCompletion() {
+    if (!inFlight || foreground) {
+      TIMSK0 &= ~_BV(OCIE0B);     // service() carries on
+      return;
+    }
+    if (!hardwareIdle()) {
+      OCR0B = TCNT0 + I2C_TICKS_PER_BYTE;
+      return;
+    }
+    TIMSK0 &= ~_BV(OCIE0B);
+    if (inFlightDone) return;     // Callbacks run from service()
+    inFlight = false;
+    lastStatus = 0;
+    startQueued(true);
+  }
+
+  // Finish the transfer on the wire and start queued ones, high first.
+  // Callbacks run here, with interrupts on.
+  void service() {
+    for (;;) {
+      Transaction* t = 0;
+      Callback done = 0;
+      bool finished = false;
+      uint8_t status = 0;
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (inFlight && !hardwareIdle()) {
+          if ((TWSR & 0xF8) == 0x00) status = 4;   // Illegal START/STOP on the bus
+          else if (millis() - inFlightStart > I2C_STUCK_MS) status = 5;
+        } else if (inFlight) {
+          inFlight = false;
+          finished = true;
+          status = lastStatus = inFlightStatus;
+          done = inFlightDone;
+        } else {
+          t = startQueued(false);
+        }
+      }
+
+      if (finished) {
+        if (done) done(status, 0, 0);
+        continue;
+      }
+      if (status) recoverBus(status);
+      if (!t) return;
+
+      status = transfer(t->addr, t->data, t->txLen, t->rxLen);
+      foreground = false;
+      lastStatus = status;
+      if (t->done) t->done(status, t->data, t->rxLen);
+    }
+  }
+
+  bool isIdle() {
+    service();
+    return !inFlight && !queues[PRIO_HIGH].count && !queues[PRIO_LOW].count;
+  }
+
+  // Drain everything (e.g. before the MCU goes to sleep)
+  void flush() {
+    while (!isIdle()) {}
+  }
+
+  // Next free slot; spins the engine while the queue is full. The display
+  // queue holds a page row, so that only happens once the next row is
+  // rendered before the last one is out.
+  Transaction* reserve(Priority prio) {
+    Queue& q = queues[prio];
+    while (q.count == q.size) service();
+    return &q.slots[(q.head + q.count) % q.size];
+  }
+
+  void commit(Priority prio) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      queues[prio].count++;
+    }
+    service();
+  }
+
+  // Queued write (register address first, then payload)
+  bool write(uint8_t addr, const uint8_t* data, uint8_t len,
+             Priority prio = PRIO_HIGH, Callback done = 0) {
+    if (len > I2C_MAX_XFER) return false;
+    Transaction* t = reserve(prio);
+    t->addr = addr;
+    t->txLen = len;
+    t->rxLen = 0;
+    t->done = done;
+    memcpy(t->data, data, len);
+    commit(prio);
+    return true;
+  }
+
+  // Queued register read; done() receives the bytes
+  bool readAsync(uint8_t addr, uint8_t reg, uint8_t len, Callback done,
+                 Priority prio = PRIO_HIGH) {
+    if (len > I2C_MAX_XFER) return false;
+    Transaction* t = reserve(prio);
+    t->addr = addr;
+    t->data[0] = reg;
+    t->txLen = 1;
+    t->rxLen = len;
+    t->done = done;
+    commit(prio);
+    return true;
+  }
+
+  // Blocking register read. Jumps both queues: it only waits for the
+  // transfer already on the wire.
+  bool read(uint8_t addr, uint8_t reg, uint8_t* buf, uint8_t len) {
+    for (bool claimed = false; !claimed; ) {
+      service();
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        claimed = !inFlight;
+        if (claimed) foreground = true;   // The interrupt starts nothing now
+      }
+    }
+    buf[0] = reg;
+    lastStatus = transfer(addr, buf, 1, len);
+    foreground = false;
+    return lastStatus == 0;
+  }
+
+  // U8x8 byte procedure - display transfers go through the low queue
+  uint8_t u8x8Byte(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr) {
+    switch (msg) {
+      case U8X8_MSG_BYTE_START_TRANSFER:
+        building = reserve(PRIO_LOW);
+        building->addr = u8x8_GetI2CAddress(u8x8) >> 1;
+        building->txLen = 0;
+        building->rxLen = 0;
+        building->done = 0;
+        break;
+      case U8X8_MSG_BYTE_SEND: {
+        uint8_t* p = (uint8_t*)arg_ptr;
+        while (arg_int-- && building->txLen < I2C_MAX_XFER) {
+          building->data[building->txLen++] = *p++;
+        }
+        break;
+      }
+      case U8X8_MSG_BYTE_END_TRANSFER:
+        building = 0;
+        commit(PRIO_LOW);
+        break;
+      case U8X8_MSG_BYTE_INIT:       // Bus is set up by I2CBus::begin()
+      case U8X8_MSG_BYTE_SET_DC:
+        break;
+      default:
+        return 0;
+    }
+    return 1;
+  }
+}
+
+ISR(TIMER0_COMPB_vect) {
+  I2CBus::onCompletion();
+}
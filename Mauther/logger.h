@@ -0,0 +1,286 @@
+/*
+ * Logger module - Distance and temperature history
+ * Only include if FEATURE_LOGGER is defined
+ *
+ * One sample every LOG_INTERVAL_MS goes into a ring of LOG_BLOCK_SIZE byte
+ * blocks. Each block starts with a header holding the absolute values and
+ * is followed by deltas, so dropping the oldest block never breaks decoding:
+ *
+ *   header  seq:u8 time:u32 interval_s:u16 distance:u16 temp_q:i16   (LE)
+ *   0DDDDTTT             distance delta -8..7, temp delta -4..3 (zigzag)
+ *   0x80 <varint> <varint>   any other delta pair (zigzag varints)
+ *   0xFF                 unused rest of the block
+ *   crc:u16              last two bytes, CRC-16/CCITT of the rest (LE)
+ *
+ * time is seconds since 2000-01-01 (uptime seconds without FEATURE_RTC),
+ * temp_q is the DS3231 reading in quarter degrees. A steady reading costs
+ * one byte per sample.
+ *
+ * The CRC is written when a block is closed (and into the open block when
+ * it is dumped), so a block torn by a power loss during its EEPROM copy
+ * is never taken for a valid one.
+ *
+ * With LOG_EEPROM_FLUSH every full block is copied to EEPROM, one byte per
+ * tick so the EEPROM write time never blocks the loop. Sending 'L' over USB
+ * serial dumps the log (console.h); Tools/log_decode.py turns it into CSV.
+ */
+
+#pragma once
+
+#ifdef FEATURE_LOGGER
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <util/crc16.h>
+#include "config.h"
+
+#ifdef FEATURE_DISTANCE_SENSOR
+#include "sensors.h"
+#endif
+
+#ifdef FEATURE_RTC
+#include "rtc_module.h"
+#endif
+
+#define LOG_HEADER_SIZE    11
+#define LOG_DATA_SIZE      (LOG_BLOCK_SIZE - 2)  // Everything before the CRC
+#define LOG_ESCAPE         0x80
+#define LOG_UNUSED         0xFF
+#define LOG_EEPROM_BLOCKS  ((E2END + 1 - EEPROM_ADDR_LOG) / LOG_BLOCK_SIZE)
+
+namespace Logger {
+  uint8_t blocks[LOG_RAM_BLOCKS][LOG_BLOCK_SIZE];
+  uint8_t current = 0;           // Block being filled
+  uint8_t blockCount = 0;        // Valid blocks in RAM, including current
+  uint8_t fill = LOG_DATA_SIZE;  // Bytes used in current (full = start a new one)
+  uint8_t seq = 0;
+
+  uint16_t lastDistance = 0;
+  int16_t lastTemp = 0;
+  unsigned long lastLog = 0;
+  unsigned long samples = 0;
+
+  #ifdef LOG_EEPROM_FLUSH
+  uint8_t eepromNext = 0;        // EEPROM slot the next full block goes to
+  uint8_t pendingFlush = 0;      // Full RAM blocks not yet in EEPROM
+  uint8_t flushByte = 0;
+  unsigned long lostBlocks = 0;  // Overwritten in RAM before reaching EEPROM
+  #endif
+
+  uint16_t zigzag(int16_t v) {
+    return (uint16_t)((v << 1) ^ (v >> 15));
+  }
+
+  uint8_t* putVarint(uint8_t* p, uint16_t v) {
+    while (v >= 0x80) {
+      *p++ = v | 0x80;
+      v >>= 7;
+    }
+    *p++ = v;
+    return p;
+  }
+
+  uint8_t* putWord(uint8_t* p, uint16_t v) {
+    *p++ = v;
+    *p++ = v >> 8;
+    return p;
+  }
+
+  uint16_t crc(const uint8_t* block) {
+    uint16_t c = 0xFFFF;
+    for (uint8_t i = 0; i < LOG_DATA_SIZE; i++) c = _crc_ccitt_update(c, block[i]);
+    return c;
+  }
+
+  void seal(uint8_t* block) {
+    uint16_t c = crc(block);
+    block[LOG_DATA_SIZE] = c;
+    block[LOG_DATA_SIZE + 1] = c >> 8;
+  }
+
+  uint32_t now() {
+    #ifdef FEATURE_RTC
+    return RTCModule::getSecondsSince2000();
+    #else
+    return millis() / 1000;
+    #endif
+  }
+
+  #ifdef LOG_EEPROM_FLUSH
+  uint16_t slotAddr(uint8_t slot) {
+    return EEPROM_ADDR_LOG + slot * LOG_BLOCK_SIZE;
+  }
+
+  // Slot holds a complete block: the CRC matches. Empty (all 0xFF) and
+  // half-written slots fail it.
+  bool slotUsed(uint8_t slot) {
+    uint8_t block[LOG_BLOCK_SIZE];
+    for (uint8_t b = 0; b < LOG_BLOCK_SIZE; b++) block[b] = EEPROM.read(slotAddr(slot) + b);
+    return crc(block) == (block[LOG_DATA_SIZE] | (block[LOG_DATA_SIZE + 1] << 8));
+  }
+
+  // Blocks are written in order with an incrementing seq, so the newest is
+  // the last one whose successor is empty or out of sequence
+  void findEEPROMHead() {
+    eepromNext = 0;
+    for (uint8_t i = 0; i < LOG_EEPROM_BLOCKS && slotUsed(i); i++) {
+      uint8_t next = (i + 1) % LOG_EEPROM_BLOCKS;
+      eepromNext = next;
+      seq = EEPROM.read(slotAddr(i)) + 1;
+      if (EEPROM.read(slotAddr(next)) != seq) break;
+    }
+  }
+  #endif
+
+  void begin() {
+    #ifdef LOG_EEPROM_FLUSH
+    findEEPROMHead();
+    #endif
+    lastLog = millis();
+  }
+
+  // Start a new block with this sample as its absolute values
+  void startBlock(uint16_t distance, int16_t temp) {
+    current = (current + 1) % LOG_RAM_BLOCKS;
+    if (blockCount < LOG_RAM_BLOCKS) blockCount++;
+
+    #ifdef LOG_EEPROM_FLUSH
+    // Oldest pending block is about to be overwritten
+    if (pendingFlush == LOG_RAM_BLOCKS) {
+      pendingFlush--;
+      flushByte = 0;
+      lostBlocks++;
+    }
+    #endif
+
+    uint8_t* p = blocks[current];
+    memset(p, LOG_UNUSED, LOG_BLOCK_SIZE);
+    uint32_t t = now();
+    *p++ = seq++;
+    p = putWord(p, t);
+    p = putWord(p, t >> 16);
+    p = putWord(p, LOG_INTERVAL_MS / 1000);
+    p = putWord(p, distance);
+    putWord(p, temp);
+    fill = LOG_HEADER_SIZE;
+  }
+
+  void append(uint16_t distance, int16_t temp) {
+    int16_t dd = distance - lastDistance;
+    int16_t dt = temp - lastTemp;
+    uint8_t* p = blocks[current] + fill;
+
+    if (fill < LOG_DATA_SIZE && dd >= -8 && dd <= 7 && dt >= -4 && dt <= 3) {
+      *p = (zigzag(dd) << 3) | zigzag(dt);
+      fill++;
+    } else if (fill + 7 <= LOG_DATA_SIZE) {
+      // Escape + two varints of at most 3 bytes each
+      *p++ = LOG_ESCAPE;
+      p = putVarint(p, zigzag(dd));
+      p = putVarint(p, zigzag(dt));
+      fill = p - blocks[current];
+    } else {
+      if (blockCount > 0) {
+        seal(blocks[current]);
+        #ifdef LOG_EEPROM_FLUSH
+        pendingFlush++;  // Current block is full - queue it
+        #endif
+      }
+      startBlock(distance, temp);
+    }
+
+    lastDistance = distance;
+    lastTemp = temp;
+    samples++;
+  }
+
+  // Dump: "MLOG", block size, block count, then blocks oldest first
+  void dump() {
+    uint8_t ramBlocks = blockCount;
+    uint8_t eepromBlocks = 0;
+
+    #ifdef LOG_EEPROM_FLUSH
+    // Only blocks not yet in EEPROM come from RAM. A half-written EEPROM
+    // slot is skipped - its RAM copy is sent instead.
+    ramBlocks = pendingFlush + (blockCount ? 1 : 0);
+    uint8_t skip = flushByte ? eepromNext : LOG_UNUSED;
+    for (uint8_t i = 0; i < LOG_EEPROM_BLOCKS; i++) {
+      if (i != skip && slotUsed(i)) eepromBlocks++;
+    }
+    #endif
+
+    if (blockCount) seal(blocks[current]);  // Resealed when it is closed
+
+    Serial.write((const uint8_t*)"MLOG", 4);
+    Serial.write(LOG_BLOCK_SIZE);
+    Serial.write(eepromBlocks + ramBlocks);
+
+    #ifdef LOG_EEPROM_FLUSH
+    // Oldest EEPROM block is the one the next flush would overwrite
+    uint8_t buf[LOG_BLOCK_SIZE];
+    for (uint8_t i = 0; i < LOG_EEPROM_BLOCKS; i++) {
+      uint8_t slot = (eepromNext + i) % LOG_EEPROM_BLOCKS;
+      if (slot == skip || !slotUsed(slot)) continue;
+      for (uint8_t b = 0; b < LOG_BLOCK_SIZE; b++) buf[b] = EEPROM.read(slotAddr(slot) + b);
+      Serial.write(buf, LOG_BLOCK_SIZE);
+    }
+    #endif
+
+    for (uint8_t i = ramBlocks; i > 0; i--) {
+      Serial.write(blocks[(current + LOG_RAM_BLOCKS + 1 - i) % LOG_RAM_BLOCKS], LOG_BLOCK_SIZE);
+    }
+  }
+
+  #ifdef LOG_EEPROM_FLUSH
+  // Copy the oldest pending block to EEPROM, one byte per call. The seq
+  // byte goes last, so a block torn by power loss breaks the sequence and
+  // is taken as the next slot to write on boot.
+  void serviceFlush() {
+    if (!pendingFlush || !eeprom_is_ready()) return;
+
+    uint8_t block = (current + LOG_RAM_BLOCKS - pendingFlush) % LOG_RAM_BLOCKS;
+    uint8_t b = (flushByte + 1) % LOG_BLOCK_SIZE;
+    EEPROM.update(slotAddr(eepromNext) + b, blocks[block][b]);
+
+    if (++flushByte == LOG_BLOCK_SIZE) {
+      flushByte = 0;
+      pendingFlush--;
+      eepromNext = (eepromNext + 1) % LOG_EEPROM_BLOCKS;
+    }
+  }
+  #endif
+
+  // No samples were taken while asleep, so the fixed interval no longer
+  // holds - the next sample starts a fresh block with its own time
+  void resume() {
+    fill = LOG_DATA_SIZE;
+    lastLog = millis();
+  }
+
+  // Scheduler task
+  void update() {
+    if (millis() - lastLog >= LOG_INTERVAL_MS) {
+      lastLog += LOG_INTERVAL_MS;
+
+      uint16_t distance = DISTANCE_MAX_RANGE + 1;
+      int16_t temp = 0;
+      #ifdef FEATURE_DISTANCE_SENSOR
+      distance = Sensors::getDistance();
+      #endif
+      #ifdef FEATURE_RTC
+      temp = RTCModule::getTemperatureQuarters();
+      #endif
+      append(distance, temp);
+    }
+
+    #ifdef LOG_EEPROM_FLUSH
+    serviceFlush();
+    #endif
+  }
+
+  unsigned long getSampleCount() {
+    return samples;
+  }
+}
+
+#endif // FEATURE_LOGGER
@@ -1,26 +1,36 @@
 /*
  * Menu module - Handles menu system and navigation
+ *
+ * Table driven: every MenuState has a Screen descriptor (handler plus
+ * optional enter/exit hooks) and every menu list is a MenuItem table, all
+ * in PROGMEM. Items are filtered by feature #ifdefs inside the tables, so
+ * item counts come from sizeof and SELECT maps straight to the item's
+ * target - nothing to keep in sync by hand. An item either enters a
+ * screen or opens a nested list.
  */
 
 #pragma once
 #include <Arduino.h>
-#include <U8g2lib.h>
 #include "config.h"
+#include "ui_text.h"
 #include "display.h"
+#include "view.h"
 #include "buttons.h"
 #include "actuators.h"
+#include "scheduler.h"
+#include "power.h"
+#include "format.h"
+#include "settings.h"
 
 #ifdef FEATURE_DISTANCE_SENSOR
 #include "sensors.h"
+#include "alarm.h"
 #endif
 
 #ifdef FEATURE_RTC
 #include "rtc_module.h"
 #endif
 
-// Access to u8g2 for direct drawing in menu
-extern U8G2_SH1106_128X64_NONAME_1_HW_I2C u8g2;
-
 namespace Menu {
   enum MenuState {
     MENU_MAIN_SCREEN,
@@ -30,34 +40,119 @@ namespace Menu {
     MENU_LED_TEST,
     MENU_BADUSB,
     MENU_SETTINGS,
-    MENU_SLEEP
+    MENU_EDITOR,
+    MENU_SLEEP,
+    #ifdef FEATURE_PROFILER
+    MENU_DEBUG,            // Hidden: long press UP on the main screen
+    #endif
+    MENU_STATE_COUNT
   };
 
-  MenuState currentMenu = MENU_MAIN_SCREEN;
-  int menuSelection = 0;
-  unsigned long lastActivity = 0;
-  bool distanceAlarmActive = false;
+  enum ListId {
+    LIST_MAIN,
+    LIST_SYSTEM,
+    LIST_COUNT,
+    LIST_NONE = 0xFF
+  };
 
-  const char* mainMenuItems[] = {
-    "Back",
+  struct MenuItem {
+    const char* label;     // PROGMEM
+    uint8_t state;         // MenuState entered on SELECT
+    uint8_t list;          // ListId opened instead, or LIST_NONE
+  };
+
+  struct MenuList {
+    const char* title;     // PROGMEM
+    const MenuItem* items; // PROGMEM
+    uint8_t count;
+  };
+
+  #define MENU_ITEM(label, state)  {label, state, LIST_NONE}
+  #define MENU_SUBMENU(label, list) {label, MENU_MAIN_MENU, list}
+  #define MENU_LIST(title, items)  {title, items, sizeof(items) / sizeof(items[0])}
+
+  UI_PSTR(labelBack, "Back");
+  UI_PSTR(labelDistance, "Distance");
+  UI_PSTR(labelLaser, "Laser");
+  UI_PSTR(labelLED, "LED");
+  UI_PSTR(labelBadUSB, "BadUSB");
+  UI_PSTR(labelSystem, "System");
+  UI_PSTR(labelInfo, "Info");
+  UI_PSTR(labelSettings, "Settings");
+  UI_PSTR(labelProfiler, "Profiler");
+  UI_PSTR(labelSleep, "Sleep");
+  UI_PSTR(titleMenu, "MENU");
+
+  const MenuItem mainItems[] PROGMEM = {
+    MENU_ITEM(labelBack, MENU_MAIN_SCREEN),
     #ifdef FEATURE_DISTANCE_SENSOR
-    "Distance",
+    MENU_ITEM(labelDistance, MENU_DISTANCE),
     #endif
-    "Laser",
-    "LED",
+    MENU_ITEM(labelLaser, MENU_LASER),
+    MENU_ITEM(labelLED, MENU_LED_TEST),
     #ifdef FEATURE_BADUSB
-    "BadUSB",
+    MENU_ITEM(labelBadUSB, MENU_BADUSB),
     #endif
-    #ifdef FEATURE_RTC
-    "Info",
+    MENU_SUBMENU(labelSystem, LIST_SYSTEM),
+    MENU_ITEM(labelSleep, MENU_SLEEP)
+  };
+
+  const MenuItem systemItems[] PROGMEM = {
+    MENU_SUBMENU(labelBack, LIST_MAIN),
+    MENU_ITEM(labelInfo, MENU_SETTINGS),
+    MENU_ITEM(labelSettings, MENU_EDITOR),
+    #ifdef FEATURE_PROFILER
+    MENU_ITEM(labelProfiler, MENU_DEBUG),
     #endif
-    "Sleep"
   };
 
+  // Indexed by ListId
+  const MenuList menuLists[] PROGMEM = {
+    MENU_LIST(titleMenu, mainItems),
+    MENU_LIST(labelSystem, systemItems)
+  };
+  static_assert(sizeof(menuLists) / sizeof(menuLists[0]) == LIST_COUNT, "menuLists out of sync with ListId");
+
+  MenuState currentMenu = MENU_MAIN_SCREEN;
+  MenuState previousMenu = MENU_MAIN_SCREEN;
+  uint8_t currentList = LIST_MAIN;
+  uint8_t listSelection[LIST_COUNT];     // Last selection per list
+  int menuSelection = 0;
+  unsigned long lastActivity = 0;
+  uint8_t editorId = 0;                  // Setting shown in the editor
+  bool editorEditing = false;            // UP/DN change its value
+
+  #ifdef FEATURE_PROFILER
+  uint8_t handlerProf[MENU_STATE_COUNT];  // Profiler section per handler
+  #endif
+
+  // Switch screens through the exit/enter hooks (defined with the table)
+  void enter(MenuState next);
+
+  // Back to the top of the main menu, run when the main screen is entered
+  void resetMenu() {
+    currentList = LIST_MAIN;
+    menuSelection = 0;
+    memset(listSelection, 0, sizeof(listSelection));
+  }
+
   void begin() {
     currentMenu = MENU_MAIN_SCREEN;
-    menuSelection = 0;
+    resetMenu();
     lastActivity = millis();
+
+    #ifdef FEATURE_PROFILER
+    handlerProf[MENU_MAIN_SCREEN] = Profiler::add(PROF_NAME("m.main"));
+    handlerProf[MENU_MAIN_MENU] = Profiler::add(PROF_NAME("m.menu"));
+    handlerProf[MENU_DISTANCE] = Profiler::add(PROF_NAME("m.distance"));
+    handlerProf[MENU_LASER] = Profiler::add(PROF_NAME("m.laser"));
+    handlerProf[MENU_LED_TEST] = Profiler::add(PROF_NAME("m.led"));
+    handlerProf[MENU_BADUSB] = Profiler::add(PROF_NAME("m.badusb"));
+    handlerProf[MENU_SETTINGS] = Profiler::add(PROF_NAME("m.info"));
+    handlerProf[MENU_EDITOR] = Profiler::add(PROF_NAME("m.editor"));
+    handlerProf[MENU_SLEEP] = Profiler::add(PROF_NAME("m.sleep"));
+    handlerProf[MENU_DEBUG] = Profiler::add(PROF_NAME("m.debug"));
+    #endif
     
     // Ensure LED is OFF when starting
     #ifdef FEATURE_LED
@@ -69,15 +164,12 @@ namespace Menu {
     lastActivity = millis();
   }
 
+  // Not while asleep: in idle sleep millis() keeps counting, and on wake
+  // handleSleep() must turn the display back on before leaving the screen
   void checkTimeout() {
-    if (currentMenu != MENU_MAIN_SCREEN) {
+    if (currentMenu != MENU_MAIN_SCREEN && currentMenu != MENU_SLEEP) {
       if (millis() - lastActivity > MENU_TIMEOUT_MS) {
-        currentMenu = MENU_MAIN_SCREEN;
-        menuSelection = 0;
-        // Turn off LED when returning to main screen
-        #ifdef FEATURE_LED
-        Actuators::setLEDOff();
-        #endif
+        enter(MENU_MAIN_SCREEN);   // The LED test turns its LED off on exit
       }
     }
   }
@@ -85,12 +177,12 @@ namespace Menu {
   void handleMainScreen() {
     // Get current data
     char timeStr[16] = "00:00:00";
-    float temp = 0.0;
+    int16_t temp = 0;  // Quarter degrees
     uint16_t distance = 9999;
     
     #ifdef FEATURE_RTC
     RTCModule::getTimeString(timeStr, sizeof(timeStr));
-    temp = RTCModule::getTemperature();
+    temp = RTCModule::getTemperatureQuarters();
     #endif
     
     #ifdef FEATURE_DISTANCE_SENSOR
@@ -99,151 +191,163 @@ namespace Menu {
     
     bool laserOn = Actuators::isLaserOn();
 
-    // Check distance alarm - LED only (no buzzer)
-    #ifdef FEATURE_DISTANCE_SENSOR
-    if (Sensors::isAlarmTriggered()) {
-      if (!distanceAlarmActive) {
-        Actuators::setLEDRed();
-        distanceAlarmActive = true;
-      }
-    } else {
-      if (distanceAlarmActive) {
-        Actuators::setLEDOff();
-        distanceAlarmActive = false;
-      }
-    }
-    #endif
-
     // Display main screen
-    Display::drawMainScreen(timeStr, temp, distance, laserOn);
+    struct {
+      int16_t temp;
+      uint16_t distance;
+      char time[9];
+      bool laserOn;
+    } view;
+    memset(&view, 0, sizeof(view));   // Padding too - compared with memcmp
+    memcpy(view.time, timeStr, sizeof(view.time));
+    view.time[8] = '\0';
+    view.temp = temp;
+    view.distance = distance;
+    view.laserOn = laserOn;
+    if (View::needsRedraw(currentMenu, view)) {
+      Display::drawWatchFace(timeStr, temp, distance, laserOn);
+    }
 
     // Check for button press to enter menu
     Buttons::Button btn = Buttons::getLastPressed();
     if (btn == Buttons::BTN_SELECT) {
-      currentMenu = MENU_MAIN_MENU;
-      menuSelection = 0;
+      enter(MENU_MAIN_MENU);
       resetTimeout();
     } else if (btn == Buttons::BTN_DOWN) {
       Actuators::laserToggle();
     }
+    #ifdef FEATURE_PROFILER
+    else if (btn == Buttons::BTN_UP && Buttons::getLastEvent() == Buttons::EVT_LONG_PRESS) {
+      enter(MENU_DEBUG);
+      resetTimeout();
+    }
+    #endif
+  }
+
+  const MenuItem* itemAt(uint8_t list, uint8_t index) {
+    const MenuItem* items = (const MenuItem*)pgm_read_ptr(&menuLists[list].items);
+    return items + index;
   }
 
+  const char* currentLabel(uint8_t index) {
+    return (const char*)pgm_read_ptr(&itemAt(currentList, index)->label);
+  }
+
+  // Any menu list; which one is currentList
   void handleMainMenu() {
-    Display::drawMenu("MENU", mainMenuItems, MENU_ITEMS, menuSelection);
+    uint8_t count = pgm_read_byte(&menuLists[currentList].count);
+
+    struct {
+      uint8_t list;
+      uint8_t selection;
+    } view;
+    memset(&view, 0, sizeof(view));   // Padding too - compared with memcmp
+    view.list = currentList;
+    view.selection = menuSelection;
+
+    if (View::needsRedraw(currentMenu, view)) {
+      char title[12];
+      strncpy_P(title, (const char*)pgm_read_ptr(&menuLists[currentList].title), sizeof(title) - 1);
+      title[sizeof(title) - 1] = '\0';
+      Display::drawMenuP(title, count, menuSelection, currentLabel);
+    }
 
     Buttons::Button btn = Buttons::getLastPressed();
     if (btn == Buttons::BTN_UP) {
-      menuSelection = (menuSelection - 1 + MENU_ITEMS) % MENU_ITEMS;
+      menuSelection = (menuSelection - 1 + count) % count;
       resetTimeout();
     } else if (btn == Buttons::BTN_DOWN) {
-      menuSelection = (menuSelection + 1) % MENU_ITEMS;
+      menuSelection = (menuSelection + 1) % count;
       resetTimeout();
     } else if (btn == Buttons::BTN_SELECT) {
       resetTimeout();
-      
-      // Map menu selection to actual menu state dynamically
-      // This adjusts for disabled features automatically
-      int itemIndex = 0;
-      
-      // Item 0: Always "Back"
-      if (menuSelection == itemIndex++) {
-        currentMenu = MENU_MAIN_SCREEN;
-        return;
-      }
-      
-      // Item 1: Distance (if enabled)
-      #ifdef FEATURE_DISTANCE_SENSOR
-      if (menuSelection == itemIndex++) {
-        currentMenu = MENU_DISTANCE;
-        return;
-      }
-      #endif
-      
-      // Item 2/3: Laser (always enabled)
-      if (menuSelection == itemIndex++) {
-        currentMenu = MENU_LASER;
-        return;
-      }
-      
-      // Item 3/4: LED (always enabled)
-      if (menuSelection == itemIndex++) {
-        currentMenu = MENU_LED_TEST;
-        return;
-      }
-      
-      // Item 4/5: BadUSB (if enabled)
-      #ifdef FEATURE_BADUSB
-      if (menuSelection == itemIndex++) {
-        currentMenu = MENU_BADUSB;
-        return;
-      }
-      #endif
-      
-      // Item 5/6: Info/Settings (if RTC enabled)
-      #ifdef FEATURE_RTC
-      if (menuSelection == itemIndex++) {
-        currentMenu = MENU_SETTINGS;
-        return;
-      }
-      #endif
-      
-      // Last item: Sleep (always enabled)
-      if (menuSelection == itemIndex++) {
-        currentMenu = MENU_SLEEP;
-        return;
+
+      const MenuItem* item = itemAt(currentList, menuSelection);
+      uint8_t list = pgm_read_byte(&item->list);
+      if (list != LIST_NONE) {
+        listSelection[currentList] = menuSelection;
+        currentList = list;
+        menuSelection = listSelection[list];
+      } else {
+        enter((MenuState)pgm_read_byte(&item->state));
       }
-      
-      // Default fallback
-      currentMenu = MENU_MAIN_SCREEN;
     }
   }
 
   void handleDistanceMenu() {
     #ifdef FEATURE_DISTANCE_SENSOR
-    char buf[12];
-    uint16_t d = Sensors::getDistance();
-    if (d > DISTANCE_MAX_RANGE) {
-      Display::drawCentered("---");
-    } else {
-      snprintf(buf, sizeof(buf), "%dmm", d);
-      Display::drawCentered(buf);
+    struct {
+      uint16_t distance;
+      uint16_t rate;
+      uint16_t noise;
+      uint8_t profile;
+    } view;
+    memset(&view, 0, sizeof(view));   // Padding too - compared with memcmp
+    view.distance = Sensors::getDistance();
+    view.rate = Sensors::getSampleRateX10();
+    view.noise = Sensors::getNoiseX10();
+    view.profile = Sensors::getProfile();
+
+    if (View::needsRedraw(currentMenu, view)) {
+      char dist[12], stats[22], name[10];
+      if (view.distance > DISTANCE_MAX_RANGE) {
+        strcpy(dist, UI_TEXT("---"));
+      } else {
+        Format::putStr(Format::putUInt(dist, view.distance), UI_TEXT("mm"));
+      }
+      char* p = Format::putStr(Format::putTenths(stats, view.rate), UI_TEXT("Hz sd"));
+      Format::putStr(Format::putTenths(p, view.noise), UI_TEXT("mm"));
+      strncpy_P(name, Sensors::getProfileName(), sizeof(name) - 1);
+      name[sizeof(name) - 1] = '\0';
+      Display::drawInfo(dist, name, stats);
+    }
+
+    // UP/DN cycles the ranging profile
+    Buttons::Button btn = Buttons::getLastPressed();
+    if (btn == Buttons::BTN_UP || btn == Buttons::BTN_DOWN) {
+      uint8_t step = (btn == Buttons::BTN_UP) ? Sensors::PROFILE_COUNT - 1 : 1;
+      Sensors::setProfile((Sensors::Profile)((view.profile + step) % Sensors::PROFILE_COUNT));
+      resetTimeout();
+    } else if (btn == Buttons::BTN_SELECT) {
+      enter(MENU_MAIN_MENU);
     }
     #else
-    Display::drawCentered("N/A");
-    #endif
+    if (View::needsRedraw(currentMenu, (uint8_t)0)) {
+      Display::drawCentered(UI_TEXT("N/A"));
+    }
 
     if (Buttons::getLastPressed() == Buttons::BTN_SELECT) {
-      currentMenu = MENU_MAIN_MENU;
+      enter(MENU_MAIN_MENU);
     }
+    #endif
   }
 
   void handleLaserMenu() {
-    Display::drawCentered(Actuators::isLaserOn() ? "ON" : "OFF");
+    bool laserOn = Actuators::isLaserOn();
+    if (View::needsRedraw(currentMenu, laserOn)) {
+      Display::drawCentered(laserOn ? UI_TEXT("ON") : UI_TEXT("OFF"));
+    }
     
     Buttons::Button btn = Buttons::getLastPressed();
     if (btn == Buttons::BTN_DOWN || btn == Buttons::BTN_UP) {
       Actuators::laserToggle();
       resetTimeout();
     } else if (btn == Buttons::BTN_SELECT) {
-      currentMenu = MENU_MAIN_MENU;
+      enter(MENU_MAIN_MENU);
     }
   }
 
   void handleLEDTest() {
     static int colorIndex = 0;
-    const char* colors[] = {"OFF", "RED", "GRN", "BLU", "YEL"};
+    const char* colors[] = {UI_TEXT("OFF"), UI_TEXT("RED"), UI_TEXT("GRN"), UI_TEXT("BLU"), UI_TEXT("YEL"), UI_TEXT("FADE"), UI_TEXT("BLNK")};
     
-    u8g2.firstPage();
-    do {
-      u8g2.setFont(u8g2_font_6x10_tf);
-      u8g2.drawStr(0, 0, colors[colorIndex]);
-      u8g2.drawStr(0, 20, "UP/DN");
-      u8g2.drawStr(0, 35, "SEL:Back");
-    } while (u8g2.nextPage());
+    if (View::needsRedraw(currentMenu, colorIndex)) {
+      Display::drawInfo(colors[colorIndex], UI_TEXT("UP/DN"), UI_TEXT("SEL:Back"));
+    }
 
     Buttons::Button btn = Buttons::getLastPressed();
     if (btn == Buttons::BTN_UP || btn == Buttons::BTN_DOWN) {
-      colorIndex = (colorIndex + 1) % 5;
+      colorIndex = (colorIndex + 1) % 7;
       resetTimeout();
       
       #ifdef FEATURE_LED
@@ -253,124 +357,367 @@ namespace Menu {
         case 2: Actuators::setLEDGreen(); break;
         case 3: Actuators::setLEDBlue(); break;
         case 4: Actuators::setLEDYellow(); break;
+        case 5: Actuators::setEffect(Actuators::FX_BREATHE, LED_CYAN); break;
+        case 6: Actuators::setEffect(Actuators::FX_BLINK, LED_GREEN, 3); break;
       }
       #endif
     } else if (btn == Buttons::BTN_SELECT) {
-      currentMenu = MENU_MAIN_MENU;
-      Actuators::setLEDOff();
+      enter(MENU_MAIN_MENU);
     }
   }
 
   void handleBadUSB() {
     #ifdef FEATURE_BADUSB
-    u8g2.firstPage();
-    do {
-      u8g2.setFont(u8g2_font_6x10_tf);
-      u8g2.drawStr(0, 0, "BadUSB");
-      u8g2.drawStr(0, 20, "UP/DN:Run");
-      u8g2.drawStr(0, 35, "SEL:Back");
-    } while (u8g2.nextPage());
-    
+    static uint8_t selected = 0;
+    uint8_t count = max(BadUSB::getScriptCount(), (uint8_t)1);
+    if (selected >= count) selected = 0;  // Target OS changed in Settings
+
+    struct {
+      uint8_t selected;
+      uint8_t progress;
+      bool running;
+    } view;
+    memset(&view, 0, sizeof(view));   // Padding too - compared with memcmp
+    view.selected = selected;
+    view.progress = BadUSB::getProgress();
+    view.running = BadUSB::isRunning;
+
+    if (View::needsRedraw(currentMenu, view)) {
+      char name[12], line[12];
+      BadUSB::getScriptName(selected, name, sizeof(name));
+      if (view.running) {
+        Format::putChar(Format::putUInt(Format::putStr(line, UI_TEXT("Run ")), view.progress), '%');
+        Display::drawInfo(name, line, UI_TEXT("SEL:Cancel"));
+      } else {
+        Display::drawInfo(name, UI_TEXT("UP/DN SEL:Run"), UI_TEXT("Hold SEL:Back"));
+      }
+    }
+
     Buttons::Button btn = Buttons::getLastPressed();
-    if (btn == Buttons::BTN_UP || btn == Buttons::BTN_DOWN) {
-      Display::drawCentered("Run...");
-      BadUSB::runBrowserScript();
+    bool longPress = (Buttons::getLastEvent() == Buttons::EVT_LONG_PRESS);
+
+    if (view.running) {
+      // Script runs in the background; keep the menu responsive
+      if (btn == Buttons::BTN_SELECT) BadUSB::cancel();
+      resetTimeout();
+      return;
+    }
+
+    if (btn == Buttons::BTN_UP) {
+      selected = (selected + count - 1) % count;
+      resetTimeout();
+    } else if (btn == Buttons::BTN_DOWN) {
+      selected = (selected + 1) % count;
       resetTimeout();
-      delay(500);
     } else if (btn == Buttons::BTN_SELECT) {
-      currentMenu = MENU_MAIN_MENU;
+      if (longPress) {
+        enter(MENU_MAIN_MENU);
+      } else {
+        BadUSB::run(selected);
+        resetTimeout();
+      }
     }
     #else
-    Display::drawCentered("N/A");
+    if (View::needsRedraw(currentMenu, (uint8_t)0)) {
+      Display::drawCentered(UI_TEXT("N/A"));
+    }
     if (Buttons::getLastPressed() == Buttons::BTN_SELECT) {
-      currentMenu = MENU_MAIN_MENU;
+      enter(MENU_MAIN_MENU);
     }
     #endif
   }
 
   void handleSettings() {
     #ifdef FEATURE_RTC
-    char buf[12];
+    char buf[12] = {};  // Compared whole by needsRedraw(), not just up to the NUL
     RTCModule::getDateString(buf, sizeof(buf));
-    Display::drawCentered(buf);
+    if (View::needsRedraw(currentMenu, buf)) {
+      Display::drawCentered(buf);
+    }
     #else
-    Display::drawCentered("v1.0");
+    if (View::needsRedraw(currentMenu, (uint8_t)0)) {
+      Display::drawCentered(UI_TEXT("v1.0"));
+    }
     #endif
     
     if (Buttons::getLastPressed() == Buttons::BTN_SELECT) {
-      currentMenu = MENU_MAIN_MENU;
+      enter(MENU_MAIN_MENU);
     }
   }
 
-  void handleSleep() {
-    static bool sleeping = false;
-    
-    if (!sleeping) {
-      // Going to sleep
-      sleeping = true;
-      
-      // Show sleep message
-      u8g2.firstPage();
-      do {
-        u8g2.setFont(u8g2_font_6x10_tf);
-        u8g2.drawStr(20, 25, "Sleep Mode");
-        u8g2.drawStr(10, 40, "Press any btn");
-      } while (u8g2.nextPage());
-      
-      delay(1000);
-      
-      // Turn off all components
-      #ifdef FEATURE_LED
-      Actuators::setLEDOff();
-      #endif
-      
-      #ifdef FEATURE_LASER
-      Actuators::laserOff();
-      #endif
-      
-      // Turn off display
-      Display::turnOff();
+  // Settings editor. UP/DN picks a setting, SEL edits it: UP/DN then
+  // change the value (hold for five steps) and SEL is done. Hold SEL to go
+  // back. Changes apply right away; Settings saves them once they settle.
+  void handleEditor() {
+    int16_t value = 0;
+    Settings::get(editorId, value);
+
+    struct {
+      int16_t value;
+      uint8_t id;
+      bool editing;
+    } view;
+    memset(&view, 0, sizeof(view));   // Padding too - compared with memcmp
+    view.value = value;
+    view.id = editorId;
+    view.editing = editorEditing;
+
+    if (View::needsRedraw(currentMenu, view)) {
+      char name[12], choice[10], line[16];
+      strncpy_P(name, Settings::getName(editorId), sizeof(name) - 1);
+      name[sizeof(name) - 1] = '\0';
+      Settings::getChoiceName(editorId, value, choice, sizeof(choice));
+
+      char* p = editorEditing ? Format::putStr(line, UI_TEXT("< ")) : line;
+      p = choice[0] ? Format::putStr(p, choice) : Format::putInt(p, value);
+      if (editorEditing) Format::putStr(p, UI_TEXT(" >"));
+      Display::drawInfo(name, line, editorEditing ? UI_TEXT("SEL:Done") : UI_TEXT("SEL:Edit Hold:Back"));
     }
+
+    Buttons::Button btn = Buttons::getLastPressed();
+    if (btn == Buttons::BTN_NONE) return;
+    bool longPress = (Buttons::getLastEvent() == Buttons::EVT_LONG_PRESS);
+    resetTimeout();
+
+    if (editorEditing) {
+      if (btn == Buttons::BTN_SELECT) {
+        editorEditing = false;
+        #ifdef BUZZER_CHIRPS
+        Actuators::play(Actuators::melodyChirp);
+        #endif
+        return;
+      }
+      int16_t lo = Settings::getMin(editorId), hi = Settings::getMax(editorId);
+      int16_t step = Settings::getStep(editorId) * (longPress ? 5 : 1);
+      if (btn == Buttons::BTN_DOWN) step = -step;
+
+      if (Settings::getChoices(editorId)) {
+        // Choices wrap around, numbers stop at the ends
+        int16_t range = hi - lo + 1;
+        value = lo + ((value - lo + step) % range + range) % range;
+      } else {
+        value = constrain((int32_t)value + step, lo, hi);
+      }
+      Settings::set(editorId, value);
+    } else if (btn == Buttons::BTN_UP) {
+      editorId = (editorId + Settings::SET_COUNT - 1) % Settings::SET_COUNT;
+    } else if (btn == Buttons::BTN_DOWN) {
+      editorId = (editorId + 1) % Settings::SET_COUNT;
+    } else if (btn == Buttons::BTN_SELECT) {
+      if (longPress) {
+        enter(MENU_MAIN_MENU);
+      } else {
+        editorEditing = true;
+      }
+    }
+  }
+
+  #ifdef FEATURE_PROFILER
+  // Last debug page: counters kept since boot
+  void drawCounters() {
+    const char* lines[4];
+    uint8_t n = 0;
+
+    char frames[24];   // "Frm " drawn '/' skipped
+    char* p = Format::putChar(Format::putULong(Format::putStr(frames, UI_TEXT("Frm ")), View::getFramesDrawn()), '/');
+    Format::putULong(p, View::getFramesSkipped());
+    lines[n++] = frames;
+
+    char bytes[22];    // I2C payload of the frame before this one
+    Format::putChar(Format::putUInt(Format::putStr(bytes, UI_TEXT("Last frame ")), Display::getLastFrameBytes()), 'B');
+    lines[n++] = bytes;
+
+    #ifdef FEATURE_LED
+    char led[22];      // show() calls and the longest, interrupts off
+    p = Format::putStr(Format::putUInt(Format::putStr(led, UI_TEXT("LED ")), Actuators::getShowCount()), UI_TEXT("x max "));
+    Format::putStr(Format::putUInt(p, Actuators::getIrqOffMaxUs()), UI_TEXT("us"));
+    lines[n++] = led;
+    #endif
+
+    #ifdef FEATURE_DISTANCE_SENSOR
+    char dropped[22];  // Sensor samples overwritten before they were read
+    Format::putULong(Format::putStr(dropped, UI_TEXT("Dropped ")), Sensors::getDroppedSamples());
+    lines[n++] = dropped;
+    #endif
+
+    Display::drawLines(UI_TEXT("Counters"), lines, n);
+  }
+
+  // Profiler statistics, one section per screen, then the counters. The
+  // view is refreshed twice a second so the screen does not dominate its
+  // own figures.
+  void handleDebug() {
+    static uint8_t section = 0;
+    uint8_t count = Profiler::getSectionCount() + 1;   // + counters
+    if (section >= count) section = 0;
+
+    struct {
+      uint8_t section;
+      uint16_t tick;
+    } view;
+    memset(&view, 0, sizeof(view));   // Padding too - compared with memcmp
+    view.section = section;
+    view.tick = millis() / 500;
+
+    if (View::needsRedraw(currentMenu, view)) {
+      if (section == count - 1) {
+        drawCounters();
+      } else {
+        const Profiler::Section& s = Profiler::getSection(section);
+        char title[22], stats[22];
+        strncpy_P(title, s.name, sizeof(title) - 7);  // Room for " 65535"
+        title[sizeof(title) - 7] = '\0';
+        Format::putUInt(Format::putChar(title + strlen(title), ' '), s.count);
+        if (s.count) {
+          char* p = Format::putChar(Format::putUInt(stats, s.minUs), '/');
+          p = Format::putChar(Format::putUInt(p, Profiler::getMeanUs(s)), '/');
+          Format::putStr(Format::putUInt(p, s.maxUs), UI_TEXT("us"));
+        } else {
+          strcpy(stats, UI_TEXT("-"));
+        }
+        Display::drawProfile(title, stats, s.buckets);
+      }
+    }
+
+    // UP/DN: section, SEL: back, hold SEL: start a new window
+    Buttons::Button btn = Buttons::getLastPressed();
+    if (btn == Buttons::BTN_UP) {
+      section = (section + count - 1) % count;
+      resetTimeout();
+    } else if (btn == Buttons::BTN_DOWN) {
+      section = (section + 1) % count;
+      resetTimeout();
+    } else if (btn == Buttons::BTN_SELECT) {
+      if (Buttons::getLastEvent() == Buttons::EVT_LONG_PRESS) {
+        Profiler::reset();
+        resetTimeout();
+      } else {
+        enter(previousMenu);
+      }
+    }
+  }
+  #endif
+
+  // Show the sleep message for a second, then power things down
+  Continuation sleepCo;
+
+  bool sleepSequence() {
+    CO_BEGIN(sleepCo);
+    Display::drawSleepScreen();
+    View::invalidate();
+    
+    CO_DELAY(sleepCo, 1000);
     
-    // Wait for any button to wake
+    // Turn off all components
+    #ifdef FEATURE_DISTANCE_SENSOR
+    Alarm::reset();
+    #endif
+
+    #ifdef FEATURE_LED
+    Actuators::setLEDOff();
+    Actuators::refresh();
+    #endif
+    
+    #ifdef FEATURE_LASER
+    Actuators::laserOff();
+    #endif
+    
+    // Turn off display
+    Display::turnOff();
+    CO_END(sleepCo);
+  }
+
+  void handleSleep() {
+    // Power::service() has slept and woken - show the time right away
+    if (Power::isWaking()) {
+      CO_RESET(sleepCo);
+      Display::turnOn();
+      View::invalidate();
+      enter(MENU_MAIN_SCREEN);
+      handleMainScreen();
+      Power::frameShown();
+      return;
+    }
+
+    if (sleepSequence()) {
+      Power::request();  // MCU sleeps when loop() gets to Power::service()
+      return;
+    }
+
+    // Any button cancels a sleep still in progress
     if (Buttons::getLastPressed() != Buttons::BTN_NONE) {
-      // Wake up
       Display::turnOn();
-      sleeping = false;
-      currentMenu = MENU_MAIN_SCREEN;
-      delay(100); // Debounce
+      View::invalidate();
+      CO_RESET(sleepCo);
+      enter(MENU_MAIN_SCREEN);
     }
   }
 
+  void ledTestExit() {
+    Actuators::setLEDOff();
+    #ifdef FEATURE_DISTANCE_SENSOR
+    Alarm::restore();   // A zone still active gets its LED back
+    #endif
+  }
+
+  // Leaving the editor (or timing out of it) saves without waiting
+  void editorExit() {
+    editorEditing = false;
+    Settings::saveNow();
+  }
+
+  struct Screen {
+    void (*handler)();
+    void (*onEnter)();     // Optional hooks, 0 if unused
+    void (*onExit)();
+  };
+
+  // Indexed by MenuState
+  const Screen screens[] PROGMEM = {
+    {handleMainScreen, resetMenu, 0},
+    {handleMainMenu, 0, 0},
+    {handleDistanceMenu, 0, 0},
+    {handleLaserMenu, 0, 0},
+    {handleLEDTest, 0, ledTestExit},
+    {handleBadUSB, 0, 0},
+    {handleSettings, 0, 0},
+    {handleEditor, 0, editorExit},
+    {handleSleep, 0, 0},
+    #ifdef FEATURE_PROFILER
+    {handleDebug, 0, 0},
+    #endif
+  };
+  static_assert(sizeof(screens) / sizeof(screens[0]) == MENU_STATE_COUNT, "screens out of sync with MenuState");
+
+  typedef void (*Hook)();
+
+  void enter(MenuState next) {
+    if (next == currentMenu) return;
+    Hook exit = (Hook)pgm_read_ptr(&screens[currentMenu].onExit);
+    if (exit) exit();
+    previousMenu = currentMenu;
+    currentMenu = next;
+    Hook init = (Hook)pgm_read_ptr(&screens[next].onEnter);
+    if (init) init();
+  }
+
   void update() {
     checkTimeout();
 
-    switch (currentMenu) {
-      case MENU_MAIN_SCREEN:
-        handleMainScreen();
-        break;
-      case MENU_MAIN_MENU:
-        handleMainMenu();
-        break;
-      case MENU_DISTANCE:
-        handleDistanceMenu();
-        break;
-      case MENU_LASER:
-        handleLaserMenu();
-        break;
-      case MENU_LED_TEST:
-        handleLEDTest();
-        break;
-      case MENU_BADUSB:
-        handleBadUSB();
-        break;
-      case MENU_SETTINGS:
-        handleSettings();
-        break;
-      case MENU_SLEEP:
-        handleSleep();
-        break;
-    }
+    // Distance alarm zone with ALARM_WAKE fired - show the distance
+    #ifdef FEATURE_DISTANCE_SENSOR
+    if (Alarm::takeWake() && currentMenu != MENU_SLEEP) enter(MENU_MAIN_SCREEN);
+    #endif
+
+    #ifdef FEATURE_PROFILER
+    MenuState handler = currentMenu;
+    PROF_BEGIN();
+    #endif
+
+    ((Hook)pgm_read_ptr(&screens[currentMenu].handler))();
+
+    #ifdef FEATURE_PROFILER
+    PROF_END(handlerProf[handler]);
+    #endif
   }
 }
-
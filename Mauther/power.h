@@ -0,0 +1,181 @@
+/*
+ * Power module - Low-power sleep until a button is pressed
+ *
+ * Menu asks for sleep with request(); loop() calls service(), which runs
+ * outside the scheduler so the sleep never shows up as a task overrun.
+ * Peripherals are put in standby (VL53L0X stops ranging, the DS3231 square
+ * wave is silenced, the ADC is disabled) and the MCU sleeps until one of
+ * the button pin-change interrupts fires, then everything is restored.
+ *
+ * SLEEP_MODE_PWR_DOWN stops every clock, including USB - it is only used
+ * when no host has configured the USB device. On USB, SLEEP_MODE_IDLE
+ * keeps the port alive (Timer0 still wakes the CPU every millisecond).
+ *
+ * The press that wakes the watch is swallowed, and the time from wake to
+ * the first complete frame is measured (getWakeToFrameUs()). In power-down
+ * micros() stands still, so the oscillator start-up (SUT fuses, ~1ms on
+ * the Leonardo) comes on top.
+ *
+ * Boot is measured the same way: getBootToFrameUs() is micros() when the
+ * first frame has gone out to the panel, i.e. from the start of the sketch
+ * (the bootloader's own wait is not included). isColdStart() tells a power
+ * on from a warm reset (reset button, upload, watchdog) by a marker in
+ * .noinit RAM, which only a power loss scrambles. The Caterina bootloader
+ * clears MCUSR, so the reset flags cannot be used for this.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <avr/sleep.h>
+#include "config.h"
+#include "i2c_bus.h"
+#include "buttons.h"
+#include "scheduler.h"
+
+#ifdef FEATURE_DISTANCE_SENSOR
+#include "sensors.h"
+#endif
+
+#ifdef FEATURE_RTC
+#include "rtc_module.h"
+#endif
+
+#ifdef FEATURE_BADUSB
+#include "badusb.h"
+#endif
+
+#ifdef FEATURE_LOGGER
+#include "logger.h"
+#endif
+
+#define POWER_WARM_MARKER 0x5EB00715UL
+
+namespace Power {
+  uint32_t resetMarker __attribute__((section(".noinit")));
+  bool coldStart = false;
+  unsigned long bootToFrameUs = 0;
+
+  bool requested = false;
+  bool waking = false;           // Woke, first frame not shown yet
+  bool lastDeep = false;         // Last sleep was a power-down
+  unsigned long wakeUs = 0;
+  uint16_t wakeToFrameUs = 0;
+
+  // First thing in setup()
+  void boot() {
+    coldStart = (resetMarker != POWER_WARM_MARKER);
+    resetMarker = POWER_WARM_MARKER;
+  }
+
+  bool isColdStart() {
+    return coldStart;
+  }
+
+  // setup() has drawn the first frame; waits for it to reach the panel
+  void bootFrameShown() {
+    I2CBus::flush();
+    bootToFrameUs = micros();
+
+    #ifdef DEBUG_MODE
+    Serial.print(coldStart ? F("Cold") : F("Warm"));
+    Serial.print(F(" boot to first frame (us): "));
+    Serial.println(bootToFrameUs);
+    #endif
+  }
+
+  unsigned long getBootToFrameUs() {
+    return bootToFrameUs;
+  }
+
+  void request() {
+    requested = true;
+  }
+
+  bool isWaking() {
+    return waking;
+  }
+
+  void standbyPeripherals() {
+    #ifdef FEATURE_BADUSB
+    if (BadUSB::isRunning) BadUSB::cancel();  // Never sleep with keys held
+    #endif
+
+    #ifdef FEATURE_DISTANCE_SENSOR
+    Sensors::standby();
+    #endif
+
+    #ifdef FEATURE_RTC
+    RTCModule::standby();
+    #endif
+
+    I2CBus::flush();
+  }
+
+  void resumePeripherals() {
+    #ifdef FEATURE_RTC
+    RTCModule::resume();
+    #endif
+
+    #ifdef FEATURE_DISTANCE_SENSOR
+    Sensors::resume();
+    #endif
+
+    #ifdef FEATURE_LOGGER
+    Logger::resume();
+    #endif
+  }
+
+  // Sleep until a button pin reads pressed. Other interrupts (Timer0 in
+  // idle, USB bus events) just send the CPU back to sleep.
+  void sleepUntilButton() {
+    lastDeep = !USBDevice.configured();
+    set_sleep_mode(lastDeep ? SLEEP_MODE_PWR_DOWN : SLEEP_MODE_IDLE);
+
+    uint8_t adc = ADCSRA;
+    ADCSRA = adc & ~_BV(ADEN);
+
+    for (;;) {
+      noInterrupts();
+      if (Buttons::anyHeld()) break;
+      sleep_enable();
+      interrupts();  // The instruction after sei always runs - no lost wake
+      sleep_cpu();
+      sleep_disable();
+    }
+    interrupts();
+
+    ADCSRA = adc;
+  }
+
+  // Called from loop()
+  void service() {
+    if (!requested) return;
+    requested = false;
+
+    standbyPeripherals();
+    sleepUntilButton();
+    wakeUs = micros();
+
+    Buttons::swallowHeld();
+    resumePeripherals();
+    Scheduler::resume();
+    waking = true;
+  }
+
+  // Menu has drawn the first frame after wake
+  void frameShown() {
+    if (!waking) return;
+    waking = false;
+    wakeToFrameUs = min(micros() - wakeUs, 0xFFFFUL);
+
+    #ifdef DEBUG_MODE
+    Serial.print(lastDeep ? F("Power-down") : F("Idle"));
+    Serial.print(F(" wake to first frame (us): "));
+    Serial.println(wakeToFrameUs);
+    #endif
+  }
+
+  uint16_t getWakeToFrameUs() {
+    return wakeToFrameUs;
+  }
+}
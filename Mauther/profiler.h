@@ -0,0 +1,132 @@
+/*
+ * Profiler module - Run time statistics per task, menu handler and frame
+ * Only active if FEATURE_PROFILER is defined - otherwise the PROF_* macros
+ * expand to nothing and no code or RAM is used.
+ *
+ * Each section keeps min, max and mean run time (micros(), 4us resolution)
+ * and a histogram with base-4 buckets: <16us, <64us, ... <64ms, >=64ms.
+ * Statistics cover a window of PROF_WINDOW_MS. With DEBUG_MODE every window
+ * is printed over USB serial; the hidden debug screen (long press UP on
+ * the main screen) shows the window in progress.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+#ifdef FEATURE_PROFILER
+
+#define PROF_NAME(s)   PSTR(s)
+#define PROF_BEGIN()   unsigned long profStart = micros()
+#define PROF_END(id)   Profiler::record(id, micros() - profStart)
+
+#define PROF_BUCKETS   8
+#define PROF_NONE      0xFF
+
+namespace Profiler {
+  struct Section {
+    const char* name;       // PROGMEM
+    uint16_t minUs;
+    uint16_t maxUs;
+    uint16_t count;
+    uint32_t sumUs;
+    uint16_t buckets[PROF_BUCKETS];
+  };
+
+  Section sections[PROF_MAX_SECTIONS];
+  uint8_t sectionCount = 0;
+  unsigned long windowStart = 0;
+
+  void clear(Section& s) {
+    const char* name = s.name;
+    memset(&s, 0, sizeof(s));
+    s.name = name;
+    s.minUs = 0xFFFF;
+  }
+
+  void reset() {
+    for (uint8_t i = 0; i < sectionCount; i++) clear(sections[i]);
+    windowStart = millis();
+  }
+
+  // Register a section. Returns its id, or PROF_NONE if the table is full.
+  uint8_t add(const char* name) {
+    if (!name || sectionCount >= PROF_MAX_SECTIONS) return PROF_NONE;
+    sections[sectionCount].name = name;
+    clear(sections[sectionCount]);
+    return sectionCount++;
+  }
+
+  void record(uint8_t id, unsigned long us) {
+    if (id >= sectionCount) return;
+    Section& s = sections[id];
+    uint16_t t = min(us, 0xFFFFUL);
+
+    if (t < s.minUs) s.minUs = t;
+    if (t > s.maxUs) s.maxUs = t;
+    if (s.count < 0xFFFF) {
+      s.count++;
+      s.sumUs += t;
+    }
+
+    // Bucket b holds times below 16 * 4^b us
+    uint8_t b = 0;
+    for (unsigned long limit = 16; b < PROF_BUCKETS - 1 && us >= limit; limit <<= 2) b++;
+    if (s.buckets[b] < 0xFFFF) s.buckets[b]++;
+  }
+
+  uint8_t getSectionCount() {
+    return sectionCount;
+  }
+
+  const Section& getSection(uint8_t id) {
+    return sections[id];
+  }
+
+  uint16_t getMeanUs(const Section& s) {
+    return s.count ? s.sumUs / s.count : 0;
+  }
+
+  #ifdef DEBUG_MODE
+  // PROF <name> n=<count> min=<us> avg=<us> max=<us> h=<b0>,...,<b7>
+  void print() {
+    for (uint8_t i = 0; i < sectionCount; i++) {
+      Section& s = sections[i];
+      if (!s.count) continue;
+      Serial.print(F("PROF "));
+      Serial.print((const __FlashStringHelper*)s.name);
+      Serial.print(F(" n="));
+      Serial.print(s.count);
+      Serial.print(F(" min="));
+      Serial.print(s.minUs);
+      Serial.print(F(" avg="));
+      Serial.print(getMeanUs(s));
+      Serial.print(F(" max="));
+      Serial.print(s.maxUs);
+      Serial.print(F(" h="));
+      for (uint8_t b = 0; b < PROF_BUCKETS; b++) {
+        if (b) Serial.print(',');
+        Serial.print(s.buckets[b]);
+      }
+      Serial.println();
+    }
+  }
+  #endif
+
+  // Scheduler task - closes the statistics window
+  void update() {
+    if (millis() - windowStart < PROF_WINDOW_MS) return;
+    #ifdef DEBUG_MODE
+    print();
+    #endif
+    reset();
+  }
+}
+
+#else
+
+#define PROF_NAME(s)   0
+#define PROF_BEGIN()
+#define PROF_END(id)
+
+#endif // FEATURE_PROFILER
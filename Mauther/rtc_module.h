@@ -1,6 +1,12 @@
 /*
  * RTC module - Handles DS3231 Real-Time Clock
  * Only include if FEATURE_RTC is defined
+ *
+ * Talks to the DS3231 registers directly through I2CBus. Time is kept in
+ * RAM and advanced once per second - from the DS3231's 1Hz square wave when
+ * PIN_RTC_SQW is wired, otherwise from millis(). Every RTC_RESYNC_MS the
+ * time and temperature are refreshed with a single burst read (the DS3231
+ * only updates its temperature every 64s anyway).
  */
 
 #pragma once
@@ -8,59 +14,295 @@
 #ifdef FEATURE_RTC
 
 #include <Arduino.h>
-#include <Wire.h>
-#include <RTClib.h>
 #include "config.h"
+#include "i2c_bus.h"
+#include "format.h"
+
+#define DS3231_REG_TIME    0x00
+#define DS3231_REG_CONTROL 0x0E
+#define DS3231_REG_STATUS  0x0F
+#define DS3231_REG_TEMP    0x11
+#define DS3231_STATUS_OSF  0x80  // Oscillator stopped - time is invalid
+#define DS3231_CTRL_SQW    0x1C  // INTCN + RS2:RS1 - all clear = 1Hz square wave
+#define DS3231_CTRL_INTCN  0x04  // Set = square wave output off
 
 namespace RTCModule {
-  RTC_DS3231 rtc;
+  struct Time {
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+  };
+
   bool rtcAvailable = false;
-  DateTime lastTime;
+  Time lastTime = {2000, 1, 1, 0, 0, 0};
+  int16_t tempQuarters = 0;         // Degrees C * 4, as the DS3231 reports it
+
+  unsigned long lastSync = 0;
+  bool resyncDue = false;
+
+  #ifdef PIN_RTC_SQW
+  volatile uint8_t sqwTicks = 0;    // Seconds signalled but not yet applied
+
+  void onSquareWave() {
+    sqwTicks++;
+  }
+  #else
+  unsigned long secondStart = 0;    // millis() when the current second began
+  unsigned long lastAlignPoll = 0;
+  bool aligning = false;            // Waiting for the seconds register to tick
+  #endif
+
+  // I2C transactions issued by this module, per minute
+  uint16_t txCount = 0;
+  uint16_t txPerMinute = 0;
+  unsigned long txWindowStart = 0;
+
+  uint8_t bcd2bin(uint8_t val) { return val - 6 * (val >> 4); }
+  uint8_t bin2bcd(uint8_t val) { return val + 6 * (val / 10); }
+
+  bool readRegs(uint8_t reg, uint8_t* buf, uint8_t len) {
+    txCount++;
+    return I2CBus::read(DS3231_ADDR, reg, buf, len);
+  }
+
+  void writeRegs(const uint8_t* buf, uint8_t len) {
+    txCount++;
+    I2CBus::write(DS3231_ADDR, buf, len);
+  }
+
+  // One burst from the seconds register through the temperature LSB
+  bool readAll() {
+    uint8_t r[DS3231_REG_TEMP + 2];
+    if (!readRegs(DS3231_REG_TIME, r, sizeof(r))) return false;
+
+    lastTime.second = bcd2bin(r[0] & 0x7F);
+    lastTime.minute = bcd2bin(r[1]);
+    lastTime.hour = bcd2bin(r[2] & 0x3F);  // 24h mode
+    lastTime.day = bcd2bin(r[4]);
+    lastTime.month = bcd2bin(r[5] & 0x7F);
+    lastTime.year = 2000 + bcd2bin(r[6]);
+
+    // 10-bit two's complement, quarter degrees in the top two LSB bits
+    tempQuarters = (int16_t)((r[DS3231_REG_TEMP] << 8) | r[DS3231_REG_TEMP + 1]) >> 6;
+
+    lastSync = millis();
+    resyncDue = false;
+    return true;
+  }
+
+  void advanceSecond() {
+    if (++lastTime.second < 60) return;
+    lastTime.second = 0;
+    if (++lastTime.minute < 60) return;
+    lastTime.minute = 0;
+    if (++lastTime.hour < 24) return;
+    lastTime.hour = 0;
+    resyncDue = true;  // Let the RTC handle the calendar
+  }
+
+  void resync() {
+    #ifndef PIN_RTC_SQW
+    uint8_t expected = lastTime.second;
+    #endif
+    if (!readAll()) {
+      lastSync = millis();
+      return;
+    }
+    #ifndef PIN_RTC_SQW
+    // millis() drifted off the RTC's second boundary - find it again
+    if (lastTime.second != expected) aligning = true;
+    #endif
+  }
+
+  void setTime(uint16_t year, uint8_t month, uint8_t day,
+               uint8_t hour, uint8_t minute, uint8_t second) {
+    if (!rtcAvailable) return;
+
+    // Day of week (register 3) is not used
+    uint8_t buf[] = {
+      DS3231_REG_TIME, bin2bcd(second), bin2bcd(minute), bin2bcd(hour),
+      1, bin2bcd(day), bin2bcd(month), bin2bcd(year - 2000)
+    };
+    writeRegs(buf, sizeof(buf));
+
+    // Time is valid again - clear the oscillator-stopped flag
+    uint8_t status;
+    if (readRegs(DS3231_REG_STATUS, &status, 1)) {
+      uint8_t clear[] = {DS3231_REG_STATUS, (uint8_t)(status & ~DS3231_STATUS_OSF)};
+      writeRegs(clear, sizeof(clear));
+    }
+
+    resyncDue = true;
+  }
+
+  // Set the clock to the time this firmware was compiled
+  void setCompileTime() {
+    static const char months[] PROGMEM = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    static const char dateP[] PROGMEM = __DATE__;  // "Dec 11 2025"
+    static const char timeP[] PROGMEM = __TIME__;  // "18:30:00"
+    char date[12], time[9];
+    strcpy_P(date, dateP);
+    strcpy_P(time, timeP);
+
+    uint8_t month = 1;
+    while (month < 12 && strncmp_P(date, months + (month - 1) * 3, 3) != 0) month++;
 
+    setTime(atoi(date + 7), month, atoi(date + 4),
+            atoi(time), atoi(time + 3), atoi(time + 6));
+  }
+
+  #ifdef PIN_RTC_SQW
+  // 1Hz square wave on (second ticks) or off (INTCN, output idles high-Z)
+  void setSquareWave(bool on) {
+    uint8_t control;
+    if (!readRegs(DS3231_REG_CONTROL, &control, 1)) return;
+    control &= ~DS3231_CTRL_SQW;
+    if (!on) control |= DS3231_CTRL_INTCN;
+    uint8_t buf[] = {DS3231_REG_CONTROL, control};
+    writeRegs(buf, sizeof(buf));
+  }
+  #endif
+
+  // Needs I2CBus::begin() first
   void begin() {
-    if (rtc.begin()) {
+    uint8_t status;
+    if (readRegs(DS3231_REG_STATUS, &status, 1)) {
       rtcAvailable = true;
-      
+
       // Only update time if RTC lost power (battery dead)
-      if (rtc.lostPower()) {
-        rtc.adjust(DateTime(F(__DATE__), F(__TIME__)));
+      if (status & DS3231_STATUS_OSF) {
+        setCompileTime();
       }
-      
-      lastTime = rtc.now();
+
+      readAll();
+
+      #ifdef PIN_RTC_SQW
+      setSquareWave(true);
+      pinMode(PIN_RTC_SQW, INPUT_PULLUP);  // Open drain output
+      attachInterrupt(digitalPinToInterrupt(PIN_RTC_SQW), onSquareWave, FALLING);
+      #else
+      aligning = true;
+      #endif
     }
+    txWindowStart = millis();
   }
 
-  DateTime getTime() {
-    if (rtcAvailable) {
-      lastTime = rtc.now();
+  // Scheduler task - advances the RAM clock, resyncs now and then
+  void update() {
+    if (!rtcAvailable) return;
+    unsigned long now = millis();
+
+    #ifdef PIN_RTC_SQW
+    while (sqwTicks) {
+      noInterrupts();
+      sqwTicks--;
+      interrupts();
+      advanceSecond();
     }
+    #else
+    if (aligning) {
+      if (now - lastAlignPoll >= RTC_ALIGN_POLL_MS) {
+        lastAlignPoll = now;
+        uint8_t sec;
+        if (readRegs(DS3231_REG_TIME, &sec, 1) &&
+            bcd2bin(sec & 0x7F) != lastTime.second && readAll()) {
+          secondStart = now;
+          aligning = false;
+        }
+      }
+    } else {
+      while (now - secondStart >= 1000) {
+        secondStart += 1000;
+        advanceSecond();
+      }
+    }
+    #endif
+
+    if (resyncDue || now - lastSync >= RTC_RESYNC_MS) {
+      resync();
+    }
+
+    if (now - txWindowStart >= 60000) {
+      txPerMinute = txCount;
+      txCount = 0;
+      txWindowStart = now;
+      #ifdef DEBUG_MODE
+      Serial.print(F("RTC I2C transactions/min: "));
+      Serial.println(txPerMinute);
+      #endif
+    }
+  }
+
+  // Before the MCU sleeps: silence the square wave so it cannot wake it.
+  // Without PIN_RTC_SQW it is never enabled (INTCN is set at power-up).
+  void standby() {
+    if (!rtcAvailable) return;
+    #ifdef PIN_RTC_SQW
+    detachInterrupt(digitalPinToInterrupt(PIN_RTC_SQW));
+    setSquareWave(false);
+    I2CBus::flush();
+    #endif
+  }
+
+  // After sleep millis() has stood still (or ticks were missed) - resync
+  void resume() {
+    if (!rtcAvailable) return;
+    #ifdef PIN_RTC_SQW
+    sqwTicks = 0;
+    setSquareWave(true);
+    attachInterrupt(digitalPinToInterrupt(PIN_RTC_SQW), onSquareWave, FALLING);
+    readAll();
+    #else
+    // The seconds register can match the RAM clock after a whole minute
+    // asleep while millis() is still off the second boundary - always
+    // look for the next tick
+    if (readAll()) aligning = true;
+    #endif
+  }
+
+  Time getTime() {
     return lastTime;
   }
 
-  float getTemperature() {
-    if (rtcAvailable) {
-      return rtc.getTemperature();
-    }
-    return 0.0;
+  // Seconds since 2000-01-01 00:00:00 (valid through 2099)
+  uint32_t getSecondsSince2000() {
+    static const uint16_t daysBeforeMonth[] PROGMEM = {
+      0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
+    };
+    uint8_t y = lastTime.year - 2000;
+    uint16_t days = y * 365 + (y + 3) / 4 +
+                    pgm_read_word(&daysBeforeMonth[lastTime.month - 1]) + lastTime.day - 1;
+    if (lastTime.month > 2 && y % 4 == 0) days++;
+    return ((uint32_t)days * 24 + lastTime.hour) * 3600UL + lastTime.minute * 60 + lastTime.second;
   }
 
-  void getTimeString(char* buffer, size_t bufferSize) {
-    DateTime now = getTime();
-    snprintf(buffer, bufferSize, "%02d:%02d:%02d", 
-             now.hour(), now.minute(), now.second());
+  uint16_t getTransactionsPerMinute() {
+    return txPerMinute;
   }
 
-  void getDateString(char* buffer, size_t bufferSize) {
-    DateTime now = getTime();
-    snprintf(buffer, bufferSize, "%04d-%02d-%02d", 
-             now.year(), now.month(), now.day());
+  int16_t getTemperatureQuarters() {
+    return tempQuarters;
   }
 
-  void setTime(uint16_t year, uint8_t month, uint8_t day, 
-               uint8_t hour, uint8_t minute, uint8_t second) {
-    if (rtcAvailable) {
-      rtc.adjust(DateTime(year, month, day, hour, minute, second));
-    }
+  // "HH:MM:SS" - needs 9 bytes
+  void getTimeString(char* buffer, size_t bufferSize) {
+    if (bufferSize < 9) return;
+    Time now = getTime();
+    char* p = Format::putUInt(buffer, now.hour, 2);
+    p = Format::putUInt(Format::putChar(p, ':'), now.minute, 2);
+    Format::putUInt(Format::putChar(p, ':'), now.second, 2);
+  }
+
+  // "YYYY-MM-DD" - needs 11 bytes
+  void getDateString(char* buffer, size_t bufferSize) {
+    if (bufferSize < 11) return;
+    Time now = getTime();
+    char* p = Format::putUInt(buffer, now.year, 4);
+    p = Format::putUInt(Format::putChar(p, '-'), now.month, 2);
+    Format::putUInt(Format::putChar(p, '-'), now.day, 2);
   }
 
   bool isAvailable() {
@@ -69,4 +311,3 @@ namespace RTCModule {
 }
 
 #endif // FEATURE_RTC
-
@@ -0,0 +1,159 @@
+/*
+ * Scheduler module - Cooperative, non-blocking task scheduler
+ *
+ * loop() calls Scheduler::run() as fast as it can. Every SCHED_TICK_MS
+ * the scheduler runs each task whose period has elapsed. Tasks must never
+ * block: long-running work is split with a Timer or a Continuation and
+ * resumed on a later tick, so no module can stall input or rendering.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+#include "profiler.h"
+
+// ===== Timer =====
+// One-shot software timer based on millis()
+struct Timer {
+  unsigned long start;
+  unsigned long duration;
+
+  void set(unsigned long ms) {
+    start = millis();
+    duration = ms;
+  }
+
+  bool expired() const {
+    return millis() - start >= duration;
+  }
+};
+
+// ===== Continuations =====
+// Stackless coroutines (protothread style). A step function returns false
+// while it still has work to do and true once it has finished:
+//
+//   bool step() {
+//     CO_BEGIN(co);
+//     Keyboard.press('a');
+//     CO_DELAY(co, 100);   // yields back to the scheduler for 100ms
+//     Keyboard.releaseAll();
+//     CO_END(co);
+//   }
+//
+// Locals do not survive a yield - keep state in namespace variables.
+// Use at most one CO_* statement per source line (labels use __LINE__).
+struct Continuation {
+  uint16_t line;
+  Timer timer;
+};
+
+#define CO_BEGIN(c)  switch ((c).line) { case 0:
+#define CO_END(c)    } (c).line = 0; return true
+#define CO_RESET(c)  ((c).line = 0)
+#define CO_YIELD(c)  do { (c).line = __LINE__; return false; case __LINE__:; } while (0)
+#define CO_WAIT_UNTIL(c, cond) \
+  do { (c).line = __LINE__; case __LINE__: if (!(cond)) return false; } while (0)
+#define CO_DELAY(c, ms) \
+  do { (c).timer.set(ms); CO_WAIT_UNTIL(c, (c).timer.expired()); } while (0)
+
+namespace Scheduler {
+  typedef void (*TaskFn)();
+
+  struct Task {
+    TaskFn fn;
+    uint16_t periodMs;
+    uint16_t deadlineUs;     // Longest a single run may take
+    unsigned long lastRun;
+    uint16_t maxUs;          // Worst observed run time
+    uint16_t overruns;       // Runs that missed deadlineUs
+    bool enabled;
+    #ifdef FEATURE_PROFILER
+    uint8_t profId;          // Profiler section, PROF_NONE if unnamed
+    #endif
+  };
+
+  Task tasks[SCHED_MAX_TASKS];
+  uint8_t taskCount = 0;
+  unsigned long lastTick = 0;
+  unsigned long maxPassUs = 0;  // Worst-case loop latency seen so far
+  unsigned long windowMaxUs = 0; // Worst case since the last takeWindowMaxUs()
+
+  // Register a task. Returns its id, or -1 if the table is full.
+  // name (PROF_NAME("...")) labels the task in the profiler.
+  int8_t add(TaskFn fn, uint16_t periodMs, uint16_t deadlineUs, const char* name = 0) {
+    if (taskCount >= SCHED_MAX_TASKS) return -1;
+    Task& t = tasks[taskCount];
+    t.fn = fn;
+    t.periodMs = periodMs;
+    t.deadlineUs = deadlineUs;
+    t.lastRun = millis();
+    t.maxUs = 0;
+    t.overruns = 0;
+    t.enabled = true;
+    #ifdef FEATURE_PROFILER
+    t.profId = Profiler::add(name);
+    #else
+    (void)name;
+    #endif
+    return taskCount++;
+  }
+
+  void setEnabled(int8_t id, bool enabled) {
+    if (id < 0 || id >= taskCount) return;
+    tasks[id].enabled = enabled;
+  }
+
+  // Make every task due on the next tick (e.g. after sleep)
+  void resume() {
+    unsigned long now = millis();
+    lastTick = now - SCHED_TICK_MS;
+    for (uint8_t i = 0; i < taskCount; i++) tasks[i].lastRun = now - tasks[i].periodMs;
+  }
+
+  unsigned long getMaxLatencyUs() {
+    return maxPassUs;
+  }
+
+  // Worst-case pass since the previous call (telemetry)
+  unsigned long takeWindowMaxUs() {
+    unsigned long w = windowMaxUs;
+    windowMaxUs = 0;
+    return w;
+  }
+
+  void run() {
+    unsigned long now = millis();
+    if (now - lastTick < SCHED_TICK_MS) return;
+    lastTick = now;
+
+    unsigned long passStart = micros();
+
+    for (uint8_t i = 0; i < taskCount; i++) {
+      Task& t = tasks[i];
+      if (!t.enabled || now - t.lastRun < t.periodMs) continue;
+      t.lastRun = now;
+
+      unsigned long start = micros();
+      t.fn();
+      unsigned long took = micros() - start;
+
+      if (took > t.maxUs) t.maxUs = min(took, 0xFFFFUL);
+      if (took > t.deadlineUs) t.overruns++;
+      #ifdef FEATURE_PROFILER
+      Profiler::record(t.profId, took);
+      #endif
+    }
+
+    unsigned long pass = micros() - passStart;
+    if (pass > windowMaxUs) windowMaxUs = pass;
+    if (pass > maxPassUs) {
+      maxPassUs = pass;
+      #ifdef DEBUG_MODE
+      if (pass > SCHED_LATENCY_BOUND_US) {
+        Serial.print(F("Loop latency over bound (us): "));
+        Serial.println(pass);
+      }
+      #endif
+    }
+  }
+}
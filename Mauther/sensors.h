@@ -1,6 +1,17 @@
 /*
  * Sensors module - Handles VL53L0X distance sensor
  * Only include if FEATURE_DISTANCE_SENSOR is defined
+ *
+ * New samples are picked up from the sensor's GPIO1 data-ready interrupt
+ * when PIN_VL53_GPIO1 is wired, otherwise by polling the interrupt status
+ * register every SENSOR_POLL_MS. Samples go into a small timestamped ring
+ * buffer; getDistance() returns the median or EWMA filtered value and
+ * never touches the bus. onSample (the alarm engine) runs right after the
+ * filtered value changes, with readyUs holding when the sample was seen.
+ *
+ * The ranging profile (timing budget, signal rate limit, VCSEL periods)
+ * and the filter come from Settings::values; changes made there are
+ * applied on the next update().
  */
 
 #pragma once
@@ -8,61 +19,336 @@
 #ifdef FEATURE_DISTANCE_SENSOR
 
 #include <Arduino.h>
-#include <Wire.h>
 #include <VL53L0X.h>
 #include "config.h"
+#include "ui_text.h"
+#include "i2c_bus.h"
+#include "settings.h"
+
+static_assert(SENSOR_MEDIAN_WINDOW <= SENSOR_RING_SIZE, "Median window larger than the ring");
 
 namespace Sensors {
+  enum Filter {
+    FILTER_NONE,
+    FILTER_MEDIAN,
+    FILTER_EWMA
+  };
+
+  enum Profile {
+    PROFILE_DEFAULT,       // 33ms, library defaults
+    PROFILE_HIGH_SPEED,    // 20ms budget - fast tracking
+    PROFILE_HIGH_ACCURACY, // 200ms budget - low noise
+    PROFILE_LONG_RANGE,    // Lower signal limit, longer VCSEL pulses
+    PROFILE_COUNT
+  };
+
+  UI_PSTR(profileDefault, "Default");
+  UI_PSTR(profileFast, "Fast");
+  UI_PSTR(profileAccurate, "Accurate");
+  UI_PSTR(profileLong, "Long");
+  const char* const profileNames[PROFILE_COUNT] PROGMEM = {
+    profileDefault, profileFast, profileAccurate, profileLong
+  };
+
+  struct Sample {
+    uint16_t distance;   // mm
+    uint16_t time;       // Low 16 bits of millis()
+  };
+
   VL53L0X distanceSensor;
-  uint16_t lastDistance = 0;
   bool distanceSensorAvailable = false;
-  unsigned long lastUpdate = 0;
 
+  Sample ring[SENSOR_RING_SIZE];
+  uint8_t ringHead = 0;          // Next slot to write
+  uint8_t ringCount = 0;
+
+  Filter filter = FILTER_NONE;
+  Profile profile = PROFILE_DEFAULT;
+  uint16_t lastDistance = DISTANCE_MAX_RANGE + 1;     // Latest raw sample
+  uint16_t filteredDistance = DISTANCE_MAX_RANGE + 1; // Out of range until one arrives
+  int32_t ewmaQ4 = 0;            // EWMA state, mm * 16
+
+  unsigned long lastSampleAt = 0;
+  uint16_t samplePeriodMs = 33;  // Expected time between samples
+  unsigned long sampleCount = 0;
+  unsigned long droppedSamples = 0;
+
+  // micros() when the newest sample was found ready: in the data-ready
+  // interrupt, or when a poll saw it (up to SENSOR_POLL_MS after the fact)
+  volatile unsigned long readyUs = 0;
+  void (*onSample)() = 0;        // After each new filteredDistance
+
+  #ifdef PIN_VL53_GPIO1
+  volatile bool dataReady = false;
+
+  void onDataReady() {
+    readyUs = micros();
+    dataReady = true;
+  }
+  #else
+  unsigned long lastPoll = 0;
+  #endif
+
+  // Timing budget, signal rate limit and VCSEL periods for a profile.
+  // Sensor must not be ranging.
+  void applyProfile(Profile p) {
+    bool longRange = (p == PROFILE_LONG_RANGE);
+    distanceSensor.setSignalRateLimit(longRange ? 0.1 : 0.25);
+    distanceSensor.setVcselPulsePeriod(VL53L0X::VcselPeriodPreRange, longRange ? 18 : 14);
+    distanceSensor.setVcselPulsePeriod(VL53L0X::VcselPeriodFinalRange, longRange ? 14 : 10);
+
+    uint32_t budget = 33000;
+    if (p == PROFILE_HIGH_SPEED) budget = 20000;
+    else if (p == PROFILE_HIGH_ACCURACY) budget = 200000;
+    distanceSensor.setMeasurementTimingBudget(budget);
+    samplePeriodMs = distanceSensor.getMeasurementTimingBudget() / 1000;
+  }
+
+  // Needs I2CBus::begin() and Settings::begin() first
   void begin() {
-    Wire.begin();
-    distanceSensor.setTimeout(500);
+    profile = (Profile)Settings::values.sensorProfile;
+    filter = (Filter)Settings::values.sensorFilter;
+
+    // The library talks to Wire directly - let queued transfers finish first
+    I2CBus::flush();
+    distanceSensor.setTimeout(SENSOR_TIMEOUT_MS);
     if (distanceSensor.init()) {
       distanceSensorAvailable = true;
+      applyProfile(profile);
       distanceSensor.startContinuous();
+      lastSampleAt = millis();
+
+      #ifdef PIN_VL53_GPIO1
+      // init() set GPIO1 to "new sample ready", active low
+      pinMode(PIN_VL53_GPIO1, INPUT_PULLUP);
+      attachInterrupt(digitalPinToInterrupt(PIN_VL53_GPIO1), onDataReady, FALLING);
+      if (digitalRead(PIN_VL53_GPIO1) == LOW) dataReady = true;
+      #endif
     }
   }
 
+  // Index of the i-th newest sample (0 = newest)
+  uint8_t ringIndex(uint8_t i) {
+    return (ringHead + SENSOR_RING_SIZE - 1 - i) % SENSOR_RING_SIZE;
+  }
+
+  uint16_t median() {
+    uint8_t n = min(ringCount, (uint8_t)SENSOR_MEDIAN_WINDOW);
+    uint16_t sorted[SENSOR_MEDIAN_WINDOW];
+
+    // Insertion sort of the newest n samples
+    for (uint8_t i = 0; i < n; i++) {
+      uint16_t v = ring[ringIndex(i)].distance;
+      uint8_t j = i;
+      while (j > 0 && sorted[j - 1] > v) {
+        sorted[j] = sorted[j - 1];
+        j--;
+      }
+      sorted[j] = v;
+    }
+    return sorted[n / 2];
+  }
+
+  uint16_t ewma(uint16_t sample) {
+    // Snap on entering or leaving the valid range instead of smearing
+    if (sample > DISTANCE_MAX_RANGE || filteredDistance > DISTANCE_MAX_RANGE) {
+      ewmaQ4 = (int32_t)sample << 4;
+    } else {
+      ewmaQ4 += (((int32_t)sample << 4) - ewmaQ4) >> SENSOR_EWMA_SHIFT;
+    }
+    return (ewmaQ4 + 8) >> 4;
+  }
+
+  void addSample(uint16_t distance) {
+    unsigned long now = millis();
+
+    // Samples the sensor produced that we never read
+    unsigned long gap = now - lastSampleAt;
+    if (sampleCount > 0 && samplePeriodMs > 0 && gap > samplePeriodMs * 3UL / 2) {
+      droppedSamples += (gap + samplePeriodMs / 2) / samplePeriodMs - 1;
+    }
+    lastSampleAt = now;
+    sampleCount++;
+
+    ring[ringHead].distance = distance;
+    ring[ringHead].time = now;
+    ringHead = (ringHead + 1) % SENSOR_RING_SIZE;
+    if (ringCount < SENSOR_RING_SIZE) ringCount++;
+
+    lastDistance = distance;
+    switch (filter) {
+      case FILTER_MEDIAN: filteredDistance = median(); break;
+      case FILTER_EWMA:   filteredDistance = ewma(distance); break;
+      default:            filteredDistance = distance; break;
+    }
+    if (onSample) onSample();
+  }
+
+  // Restart ranging with another profile; old samples are discarded
+  void applyNewProfile(Profile p) {
+    profile = p;
+    if (!distanceSensorAvailable) return;
+
+    // The library talks to Wire directly - let queued transfers finish first
+    I2CBus::flush();
+    distanceSensor.stopContinuous();
+    applyProfile(p);
+    distanceSensor.startContinuous();
+
+    ringCount = 0;
+    sampleCount = 0;
+    lastSampleAt = millis();
+  }
+
+  // Stop ranging before the MCU sleeps (sensor idles in SW standby, ~5uA)
+  void standby() {
+    if (!distanceSensorAvailable) return;
+    I2CBus::flush();
+    distanceSensor.stopContinuous();
+  }
+
+  // Resume ranging after sleep; samples from before are stale
+  void resume() {
+    if (!distanceSensorAvailable) return;
+    I2CBus::flush();
+    distanceSensor.startContinuous();
+
+    ringCount = 0;
+    lastSampleAt = millis();
+    #ifdef PIN_VL53_GPIO1
+    dataReady = false;
+    #endif
+  }
+
+  // Stored through Settings, applied right away
+  void setProfile(Profile p) {
+    if (p >= PROFILE_COUNT) return;
+    Settings::set(Settings::SET_SENSOR_PROFILE, p);
+    applyNewProfile(p);
+  }
+
+  Profile getProfile() {
+    return profile;
+  }
+
+  // PROGMEM string
+  const char* getProfileName() {
+    return (const char*)pgm_read_ptr(&profileNames[profile]);
+  }
+
+  void applyNewFilter(Filter f) {
+    filter = f;
+    ewmaQ4 = (int32_t)lastDistance << 4;
+  }
+
+  void setFilter(Filter f) {
+    Settings::set(Settings::SET_SENSOR_FILTER, f);
+    applyNewFilter(f);
+  }
+
+  Filter getFilter() {
+    return filter;
+  }
+
   uint16_t getDistance() {
+    return filteredDistance;
+  }
+
+  uint16_t getRawDistance() {
     return lastDistance;
   }
 
-  bool isDistanceSensorAvailable() {
-    return distanceSensorAvailable;
+  // Effective sample rate over the ring buffer, in tenths of Hz
+  uint16_t getSampleRateX10() {
+    if (ringCount < 2) return 0;
+    uint16_t span = ring[ringIndex(0)].time - ring[ringIndex(ringCount - 1)].time;
+    if (span == 0) return 0;
+    return (uint32_t)(ringCount - 1) * 10000 / span;
   }
 
-  bool isAlarmTriggered() {
-    // Use hysteresis to prevent rapid on/off toggling
-    // Trigger at DISTANCE_ALARM_THRESHOLD, clear at DISTANCE_ALARM_CLEAR
-    static bool alarmState = false;
-    
-    if (!alarmState && lastDistance > 0 && lastDistance < DISTANCE_ALARM_THRESHOLD) {
-      // Enter alarm zone
-      alarmState = true;
-    } else if (alarmState && lastDistance > DISTANCE_ALARM_CLEAR) {
-      // Exit alarm zone (with hysteresis)
-      alarmState = false;
+  // Standard deviation of the raw samples in the ring, in tenths of mm.
+  // Out-of-range samples are ignored.
+  uint16_t getNoiseX10() {
+    uint8_t n = 0;
+    uint32_t sum = 0, sumSq = 0;
+    for (uint8_t i = 0; i < ringCount; i++) {
+      uint16_t d = ring[ringIndex(i)].distance;
+      if (d > DISTANCE_MAX_RANGE) continue;
+      n++;
+      sum += d;
+      sumSq += (uint32_t)d * d;
     }
-    
-    return alarmState;
+    if (n < 2) return 0;
+
+    // Variance in mm^2 * 100, then integer square root
+    uint32_t var = (n * sumSq - sum * sum) / n * 100 / n;
+    uint32_t root = 0, bit = 1UL << 30;
+    while (bit > var) bit >>= 2;
+    while (bit) {
+      if (var >= root + bit) {
+        var -= root + bit;
+        root = (root >> 1) + bit;
+      } else {
+        root >>= 1;
+      }
+      bit >>= 2;
+    }
+    return root;
+  }
+
+  // Samples overwritten before they were read, since boot
+  unsigned long getDroppedSamples() {
+    return droppedSamples;
+  }
+
+  bool isDistanceSensorAvailable() {
+    return distanceSensorAvailable;
   }
 
+  // Non-blocking: only touches the bus once the sensor has a new sample
   void update() {
+    // Settings changed from the editor or the control protocol
+    if (Settings::values.sensorFilter != filter) applyNewFilter((Filter)Settings::values.sensorFilter);
+    if (Settings::values.sensorProfile != profile) applyNewProfile((Profile)Settings::values.sensorProfile);
+
     if (!distanceSensorAvailable) return;
-    
-    if (millis() - lastUpdate > 100) {
-      lastDistance = distanceSensor.readRangeContinuousMillimeters();
-      if (distanceSensor.timeoutOccurred()) {
-        lastDistance = DISTANCE_MAX_RANGE + 1;
+
+    uint8_t buf[2];
+
+    #ifdef PIN_VL53_GPIO1
+    bool ready = dataReady;
+    #else
+    bool ready = false;
+    if (millis() - lastPoll >= SENSOR_POLL_MS) {
+      lastPoll = millis();
+      ready = I2CBus::read(VL53L0X_ADDR, VL53L0X::RESULT_INTERRUPT_STATUS, buf, 1) &&
+              (buf[0] & 0x07);
+      if (ready) readyUs = micros();
+    }
+    #endif
+
+    if (!ready) {
+      // Sensor went quiet - report out of range like a read timeout
+      if (millis() - lastSampleAt > SENSOR_TIMEOUT_MS) {
+        lastDistance = filteredDistance = DISTANCE_MAX_RANGE + 1;
+        lastSampleAt = millis();
+        readyUs = micros();
+        if (onSample) onSample();
       }
-      lastUpdate = millis();
+      return;
     }
+
+    #ifdef PIN_VL53_GPIO1
+    dataReady = false;
+    #endif
+
+    if (I2CBus::read(VL53L0X_ADDR, VL53L0X::RESULT_RANGE_STATUS + 10, buf, 2)) {
+      addSample(((uint16_t)buf[0] << 8) | buf[1]);
+    }
+
+    static const uint8_t clearInterrupt[] = {VL53L0X::SYSTEM_INTERRUPT_CLEAR, 0x01};
+    I2CBus::write(VL53L0X_ADDR, clearInterrupt, sizeof(clearInterrupt));
   }
 }
 
 #endif // FEATURE_DISTANCE_SENSOR
-
@@ -0,0 +1,251 @@
+/*
+ * Settings module - User settings, kept in RAM and stored in EEPROM
+ *
+ * Settings::values is the one copy every module reads (Sensors, Actuators,
+ * Display, BadUSB pick up changes on their next update). Changes come from
+ * the menu editor or the control protocol through set(), by id; ids are
+ * stable, the protocol uses them.
+ *
+ * Storage is wear leveled over SETTINGS_SLOTS slots at the start of
+ * EEPROM. Each save goes to the slot after the newest one as a record with
+ * a version, a sequence number and a CRC; at boot the valid record with the
+ * highest sequence wins, so a save cut short by a reset leaves the previous
+ * record in charge. Saves are deferred until the values have been left
+ * alone for SETTINGS_SAVE_DELAY_MS (scrolling a value costs no write
+ * cycles), and written one byte per update() so the loop never stalls on
+ * the ~3.4ms EEPROM write time.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <util/crc16.h>
+#include "config.h"
+#include "ui_text.h"
+
+#define SETTINGS_VERSION 1
+
+namespace Settings {
+  enum Id {
+    SET_CONTRAST,
+    SET_ALARM_MM,
+    SET_SENSOR_PROFILE,
+    SET_SENSOR_FILTER,
+    SET_ALARM_CLEAR_MM,
+    SET_LED_BRIGHTNESS,
+    SET_BADUSB_OS,
+    SET_COUNT
+  };
+
+  struct Values {
+    uint16_t alarmMm;        // Distance alarm triggers below this
+    uint16_t alarmClearMm;   // ... and clears above this (>= alarmMm)
+    uint8_t contrast;
+    uint8_t ledBrightness;
+    uint8_t sensorProfile;   // Sensors::Profile
+    uint8_t sensorFilter;    // Sensors::Filter
+    uint8_t badusbOs;        // BADUSB_OS_MAC or BADUSB_OS_WINDOWS
+  };
+
+  struct Record {
+    uint8_t version;
+    uint8_t seq;
+    Values values;
+    uint16_t crc;            // Over everything before it
+  };
+  static_assert(sizeof(Record) <= SETTINGS_SLOT_SIZE, "Settings record larger than a slot");
+  static_assert(EEPROM_ADDR_SETTINGS + SETTINGS_SLOTS * SETTINGS_SLOT_SIZE <= EEPROM_ADDR_LOG,
+                "Settings slots overlap the log");
+
+  struct Info {
+    const char* name;        // PROGMEM
+    const char* choices;     // PROGMEM "A|B|C" for enumerations, 0 for numbers
+    int16_t min;
+    int16_t max;
+    uint8_t step;            // Menu editor increment
+    uint8_t offset;          // In Values
+    uint8_t wide;            // uint16_t field
+  };
+
+  UI_PSTR(nameContrast, "contrast");
+  UI_PSTR(nameAlarm, "alarm_mm");
+  UI_PSTR(nameProfile, "profile");
+  UI_PSTR(nameFilter, "filter");
+  UI_PSTR(nameAlarmClear, "clear_mm");
+  UI_PSTR(nameBrightness, "led");
+  UI_PSTR(nameBadUSBOs, "badusb_os");
+  UI_PSTR(choicesProfile, "Default|Fast|Accurate|Long");
+  UI_PSTR(choicesFilter, "None|Median|EWMA");
+  UI_PSTR(choicesOs, "Mac|Windows");
+
+  #define SETTING(name, choices, lo, hi, step, field) \
+    {name, choices, lo, hi, step, offsetof(Values, field), sizeof(((Values*)0)->field) == 2}
+
+  // Indexed by Id
+  const Info infos[] PROGMEM = {
+    SETTING(nameContrast, 0, 0, 255, 15, contrast),
+    SETTING(nameAlarm, 0, 50, DISTANCE_MAX_RANGE, 50, alarmMm),
+    SETTING(nameProfile, choicesProfile, 0, 3, 1, sensorProfile),
+    SETTING(nameFilter, choicesFilter, 0, 2, 1, sensorFilter),
+    SETTING(nameAlarmClear, 0, 50, DISTANCE_MAX_RANGE, 50, alarmClearMm),
+    SETTING(nameBrightness, 0, 5, 255, 15, ledBrightness),
+    SETTING(nameBadUSBOs, choicesOs, 0, 1, 1, badusbOs)
+  };
+  static_assert(sizeof(infos) / sizeof(infos[0]) == SET_COUNT, "infos out of sync with Id");
+
+  const Values defaults PROGMEM = {
+    DISTANCE_ALARM_THRESHOLD,
+    DISTANCE_ALARM_CLEAR,
+    DISPLAY_DEFAULT_CONTRAST,
+    LED_DEFAULT_BRIGHTNESS,
+    0,
+    SENSOR_DEFAULT_FILTER,
+    #ifdef BADUSB_TARGET_MAC
+    BADUSB_OS_MAC
+    #else
+    BADUSB_OS_WINDOWS
+    #endif
+  };
+
+  Values values;
+
+  // Save state
+  Record pending;            // Snapshot being written
+  uint8_t seq = 0;           // Of the newest record in EEPROM
+  uint8_t slot = 0;          // Slot holding it
+  uint8_t writePos = 0;      // Next byte of pending, sizeof(Record) when idle
+  bool dirty = false;
+  unsigned long changedAt = 0;
+  uint16_t saveCount = 0;    // Records written since boot
+
+  uint16_t crc(const Record& r) {
+    const uint8_t* p = (const uint8_t*)&r;
+    uint16_t c = 0xFFFF;
+    for (uint8_t i = 0; i < offsetof(Record, crc); i++) c = _crc_ccitt_update(c, p[i]);
+    return c;
+  }
+
+  int slotAddr(uint8_t s) {
+    return EEPROM_ADDR_SETTINGS + s * SETTINGS_SLOT_SIZE;
+  }
+
+  const char* getName(uint8_t id) {
+    return (const char*)pgm_read_ptr(&infos[id].name);
+  }
+
+  const char* getChoices(uint8_t id) {
+    return (const char*)pgm_read_ptr(&infos[id].choices);
+  }
+
+  int16_t getMin(uint8_t id) {
+    return pgm_read_word(&infos[id].min);
+  }
+
+  int16_t getMax(uint8_t id) {
+    return pgm_read_word(&infos[id].max);
+  }
+
+  uint8_t getStep(uint8_t id) {
+    return pgm_read_byte(&infos[id].step);
+  }
+
+  bool get(uint8_t id, int16_t& value) {
+    if (id >= SET_COUNT) return false;
+    uint8_t* field = (uint8_t*)&values + pgm_read_byte(&infos[id].offset);
+    value = pgm_read_byte(&infos[id].wide) ? *(uint16_t*)field : *field;
+    return true;
+  }
+
+  // Clamps to the range, then keeps alarmClearMm >= alarmMm. The save
+  // waits until nothing has changed for SETTINGS_SAVE_DELAY_MS.
+  bool set(uint8_t id, int16_t value) {
+    if (id >= SET_COUNT) return false;
+    value = constrain(value, getMin(id), getMax(id));
+    uint8_t* field = (uint8_t*)&values + pgm_read_byte(&infos[id].offset);
+    if (pgm_read_byte(&infos[id].wide)) *(uint16_t*)field = value;
+    else *field = value;
+
+    if (values.alarmClearMm < values.alarmMm) {
+      if (id == SET_ALARM_CLEAR_MM) values.alarmMm = values.alarmClearMm;
+      else values.alarmClearMm = values.alarmMm;
+    }
+
+    dirty = true;
+    changedAt = millis();
+    return true;
+  }
+
+  // Copy choice index of id into buf ("Median"), or "" for numbers
+  void getChoiceName(uint8_t id, int16_t value, char* buf, uint8_t size) {
+    const char* p = getChoices(id);
+    buf[0] = '\0';
+    if (!p) return;
+    while (value-- > 0) {
+      p = strchr_P(p, '|');
+      if (!p) return;
+      p++;
+    }
+    uint8_t n = 0;
+    char c;
+    while (n < size - 1 && (c = pgm_read_byte(p++)) && c != '|') buf[n++] = c;
+    buf[n] = '\0';
+  }
+
+  // Save on the next update() instead of waiting for the values to settle
+  void saveNow() {
+    if (dirty) changedAt = millis() - SETTINGS_SAVE_DELAY_MS;
+  }
+
+  bool isSaving() {
+    return dirty || writePos < sizeof(Record);
+  }
+
+  // Newest valid record into values, defaults if there is none
+  void begin() {
+    bool found = false;
+    for (uint8_t s = 0; s < SETTINGS_SLOTS; s++) {
+      Record r;
+      EEPROM.get(slotAddr(s), r);
+      if (r.version != SETTINGS_VERSION || r.crc != crc(r)) continue;
+      if (!found || (int8_t)(r.seq - seq) > 0) {
+        found = true;
+        seq = r.seq;
+        slot = s;
+        values = r.values;
+      }
+    }
+
+    if (!found) {
+      memcpy_P(&values, &defaults, sizeof(values));
+      slot = SETTINGS_SLOTS - 1;   // First save goes to slot 0
+    }
+    writePos = sizeof(Record);
+
+    #ifdef DEBUG_MODE
+    Serial.print(found ? F("Settings: slot ") : F("Settings: defaults"));
+    if (found) Serial.print(slot);
+    Serial.println();
+    #endif
+  }
+
+  // Scheduler task - deferred, incremental save
+  void update() {
+    if (writePos < sizeof(Record)) {
+      // One byte per call; EEPROM.update() skips bytes that already match
+      EEPROM.update(slotAddr(slot) + writePos, ((const uint8_t*)&pending)[writePos]);
+      writePos++;
+      if (writePos == sizeof(Record)) saveCount++;
+      return;
+    }
+
+    if (!dirty || millis() - changedAt < SETTINGS_SAVE_DELAY_MS) return;
+    dirty = false;
+
+    pending.version = SETTINGS_VERSION;
+    pending.seq = ++seq;
+    pending.values = values;
+    pending.crc = crc(pending);
+    slot = (slot + 1) % SETTINGS_SLOTS;
+    writePos = 0;
+  }
+}
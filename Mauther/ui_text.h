@@ -0,0 +1,37 @@
+/*
+ * UI text - string literals the display draws, checked against the font
+ * subset at compile time
+ *
+ * font_subset.h lists the glyphs Tools/font_subset.py found in the sources
+ * and the subset font keeps only those; U8g2 silently skips any other.
+ * Write drawn literals as UI_TEXT("...") and PROGMEM ones with UI_PSTR():
+ * a character the subset lacks then stops the build here instead of going
+ * missing on the panel. Rerun font_subset.py after changing UI text.
+ */
+
+#pragma once
+#include "font_subset.h"
+
+namespace UIText {
+  constexpr bool inSubset(const char* glyphs, char c) {
+    return *glyphs && (*glyphs == c || inSubset(glyphs + 1, c));
+  }
+
+  constexpr bool covered(const char* s) {
+    return !*s || (inSubset(FONT_SUBSET_GLYPHS, *s) && covered(s + 1));
+  }
+
+  template <bool ok>
+  struct Check {
+    static_assert(ok, "UI text uses a glyph font_subset.h lacks - run Tools/font_subset.py");
+    static const bool pass = true;
+  };
+}
+
+// The literal itself, once every character is in the subset
+#define UI_TEXT(s) (UIText::Check<UIText::covered(s)>::pass ? (s) : (s))
+
+// const char name[] PROGMEM = s, checked the same way
+#define UI_PSTR(name, s) \
+  static_assert(UIText::covered(s), "UI text uses a glyph font_subset.h lacks - run Tools/font_subset.py"); \
+  const char name[] PROGMEM = s
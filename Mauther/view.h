@@ -0,0 +1,61 @@
+/*
+ * View module - Render-on-change for menu screens
+ *
+ * Each screen packs everything it shows into a small inputs struct and asks
+ * needsRedraw() before drawing. The struct is compared with memcmp, so it
+ * is zeroed (padding included) before its fields are set. A frame is
+ * drawn only when the screen or its inputs changed, and never more often
+ * than every DISPLAY_UPDATE_MS.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+namespace View {
+  uint8_t lastScreen = 0xFF;
+  uint8_t lastInputs[VIEW_MAX_INPUT_BYTES];
+  bool dirty = true;
+  unsigned long lastFrame = 0UL - DISPLAY_UPDATE_MS;  // The boot frame is never held back
+
+  unsigned long framesDrawn = 0;
+  unsigned long framesSkipped = 0;
+
+  bool needsRedraw(uint8_t screen, const void* inputs, uint8_t size) {
+    if (screen != lastScreen || memcmp(inputs, lastInputs, size) != 0) {
+      lastScreen = screen;
+      memcpy(lastInputs, inputs, size);
+      dirty = true;
+    }
+
+    // Unchanged, or changed too soon after the last frame (stays dirty)
+    if (!dirty || millis() - lastFrame < DISPLAY_UPDATE_MS) {
+      framesSkipped++;
+      return false;
+    }
+
+    dirty = false;
+    lastFrame = millis();
+    framesDrawn++;
+    return true;
+  }
+
+  template <typename T>
+  bool needsRedraw(uint8_t screen, const T& inputs) {
+    static_assert(sizeof(T) <= VIEW_MAX_INPUT_BYTES, "View inputs too large");
+    return needsRedraw(screen, &inputs, sizeof(T));
+  }
+
+  // Force the next frame (screen content was changed behind our back)
+  void invalidate() {
+    dirty = true;
+  }
+
+  unsigned long getFramesDrawn() {
+    return framesDrawn;
+  }
+
+  unsigned long getFramesSkipped() {
+    return framesSkipped;
+  }
+}
@@ -0,0 +1,370 @@
+/*
+ * Simulated I2C devices - SH1106 OLED, VL53L0X, DS3231
+ *
+ * Each model decodes what the firmware actually sends over the bus:
+ * the SH1106 its command/data control bytes into 132x8 pages of display
+ * RAM, the VL53L0X the result registers the sensor module polls, the
+ * DS3231 its timekeeping, control/status and temperature registers.
+ */
+
+#include <Arduino.h>
+#include <VL53L0X.h>
+#include "sim.h"
+
+namespace {
+  // ===== SH1106 =====
+  struct Sh1106 : Sim::Device {
+    uint8_t ram[8][132];
+    uint8_t page = 0;
+    uint8_t column = 0;
+    uint8_t contrast = 0x80;
+    bool on = false;
+    uint32_t dataBytes = 0;
+
+    Sh1106() {
+      memset(ram, 0, sizeof(ram));
+    }
+
+    // Commands that take one argument byte
+    static bool hasArg(uint8_t cmd) {
+      switch (cmd) {
+        case 0x81: case 0x8D: case 0xA8: case 0xAD:
+        case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+          return true;
+        default:
+          return false;
+      }
+    }
+
+    uint8_t argFor = 0;       // Command waiting for its argument
+
+    void command(uint8_t c) {
+      if (argFor) {
+        if (argFor == 0x81) contrast = c;
+        argFor = 0;
+      } else if (hasArg(c)) {
+        argFor = c;
+      } else if (c <= 0x0F) {
+        column = (column & 0xF0) | c;
+      } else if (c <= 0x1F) {
+        column = (column & 0x0F) | ((c & 0x0F) << 4);
+      } else if ((c & 0xF8) == 0xB0) {
+        page = c & 0x07;
+      } else if (c == 0xAE || c == 0xAF) {
+        on = (c == 0xAF);
+      }
+    }
+
+    void data(uint8_t d) {
+      if (column < 132) ram[page][column++] = d;
+      dataBytes++;
+    }
+
+    // Control byte: Co (0x80) = one byte follows, then another control
+    // byte; D/C (0x40) = data
+    void write(const uint8_t* p, uint8_t len) override {
+      uint8_t i = 0;
+      while (i < len) {
+        uint8_t ctrl = p[i++];
+        bool isData = ctrl & 0x40;
+        if (ctrl & 0x80) {
+          if (i < len) isData ? data(p[i++]) : command(p[i++]);
+          continue;
+        }
+        while (i < len) isData ? data(p[i++]) : command(p[i++]);
+      }
+    }
+
+    void read(uint8_t* p, uint8_t len) override {
+      memset(p, 0, len);      // Status byte: not busy
+    }
+
+    // 128 visible columns start at column 2
+    bool pixel(uint8_t x, uint8_t y) const {
+      return (ram[y >> 3][x + 2] >> (y & 7)) & 1;
+    }
+  };
+
+  // ===== VL53L0X =====
+  struct Vl53l0x : Sim::Device {
+    uint8_t reg = 0;
+    bool ranging = false;
+    uint32_t budgetUs = 33000;
+    uint32_t periodUs = 33000;
+    uint64_t startUs = 0;
+    uint64_t consumed = 0;    // Samples cleared by the host
+    std::function<uint16_t(uint64_t)> distance;
+
+    Vl53l0x() : distance([](uint64_t) { return (uint16_t)8190; }) {}
+
+    // Samples completed so far (the first one a period after the start)
+    uint64_t completed() const {
+      if (!ranging) return consumed;
+      return (Sim::now() - startUs) / periodUs;
+    }
+
+    void start() {
+      ranging = true;
+      periodUs = budgetUs;
+      startUs = Sim::now();
+      consumed = 0;
+    }
+
+    void write(const uint8_t* p, uint8_t len) override {
+      if (!len) return;
+      reg = p[0];
+      if (reg == VL53L0X::SYSTEM_INTERRUPT_CLEAR && len > 1 && (p[1] & 0x01)) {
+        consumed = completed();
+      }
+    }
+
+    uint8_t regValue(uint8_t r) {
+      uint64_t n = completed();
+      switch (r) {
+        case VL53L0X::RESULT_INTERRUPT_STATUS:
+          return n > consumed ? 0x04 : 0x00;   // "New sample ready"
+        case VL53L0X::RESULT_RANGE_STATUS + 10:
+        case VL53L0X::RESULT_RANGE_STATUS + 11: {
+          uint64_t at = startUs + (n ? n : 1) * periodUs;
+          uint16_t mm = distance(at);
+          if (mm > 8190) mm = 8190;
+          return r == VL53L0X::RESULT_RANGE_STATUS + 10 ? mm >> 8 : mm & 0xFF;
+        }
+        default:
+          return 0;
+      }
+    }
+
+    void read(uint8_t* p, uint8_t len) override {
+      for (uint8_t i = 0; i < len; i++) p[i] = regValue(reg++);
+    }
+  };
+
+  // ===== DS3231 =====
+  uint8_t toBcd(uint8_t v) { return ((v / 10) << 4) | (v % 10); }
+  uint8_t fromBcd(uint8_t v) { return (v >> 4) * 10 + (v & 0x0F); }
+
+  // Days since 1970-01-01 (proleptic Gregorian)
+  int64_t daysFromCivil(int y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = (unsigned)(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+  }
+
+  void civilFromDays(int64_t z, int& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned doe = (unsigned)(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = (int)(yoe + era * 400) + (m <= 2);
+  }
+
+  struct Ds3231 : Sim::Device {
+    uint8_t regs[0x13];
+    uint8_t reg = 0;
+    int64_t baseSeconds;      // Epoch seconds at baseUs
+    uint64_t baseUs = 0;
+
+    Ds3231() {
+      memset(regs, 0, sizeof(regs));
+      regs[0x0E] = 0x1C;      // INTCN, RS2:RS1 - power-on default
+      setTime(2026, 1, 1, 12, 0, 0);
+      setTemp(100);           // 25.00C
+    }
+
+    void setTime(int y, unsigned mo, unsigned d, unsigned h, unsigned mi, unsigned s) {
+      baseSeconds = daysFromCivil(y, mo, d) * 86400 + h * 3600 + mi * 60 + s;
+      baseUs = Sim::now();
+    }
+
+    void setTemp(int16_t quarters) {
+      uint16_t raw = (uint16_t)(quarters << 6);
+      regs[0x11] = raw >> 8;
+      regs[0x12] = raw & 0xC0;
+    }
+
+    void latchTime() {
+      int64_t t = baseSeconds + (int64_t)((Sim::now() - baseUs) / 1000000);
+      int64_t days = t / 86400;
+      int64_t secs = t % 86400;
+      int y;
+      unsigned m, d;
+      civilFromDays(days, y, m, d);
+      regs[0] = toBcd(secs % 60);
+      regs[1] = toBcd((secs / 60) % 60);
+      regs[2] = toBcd(secs / 3600);           // 24h mode
+      regs[3] = (uint8_t)(((days + 4) % 7) + 1);  // 1970-01-01 was a Thursday
+      regs[4] = toBcd(d);
+      regs[5] = toBcd(m) | (y >= 2100 ? 0x80 : 0);
+      regs[6] = toBcd(y % 100);
+    }
+
+    void write(const uint8_t* p, uint8_t len) override {
+      if (!len) return;
+      reg = p[0];
+      if (len == 1) return;
+
+      bool timeWritten = false;
+      latchTime();
+      for (uint8_t i = 1; i < len; i++, reg++) {
+        if (reg >= sizeof(regs)) continue;
+        if (reg == 0x0F) {
+          regs[reg] = (regs[reg] & p[i] & 0x80) | (p[i] & 0x0F);   // OSF clears only
+        } else if (reg != 0x11 && reg != 0x12) {
+          regs[reg] = p[i];
+        }
+        if (reg <= 0x06) timeWritten = true;
+      }
+      if (timeWritten) {
+        setTime(2000 + fromBcd(regs[6]) + ((regs[5] & 0x80) ? 100 : 0), fromBcd(regs[5] & 0x1F),
+                fromBcd(regs[4]), fromBcd(regs[2] & 0x3F), fromBcd(regs[1]), fromBcd(regs[0]));
+      }
+    }
+
+    void read(uint8_t* p, uint8_t len) override {
+      latchTime();
+      for (uint8_t i = 0; i < len; i++) {
+        p[i] = reg < sizeof(regs) ? regs[reg] : 0;
+        reg = (reg + 1) % sizeof(regs);
+      }
+    }
+  };
+
+  Sh1106 display;
+  Vl53l0x sensor;
+  Ds3231 rtc;
+
+  struct AttachDefaults {
+    AttachDefaults() {
+      Sim::attach(0x3C, &display);
+      Sim::attach(0x29, &sensor);
+      Sim::attach(0x68, &rtc);
+    }
+  } attachDefaults;
+}
+
+// ===== VL53L0X library =====
+
+// Real init() takes ~40ms of I2C traffic (reference SPAD setup, calibration)
+bool VL53L0X::init(bool io2v8) {
+  (void)io2v8;
+  delay(40);
+  return Sim::device(0x29) == &sensor;
+}
+
+bool VL53L0X::setMeasurementTimingBudget(uint32_t us) {
+  if (us < 20000) return false;
+  sensor.budgetUs = us;
+  return true;
+}
+
+uint32_t VL53L0X::getMeasurementTimingBudget() {
+  return sensor.budgetUs;
+}
+
+void VL53L0X::startContinuous(uint32_t periodMs) {
+  sensor.start();
+  if (periodMs * 1000 > sensor.budgetUs) sensor.periodUs = periodMs * 1000;
+}
+
+void VL53L0X::stopContinuous() {
+  sensor.ranging = false;
+}
+
+uint16_t VL53L0X::readRangeContinuousMillimeters() {
+  while (sensor.completed() <= sensor.consumed) delayMicroseconds(100);
+  sensor.consumed = sensor.completed();
+  return sensor.regValue(RESULT_RANGE_STATUS + 10) << 8 | sensor.regValue(RESULT_RANGE_STATUS + 11);
+}
+
+// ===== Control API =====
+
+namespace Sim {
+  bool displayPixel(uint8_t x, uint8_t y) {
+    return x < 128 && y < 64 && display.pixel(x, y);
+  }
+
+  bool displayOn() {
+    return display.on;
+  }
+
+  uint8_t displayContrast() {
+    return display.contrast;
+  }
+
+  uint32_t displayDataBytes() {
+    return display.dataBytes;
+  }
+
+  uint32_t displayHash() {
+    uint32_t h = 2166136261u;
+    for (uint8_t p = 0; p < 8; p++) {
+      for (uint8_t x = 0; x < 128; x++) {
+        h = (h ^ display.ram[p][x + 2]) * 16777619u;
+      }
+    }
+    return h;
+  }
+
+  std::string displayAscii() {
+    std::string s;
+    for (uint8_t y = 0; y < 64; y++) {
+      for (uint8_t x = 0; x < 128; x++) s += displayPixel(x, y) ? '#' : '.';
+      s += '\n';
+    }
+    return s;
+  }
+
+  // Same picture as the console's screenshot: PBM 1 is black, so lit
+  // pixels are written as 0
+  bool writePbm(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    fprintf(f, "P4\n128 64\n");
+    for (uint8_t y = 0; y < 64; y++) {
+      for (uint8_t x = 0; x < 128; x += 8) {
+        uint8_t out = 0;
+        for (uint8_t b = 0; b < 8; b++) out = (out << 1) | !displayPixel(x + b, y);
+        fputc(out, f);
+      }
+    }
+    return fclose(f) == 0;
+  }
+
+  void setDistance(uint16_t mm) {
+    sensor.distance = [mm](uint64_t) { return mm; };
+  }
+
+  void setDistanceFn(std::function<uint16_t(uint64_t us)> fn) {
+    sensor.distance = fn;
+  }
+
+  bool sensorRanging() {
+    return sensor.ranging;
+  }
+
+  uint32_t sensorPeriodUs() {
+    return sensor.periodUs;
+  }
+
+  void setRtcTime(uint16_t year, uint8_t month, uint8_t day,
+                  uint8_t hour, uint8_t minute, uint8_t second) {
+    rtc.setTime(year, month, day, hour, minute, second);
+  }
+
+  void setRtcTemp(int16_t quarters) {
+    rtc.setTemp(quarters);
+  }
+
+  void setRtcOscillatorStopped(bool osf) {
+    if (osf) rtc.regs[0x0F] |= 0x80;
+    else rtc.regs[0x0F] &= ~0x80;
+  }
+}
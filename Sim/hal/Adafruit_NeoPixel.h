@@ -0,0 +1,26 @@
+/*
+ * NeoPixel for the host simulator - one simulated pixel; show() latches
+ * the color (Sim::ledColor()) and takes 30us with interrupts off
+ */
+
+#pragma once
+#include "Arduino.h"
+
+#define NEO_GRB    0x52
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel {
+  public:
+    Adafruit_NeoPixel(uint16_t n, int16_t pin, uint16_t type) { (void)n; (void)pin; (void)type; }
+    void begin() {}
+    void setBrightness(uint8_t b) { (void)b; }
+    void clear() { color = 0; }
+    void show();
+    bool canShow() { return true; }
+    void setPixelColor(uint16_t n, uint32_t c) { if (n == 0) color = c; }
+    void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) { setPixelColor(n, Color(r, g, b)); }
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) { return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b; }
+
+  private:
+    uint32_t color = 0;
+};
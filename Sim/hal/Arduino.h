@@ -0,0 +1,123 @@
+/*
+ * Arduino core for the host simulator
+ *
+ * The subset of the Leonardo core the firmware uses, implemented in
+ * Sim/sim.cpp on a simulated clock. Pin numbers are the Leonardo's; pins
+ * 8-11 sit on PORTB (PB4-PB7) like on the ATmega32U4, so the button
+ * module's PCINT code runs unchanged.
+ *
+ * Differences from the AVR build worth knowing: int is 32 bits and
+ * unsigned long 64 bits here, and PROGMEM data lives in ordinary memory.
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "avr/pgmspace.h"
+#include "avr/io.h"
+#include "avr/interrupt.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW  0
+#define INPUT        0
+#define OUTPUT       1
+#define INPUT_PULLUP 2
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+static const uint8_t SDA = 2;
+static const uint8_t SCL = 3;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t level);
+
+void tone(uint8_t pin, unsigned int freq, unsigned long durationMs = 0);
+void noTone(uint8_t pin);
+
+void attachInterrupt(uint8_t pin, void (*fn)(), int mode);
+void detachInterrupt(uint8_t pin);
+
+// Leonardo PORTB: D8-D11 are PB4-PB7. Only PORTB is simulated.
+uint8_t simPortBBit(uint8_t pin);
+#define digitalPinToInterrupt(p)  (p)
+#define digitalPinToPCICR(p)      (&PCICR)
+#define digitalPinToPCICRbit(p)   0
+#define digitalPinToPCMSK(p)      (&PCMSK0)
+#define digitalPinToPCMSKbit(p)   simPortBBit(p)
+#define digitalPinToBitMask(p)    ((uint8_t)_BV(simPortBBit(p)))
+#define digitalPinToPort(p)       2
+#define portInputRegister(port)   (&PINB)
+#define portOutputRegister(port)  (&PORTB)
+
+// Functions rather than the AVR core's macros, so STL headers still build
+template <class T> T min(T a, T b) { return a < b ? a : b; }
+template <class T> T max(T a, T b) { return a > b ? a : b; }
+#define constrain(v, lo, hi) ((v) < (lo) ? (lo) : ((v) > (hi) ? (hi) : (v)))
+#define bitRead(v, b) (((v) >> (b)) & 1)
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    size_t write(const uint8_t* data, size_t len);
+    size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+    size_t print(const char* s);
+    size_t print(const __FlashStringHelper* s) { return print((const char*)s); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char v, int base = DEC) { return print((unsigned long)v, base); }
+    size_t print(int v, int base = DEC) { return print((long)v, base); }
+    size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+    size_t print(long v, int base = DEC);
+    size_t print(unsigned long v, int base = DEC);
+    size_t print(double v, int digits = 2);
+
+    template <class T> size_t println(T v) { size_t n = print(v); return n + println(); }
+    template <class T> size_t println(T v, int arg) { size_t n = print(v, arg); return n + println(); }
+    size_t println() { return write((const uint8_t*)"\r\n", 2); }
+};
+
+// USB CDC port; bytes go to Sim::serialOutput(), input comes from Sim::serialInput()
+class Serial_ : public Print {
+  public:
+    void begin(unsigned long baud) { (void)baud; }
+    int available();
+    int read();
+    int peek();
+    int availableForWrite();
+    void flush() {}
+    size_t write(uint8_t c) override;
+    using Print::write;
+    operator bool();
+};
+extern Serial_ Serial;
+
+struct USBDevice_ {
+  bool configured();
+  void attach() {}
+  void detach() {}
+};
+extern USBDevice_ USBDevice;
+
+void setup(void);
+void loop(void);
@@ -0,0 +1,28 @@
+/*
+ * EEPROM library for the host simulator - 1KB, erased (0xFF) at power-on
+ * unless Sim::loadEeprom() restored an image
+ */
+
+#pragma once
+#include "Arduino.h"
+#include <avr/eeprom.h>
+
+#define E2END 0x3FF
+
+struct EEPROMClass {
+  uint8_t read(int addr);
+  void write(int addr, uint8_t value);
+  void update(int addr, uint8_t value);
+  uint16_t length() { return E2END + 1; }
+
+  template <class T> T& get(int addr, T& t) {
+    for (size_t i = 0; i < sizeof(T); i++) ((uint8_t*)&t)[i] = read(addr + i);
+    return t;
+  }
+
+  template <class T> const T& put(int addr, const T& t) {
+    for (size_t i = 0; i < sizeof(T); i++) update(addr + i, ((const uint8_t*)&t)[i]);
+    return t;
+  }
+};
+extern EEPROMClass EEPROM;
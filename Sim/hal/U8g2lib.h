@@ -0,0 +1,93 @@
+/*
+ * U8g2 for the host simulator
+ *
+ * A page buffer (_1_) U8G2 with the calls the firmware makes. Drawing
+ * goes into the 128x8 page buffer; every byte that reaches the panel is
+ * sent through the byte procedure given to the setup function, exactly
+ * like U8g2's SH1106 I2C driver: a command transfer (0x00, page, column)
+ * followed by data transfers (0x40, up to SIM_U8X8_CHUNK bytes). So the
+ * firmware's I2CBus queue carries every display byte, and the simulated
+ * SH1106 on the bus builds the picture the watch would show.
+ *
+ * Text uses a built-in 5x7 glyph set in a 6x10 cell, whatever font is
+ * selected; the font arrays below are placeholders. Glyphs are positioned
+ * like u8g2_font_6x10 with setFontPosTop().
+ */
+
+#pragma once
+#include "Arduino.h"
+
+typedef uint8_t u8g2_uint_t;
+
+typedef struct u8x8_struct u8x8_t;
+typedef uint8_t (*u8x8_msg_cb)(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr);
+
+struct u8x8_struct {
+  u8x8_msg_cb byteCb;
+  u8x8_msg_cb gpioCb;
+  uint8_t i2c_address;    // 8-bit form, like U8g2 (0x78 for 0x3C)
+};
+
+typedef struct {
+  u8x8_t u8x8;
+} u8g2_t;
+
+struct u8g2_cb_t {
+  uint8_t rotation;
+};
+extern const u8g2_cb_t* U8G2_R0;
+
+#define U8X8_PIN_NONE 255
+#define U8X8_MSG_BYTE_SEND           23
+#define U8X8_MSG_BYTE_INIT           20
+#define U8X8_MSG_BYTE_SET_DC         32
+#define U8X8_MSG_BYTE_START_TRANSFER 24
+#define U8X8_MSG_BYTE_END_TRANSFER   25
+#define U8G2_FONT_SECTION(name)
+
+#define SIM_U8X8_CHUNK 24       // Data bytes per transfer, as U8g2's ssd13xx I2C CAD
+
+extern const uint8_t u8g2_font_6x10_tf[];
+
+uint8_t u8x8_gpio_and_delay_arduino(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr);
+void u8g2_Setup_sh1106_i2c_128x64_noname_1(u8g2_t* u8g2, const u8g2_cb_t* rotation,
+                                          u8x8_msg_cb byteCb, u8x8_msg_cb gpioCb);
+uint8_t u8x8_GetI2CAddress(u8x8_t* u8x8);
+void u8x8_SetI2CAddress(u8x8_t* u8x8, uint8_t addr);
+uint8_t u8x8_DrawTile(u8x8_t* u8x8, uint8_t x, uint8_t y, uint8_t cnt, uint8_t* tiles);
+void u8x8_RefreshDisplay(u8x8_t* u8x8);
+
+class U8G2 {
+  public:
+    u8g2_t u8g2;
+
+    U8G2();
+    bool begin();
+    void setContrast(uint8_t value);
+    void setPowerSave(uint8_t on);
+
+    void setFont(const uint8_t* font) { this->font = font; }
+    void setFontPosTop() { posTop = true; }
+    void drawStr(u8g2_uint_t x, u8g2_uint_t y, const char* s);
+    void drawBox(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h);
+    void drawHLine(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w);
+    void drawPixel(u8g2_uint_t x, u8g2_uint_t y);
+
+    void clearBuffer();
+    void sendBuffer();
+    void firstPage();
+    uint8_t nextPage();
+    void setBufferCurrTileRow(uint8_t row) { tileRow = row; }
+    uint8_t getBufferCurrTileRow() { return tileRow; }
+    uint8_t* getBufferPtr() { return buffer; }
+    uint8_t getBufferTileHeight() { return 1; }
+    uint8_t getBufferTileWidth() { return 16; }
+    u8x8_t* getU8x8() { return &u8g2.u8x8; }
+    u8g2_t* getU8g2() { return &u8g2; }
+
+  private:
+    uint8_t buffer[128];
+    uint8_t tileRow = 0;
+    const uint8_t* font = 0;
+    bool posTop = false;
+};
@@ -0,0 +1,39 @@
+/*
+ * Pololu VL53L0X library for the host simulator
+ *
+ * The configuration calls go straight to the simulated sensor (they are
+ * I2C register sequences on the real part, which the firmware does not
+ * depend on). The firmware's own result polling - interrupt status, range
+ * and interrupt clear - goes over the simulated bus through I2CBus.
+ */
+
+#pragma once
+#include "Arduino.h"
+
+class VL53L0X {
+  public:
+    enum vcselPeriodType { VcselPeriodPreRange, VcselPeriodFinalRange };
+
+    enum regAddr {
+      SYSTEM_INTERRUPT_CONFIG_GPIO = 0x0A,
+      SYSTEM_INTERRUPT_CLEAR       = 0x0B,
+      RESULT_INTERRUPT_STATUS      = 0x13,
+      RESULT_RANGE_STATUS          = 0x14,
+      GPIO_HV_MUX_ACTIVE_HIGH      = 0x84
+    };
+
+    void setTimeout(uint16_t ms) { timeoutMs = ms; }
+    uint16_t getTimeout() { return timeoutMs; }
+    bool init(bool io2v8 = true);
+    bool setSignalRateLimit(float mcps) { return mcps > 0 && mcps < 512; }
+    bool setVcselPulsePeriod(vcselPeriodType type, uint8_t pclks) { (void)type; return pclks >= 8 && pclks <= 18; }
+    bool setMeasurementTimingBudget(uint32_t us);
+    uint32_t getMeasurementTimingBudget();
+    void startContinuous(uint32_t periodMs = 0);
+    void stopContinuous();
+    uint16_t readRangeContinuousMillimeters();
+    bool timeoutOccurred() { return false; }
+
+  private:
+    uint16_t timeoutMs = 0;
+};
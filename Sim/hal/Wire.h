@@ -0,0 +1,21 @@
+/*
+ * Wire for the host simulator - bus setup and timeout flag only; the
+ * firmware moves its bytes with the twi_* calls (utility/twi.h)
+ */
+
+#pragma once
+#include "Arduino.h"
+
+class TwoWire {
+  public:
+    void begin();
+    void end();
+    void setClock(uint32_t hz);
+    void setWireTimeout(uint32_t timeoutUs = 25000, bool resetOnTimeout = false) {
+      (void)timeoutUs;
+      (void)resetOnTimeout;
+    }
+    bool getWireTimeoutFlag() { return false; }
+    void clearWireTimeoutFlag() {}
+};
+extern TwoWire Wire;
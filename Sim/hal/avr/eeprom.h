@@ -0,0 +1,8 @@
+/*
+ * EEPROM status for the host simulator - a write keeps the EEPROM busy
+ * for 3.4ms of simulated time, as on the ATmega32U4
+ */
+
+#pragma once
+
+int eeprom_is_ready();
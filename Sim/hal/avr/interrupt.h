@@ -0,0 +1,19 @@
+/*
+ * Interrupts for the host simulator
+ *
+ * ISR(v) defines the function the simulator calls for vector v. cli()
+ * holds interrupts back; they run, in order, at the next sei().
+ */
+
+#pragma once
+#include <stdint.h>
+
+#define ISR(vector) extern "C" void vector()
+#define ISR_NOBLOCK
+
+void simCli();
+void simSei();
+#define cli()          simCli()
+#define sei()          simSei()
+#define noInterrupts() simCli()
+#define interrupts()   simSei()
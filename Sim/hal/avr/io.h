@@ -0,0 +1,99 @@
+/*
+ * ATmega32U4 registers for the host simulator
+ *
+ * Plain variables, except the TWI status registers: reading TWSR or TWCR
+ * reports whether the simulated bus is still busy with a background
+ * write. The I bit of SREG is the simulator's interrupt enable, so saving
+ * and restoring SREG around cli() works as on the chip. TCNT0 counts 4us
+ * ticks of the simulated clock and compare B fires when it reaches OCR0B
+ * (compare A stays the 1ms tick). TCNT1 counts F_CPU cycles of the
+ * simulated clock (16 per us) when started with no prescaler and
+ * overflows into TIMER1_OVF_vect; TOV1 in TIFR1 is set while that
+ * interrupt is pending and cleared by writing 1. PINB is driven by
+ * Sim::setPin(). Interrupt vectors are named functions the simulator
+ * calls (weak defaults in sim.cpp).
+ *
+ * SP is the host stack pointer where it is read, and __brkval the bottom
+ * of the firmware's stack, so free RAM between the two is that stack's
+ * unused part (host frames, not AVR ones).
+ */
+
+#pragma once
+#include <stdint.h>
+
+#define F_CPU 16000000UL
+#define RAMEND 0x0AFF
+
+extern volatile uint8_t PINB, PORTB, DDRB;
+extern volatile uint8_t PCICR, PCMSK0, PCIFR;
+extern volatile uint8_t EIMSK, EIFR;
+extern volatile uint8_t OCR0A, OCR0B, TIMSK0, TIFR0;
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+extern volatile uint16_t OCR1A;
+extern volatile uint8_t ADCSRA, MCUCR, SMCR, PRR0, PRR1;
+extern volatile uint8_t TWBR, TWDR;
+
+volatile uint8_t& simTwsr();
+volatile uint8_t& simTwcr();
+#define TWSR (simTwsr())
+#define TWCR (simTwcr())
+
+uint8_t simTcnt0();
+#define TCNT0 (simTcnt0())
+
+struct SimSreg {
+  operator uint8_t() const;
+  SimSreg& operator=(uint8_t sreg);
+};
+SimSreg& simSreg();
+#define SREG (simSreg())
+
+struct SimTcnt1 {
+  operator uint16_t() const;
+  SimTcnt1& operator=(uint16_t count);
+};
+SimTcnt1& simTcnt1();
+#define TCNT1 (simTcnt1())
+
+struct SimTifr1 {
+  operator uint8_t() const;
+  SimTifr1& operator=(uint8_t clear);
+};
+SimTifr1& simTifr1();
+#define TIFR1 (simTifr1())
+
+uintptr_t simStackPointer();
+#define SP (simStackPointer())
+
+#define _BV(b) (1 << (b))
+
+#define PCIE0  0
+#define PCIF0  0
+#define OCIE0A 1
+#define OCF0A  1
+#define OCIE0B 2
+#define OCF0B  2
+#define TOV1   0
+#define TOIE1  0
+#define CS10   0
+#define CS11   1
+#define TWIE   0
+#define TWEN   2
+#define TWSTO  4
+#define TWSTA  5
+#define TWEA   6
+#define TWINT  7
+#define ADEN   7
+#define SE     0
+#define PRADC    0
+#define PRUSART1 0
+#define PRSPI    2
+#define PRTIM1   3
+#define PRTIM3   3
+#define PRTWI    7
+#define PRUSB    7
+
+#define PCINT0_vect        simVectPcint0
+#define TIMER0_COMPA_vect  simVectTimer0CompA
+#define TIMER0_COMPB_vect  simVectTimer0CompB
+#define TIMER1_OVF_vect    simVectTimer1Ovf
@@ -0,0 +1,10 @@
+/*
+ * Peripheral power reduction for the host simulator - no effect
+ */
+
+#pragma once
+
+inline void power_adc_disable() {}
+inline void power_adc_enable() {}
+inline void power_all_disable() {}
+inline void power_all_enable() {}
@@ -0,0 +1,19 @@
+/*
+ * Sleep modes for the host simulator
+ *
+ * sleep_cpu() in idle lets time run to the next Timer0 tick; in power-down
+ * it jumps to the next scripted event (a button), since nothing else can
+ * wake the MCU.
+ */
+
+#pragma once
+
+#define SLEEP_MODE_IDLE     0
+#define SLEEP_MODE_PWR_DOWN 2
+
+void set_sleep_mode(int mode);
+void sleep_cpu();
+inline void sleep_enable() {}
+inline void sleep_disable() {}
+inline void sleep_bod_disable() {}
+inline void sleep_mode() { sleep_cpu(); }
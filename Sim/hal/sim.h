@@ -0,0 +1,115 @@
+/*
+ * Simulator control - clock, scripted input, device models, captured output
+ *
+ * The firmware only sees the Arduino/AVR API (the other headers in hal/).
+ * Tests and the runner use this header to drive it: run loop() for a
+ * stretch of simulated time, press buttons, set the distance the sensor
+ * reads, and inspect what came out - serial bytes, tones, HID reports,
+ * the LED and the SH1106's display RAM.
+ *
+ * Time is simulated in microseconds and only moves when the firmware
+ * reads the clock (setReadCost() per millis()/micros()/status register
+ * read), waits (delay(), a blocking I2C transfer, sleep) or between
+ * loop() calls (setLoopCost()).
+ * Nothing waits for the wall clock, so a simulated minute of the watch
+ * runs in a fraction of a second.
+ */
+
+#pragma once
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Sim {
+  // ===== Clock =====
+  // Simulated microseconds since power-on. This is the outside world's
+  // time (the DS3231 follows it); millis()/micros() stand still while the
+  // MCU is in power-down, like Timer0 on the real chip.
+  uint64_t now();
+  void advance(uint64_t us);         // Let time pass (ISRs and events fire)
+  void setReadCost(uint32_t us);     // Cost of a clock/status register read (default 1)
+  void setLoopCost(uint32_t us);     // Cost of one loop() pass outside the firmware (default 20)
+
+  // The sketch's setup() runs on the first run(), then loop() over and
+  // over. The firmware has its own stack: run() returns once the time is
+  // up wherever the firmware is - mid-delay, mid-transfer or asleep - and
+  // the next run() carries on from there. One power-on per process: the
+  // firmware's globals are never re-initialized.
+  void run(uint64_t us);             // Until `us` more simulated time has passed
+  inline void runMs(uint64_t ms) { run(ms * 1000); }
+  uint64_t loopCount();
+
+  // Call fn at simulated time `atUs` (interrupt context: no clock cost)
+  void at(uint64_t atUs, std::function<void()> fn);
+
+  // ===== Pins and buttons =====
+  void setPin(uint8_t pin, uint8_t level);
+  uint8_t pinLevel(uint8_t pin);
+  void press(uint8_t pin);           // Button to GND now
+  void release(uint8_t pin);
+  // Press now, release after holdMs (scheduled)
+  void click(uint8_t pin, uint32_t holdMs = 80);
+
+  // ===== USB =====
+  void setUsbConfigured(bool configured);
+  void serialInput(const std::string& bytes);
+  void serialInput(const uint8_t* data, size_t len);
+  std::string& serialOutput();       // Everything printed; clear() freely
+
+  struct HidReport {
+    uint64_t us;
+    uint8_t id;
+    uint8_t data[8];
+  };
+  std::vector<HidReport>& hidReports();
+
+  // ===== Actuators =====
+  struct ToneEvent {
+    uint64_t us;
+    uint16_t freq;                   // 0: noTone()
+    uint32_t ms;                     // 0: until noTone()
+  };
+  std::vector<ToneEvent>& tones();
+  uint32_t ledColor();               // 0xRRGGBB as last shown
+  uint32_t ledShows();
+
+  // ===== EEPROM =====
+  uint8_t* eeprom();                 // 1024 bytes
+
+  // ===== I2C bus =====
+  struct Device {
+    virtual ~Device() {}
+    virtual void write(const uint8_t* data, uint8_t len) = 0;
+    virtual void read(uint8_t* data, uint8_t len) = 0;
+  };
+  void attach(uint8_t addr, Device* dev);   // 7-bit address; 0 detaches
+  Device* device(uint8_t addr);
+  uint32_t busBytes(uint8_t addr);          // Bytes addressed to a device, incl. address byte
+  uint32_t busClock();
+
+  // ===== SH1106 =====
+  bool displayPixel(uint8_t x, uint8_t y);
+  bool displayOn();
+  uint8_t displayContrast();
+  uint32_t displayDataBytes();              // Display RAM bytes written since power-on
+  uint32_t displayHash();                   // FNV-1a of the visible 128x64 area
+  std::string displayAscii();               // 64 lines of '#' and '.'
+  // Text drawn with the simulator's glyphs (U8g2lib.h) anywhere on the
+  // panel, at any pixel position
+  bool displayShows(const char* text);
+  bool writePbm(const std::string& path);   // Binary PBM, white on black like the panel
+  std::string drawnGlyphs();                // Every character drawStr() was given, once each
+
+  // ===== VL53L0X =====
+  void setDistance(uint16_t mm);
+  void setDistanceFn(std::function<uint16_t(uint64_t us)> fn);
+  bool sensorRanging();
+  uint32_t sensorPeriodUs();
+
+  // ===== DS3231 =====
+  void setRtcTime(uint16_t year, uint8_t month, uint8_t day,
+                  uint8_t hour, uint8_t minute, uint8_t second);
+  void setRtcTemp(int16_t quarters);
+  void setRtcOscillatorStopped(bool osf);
+}
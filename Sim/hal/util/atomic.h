@@ -0,0 +1,21 @@
+/*
+ * ATOMIC_BLOCK for the host simulator: interrupts held back for the block,
+ * then restored to the state before it
+ */
+
+#pragma once
+#include <stdint.h>
+
+uint8_t simIrqSave();
+void simIrqRestore(uint8_t state);
+
+struct SimAtomicBlock {
+  uint8_t state;
+  bool once;
+  SimAtomicBlock() : state(simIrqSave()), once(true) {}
+  ~SimAtomicBlock() { simIrqRestore(state); }
+};
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define ATOMIC_BLOCK(type) for (SimAtomicBlock simAtomic_; simAtomic_.once; simAtomic_.once = false)
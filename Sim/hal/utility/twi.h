@@ -0,0 +1,16 @@
+/*
+ * Wire's TWI driver for the host simulator
+ *
+ * Transfers go to the device models attached with Sim::attachDevice().
+ * A write with wait = 0 runs in the background: the bus stays busy (TWSR
+ * not 0xF8) for the time the bytes take at the Wire clock.
+ */
+
+#pragma once
+#include <stdint.h>
+
+void twi_init(void);
+void twi_disable(void);
+void twi_setFrequency(uint32_t hz);
+uint8_t twi_readFrom(uint8_t addr, uint8_t* data, uint8_t len, uint8_t sendStop);
+uint8_t twi_writeTo(uint8_t addr, uint8_t* data, uint8_t len, uint8_t wait, uint8_t sendStop);
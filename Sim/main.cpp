@@ -0,0 +1,175 @@
+/*
+ * mauther-sim - runs the firmware on the host against simulated hardware
+ *
+ *   mauther-sim [options] [script]
+ *
+ * The script (file, or stdin with "-") drives the watch one command per
+ * line; see Sim/README.md. Without a script the watch boots, runs for a
+ * second and the screen is printed.
+ */
+
+#include "../Mauther/Mauther.ino"
+#include "sim.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+  std::string framesDir;
+  unsigned frameCount = 0;
+  uint32_t lastHash = 0;
+  bool echoSerial = false;
+
+  // Run in steps, saving a frame whenever the panel changed
+  void runFor(uint64_t ms) {
+    if (framesDir.empty()) {
+      Sim::runMs(ms);
+      return;
+    }
+    uint64_t end = Sim::now() + ms * 1000;
+    while (Sim::now() < end) {
+      uint64_t step = end - Sim::now();
+      Sim::run(step < 10000 ? step : 10000);
+      uint32_t h = Sim::displayHash();
+      if (h != lastHash) {
+        lastHash = h;
+        char name[32];
+        snprintf(name, sizeof(name), "/frame%05u.pbm", frameCount++);
+        Sim::writePbm(framesDir + name);
+      }
+    }
+  }
+
+  int buttonPin(const std::string& name) {
+    if (name == "up") return PIN_BUTTON_UP;
+    if (name == "down") return PIN_BUTTON_DOWN;
+    if (name == "sel" || name == "select") return PIN_BUTTON_SEL;
+    return -1;
+  }
+
+  bool fail(int line, const std::string& msg) {
+    std::cerr << "script line " << line << ": " << msg << "\n";
+    return false;
+  }
+
+  // One command; false on a bad line
+  bool command(const std::string& text, int line) {
+    std::istringstream in(text);
+    std::string cmd;
+    if (!(in >> cmd) || cmd[0] == '#') return true;
+
+    if (cmd == "wait") {
+      uint64_t ms;
+      if (!(in >> ms)) return fail(line, "wait MS");
+      runFor(ms);
+    } else if (cmd == "click" || cmd == "hold" || cmd == "press" || cmd == "release") {
+      std::string name;
+      in >> name;
+      int pin = buttonPin(name);
+      if (pin < 0) return fail(line, cmd + " up|down|sel");
+      if (cmd == "press") {
+        Sim::press(pin);
+      } else if (cmd == "release") {
+        Sim::release(pin);
+      } else {
+        uint32_t ms = cmd == "hold" ? 1000 : 80;
+        in >> ms;
+        Sim::click(pin, ms);
+        runFor(ms + 100);     // Let the press finish and the UI react
+      }
+    } else if (cmd == "distance") {
+      unsigned mm;
+      if (!(in >> mm)) return fail(line, "distance MM");
+      Sim::setDistance(mm);
+    } else if (cmd == "temp") {
+      double c;
+      if (!(in >> c)) return fail(line, "temp DEGREES");
+      Sim::setRtcTemp((int16_t)(c * 4));
+    } else if (cmd == "time") {
+      unsigned y, mo, d, h, mi, s;
+      char sep;
+      if (!(in >> y >> sep >> mo >> sep >> d >> h >> sep >> mi >> sep >> s)) {
+        return fail(line, "time YYYY-MM-DD HH:MM:SS");
+      }
+      Sim::setRtcTime(y, mo, d, h, mi, s);
+    } else if (cmd == "usb") {
+      std::string state;
+      in >> state;
+      Sim::setUsbConfigured(state != "off");
+    } else if (cmd == "serial") {
+      std::string rest;
+      std::getline(in, rest);
+      size_t start = rest.find_first_not_of(' ');
+      rest = start == std::string::npos ? "" : rest.substr(start);
+      Sim::serialInput(rest + "\n");
+    } else if (cmd == "shot") {
+      std::string path;
+      if (!(in >> path)) return fail(line, "shot FILE.pbm");
+      if (!Sim::writePbm(path)) return fail(line, "cannot write " + path);
+    } else if (cmd == "screen") {
+      std::cout << Sim::displayAscii();
+    } else {
+      return fail(line, "unknown command '" + cmd + "'");
+    }
+
+    if (echoSerial && !Sim::serialOutput().empty()) {
+      std::cout << Sim::serialOutput();
+      Sim::serialOutput().clear();
+    }
+    return true;
+  }
+
+  void usage() {
+    std::cerr << "usage: mauther-sim [--frames DIR] [--loop-us N] [--serial] [script|-]\n";
+  }
+}
+
+int main(int argc, char** argv) {
+  std::string script;
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    if (a == "--frames" && i + 1 < argc) {
+      framesDir = argv[++i];
+    } else if (a == "--loop-us" && i + 1 < argc) {
+      Sim::setLoopCost(atoi(argv[++i]));
+    } else if (a == "--serial") {
+      echoSerial = true;
+    } else if (a == "-h" || a == "--help") {
+      usage();
+      return 0;
+    } else if (a[0] == '-' && a != "-") {
+      usage();
+      return 2;
+    } else {
+      script = a;
+    }
+  }
+
+  auto started = std::chrono::steady_clock::now();
+  bool ok = true;
+
+  if (script.empty()) {
+    ok = command("wait 1000", 0) && command("screen", 0);
+  } else {
+    std::ifstream file;
+    std::istream* in = &std::cin;
+    if (script != "-") {
+      file.open(script);
+      if (!file) {
+        std::cerr << "cannot open " << script << "\n";
+        return 2;
+      }
+      in = &file;
+    }
+    std::string text;
+    for (int line = 1; ok && std::getline(*in, text); line++) ok = command(text, line);
+  }
+
+  double hostMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+  double simMs = Sim::now() / 1000.0;
+  fprintf(stderr, "simulated %.0f ms in %.0f ms (%.0fx real time), %llu loops, %.0f ns per loop\n",
+          simMs, hostMs, hostMs > 0 ? simMs / hostMs : 0.0, (unsigned long long)Sim::loopCount(),
+          Sim::loopCount() ? hostMs * 1e6 / Sim::loopCount() : 0.0);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,835 @@
+/*
+ * Simulator core - clock, interrupts, pins, USB, EEPROM, TWI
+ *
+ * The firmware runs on its own stack (ucontext) so that run() can hand
+ * control back to the caller at any simulated time, wherever the firmware
+ * happens to be waiting. Everything else is single threaded: interrupts
+ * are plain calls made while time advances, held back while the firmware
+ * has them disabled.
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <EEPROM.h>
+#include <Keyboard.h>
+#include <Adafruit_NeoPixel.h>
+#include <avr/sleep.h>
+#include <avr/eeprom.h>
+#include <util/atomic.h>
+#include <ucontext.h>
+#include <deque>
+#include <map>
+#include "sim.h"
+
+extern "C" {
+  #include <utility/twi.h>
+}
+
+// ===== Registers =====
+
+volatile uint8_t PINB = 0xF0, PORTB, DDRB;
+volatile uint8_t PCICR, PCMSK0, PCIFR;
+volatile uint8_t EIMSK, EIFR;
+volatile uint8_t OCR0A, OCR0B, TIMSK0, TIFR0;
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+volatile uint16_t OCR1A;
+volatile uint8_t ADCSRA, MCUCR, SMCR, PRR0, PRR1;
+volatile uint8_t TWBR, TWDR;
+
+// Heap end for stack painting: the bottom of the firmware's stack
+char __heap_start;
+char* __brkval;
+
+// Interrupt vectors the sketch does not define
+extern "C" {
+  __attribute__((weak)) void simVectPcint0() {}
+  __attribute__((weak)) void simVectTimer0CompA() {}
+  __attribute__((weak)) void simVectTimer0CompB() {}
+  __attribute__((weak)) void simVectTimer1Ovf() {}
+}
+
+// The sketch, when linked in
+void setup() __attribute__((weak));
+void loop() __attribute__((weak));
+
+namespace {
+  // Pending bits, lowest first = AVR vector priority
+  enum {
+    VEC_EXT = 0,             // 0-7: external interrupts, by pin & 7
+    VEC_PCINT0 = 8,
+    VEC_TIMER0_COMPA = 9,
+    VEC_TIMER1_OVF = 10,
+    VEC_TIMER0_COMPB = 11
+  };
+
+  uint64_t clockUs = 0;
+  uint64_t stoppedUs = 0;    // Time spent in power-down, when Timer0 (millis) stands still
+  uint32_t readCost = 1;
+  uint32_t loopCost = 20;
+  bool irqEnabled = true;    // The Arduino core enables them before setup()
+  int isrDepth = 0;          // > 0: in an ISR or a scripted event
+  uint32_t pending = 0;
+  bool poweredDown = false;  // Timer0 stopped
+  bool sleeping = false;     // In sleep_cpu(): any interrupt ends it
+  bool woke = false;
+
+  // Timer1: the count written to TCNT1 and when
+  uint64_t timer1FromUs = 0;
+  uint16_t timer1From = 0;
+
+  std::multimap<uint64_t, std::function<void()> >& events() {
+    static std::multimap<uint64_t, std::function<void()> > e;
+    return e;
+  }
+
+  // Firmware context
+  ucontext_t hostCtx, fwCtx;
+  bool fwStarted = false;
+  bool inFirmware = false;
+  uint64_t deadline = 0;
+  uint64_t loops = 0;
+
+  // Pins: level per Arduino pin, attachInterrupt handlers
+  uint8_t levels[32];
+  bool levelsInit = false;
+  void (*extHandler[8])() = {0};   // By pin & 7 (INT pins 0-3, 7)
+  uint8_t extPin[8];
+  int extMode[8];
+
+  // Sleep
+  int sleepMode = SLEEP_MODE_IDLE;
+
+  // USB
+  bool usbConfigured = true;
+
+  std::deque<uint8_t>& serialIn() {
+    static std::deque<uint8_t> q;
+    return q;
+  }
+
+  // EEPROM
+  uint8_t eepromData[E2END + 1];
+  bool eepromInit = false;
+  uint64_t eepromBusyUntil = 0;
+
+  // TWI
+  Sim::Device* devices[128] = {0};
+  uint32_t addrBytes[128] = {0};
+  uint32_t twiClock = 100000;
+  uint64_t busBusyUntil = 0;
+  volatile uint8_t twsr = 0xF8;
+  volatile uint8_t twcr = 0;
+
+  // LED
+  uint32_t ledShown = 0;
+  uint32_t ledShowCount = 0;
+
+  void runIsr(int vec) {
+    isrDepth++;
+    irqEnabled = false;      // The I flag is cleared on entry...
+    if (vec < VEC_PCINT0) {
+      if (extHandler[vec]) extHandler[vec]();
+    } else if (vec == VEC_PCINT0) {
+      simVectPcint0();
+    } else if (vec == VEC_TIMER0_COMPA) {
+      simVectTimer0CompA();
+    } else if (vec == VEC_TIMER1_OVF) {
+      simVectTimer1Ovf();
+    } else if (vec == VEC_TIMER0_COMPB) {
+      simVectTimer0CompB();
+    }
+    irqEnabled = true;       // ...and set again by reti
+    isrDepth--;
+    woke = true;
+  }
+
+  void runPending() {
+    while (pending && irqEnabled && isrDepth == 0) {
+      int vec = __builtin_ctz(pending);
+      pending &= ~(1u << vec);
+      runIsr(vec);
+    }
+  }
+
+  void raise(int vec) {
+    pending |= 1u << vec;
+    runPending();
+  }
+
+  void yieldToHost() {
+    inFirmware = false;
+    swapcontext(&fwCtx, &hostCtx);
+    inFirmware = true;
+  }
+
+  // Only the no-prescaler mode bench.h uses counts
+  bool timer1Counting() {
+    return (TCCR1B & 7) == _BV(CS10) && !poweredDown;
+  }
+
+  uint64_t timer1Cycles() {
+    return timer1From + (clockUs - timer1FromUs) * (F_CPU / 1000000);
+  }
+
+  // Let time run to `target`, firing Timer0 ticks and scripted events on
+  // the way. In the firmware context it hands back to the host at the
+  // deadline and continues on the next run().
+  void runTo(uint64_t target) {
+    for (;;) {
+      uint64_t next = target;
+      bool tickEnabled = (TIMSK0 & _BV(OCIE0A)) && !poweredDown;
+      uint64_t tick = (clockUs / 1000 + 1) * 1000;
+      if (tickEnabled && tick < next) next = tick;
+      // Compare B: the next time TCNT0 (4us ticks) steps onto OCR0B
+      bool compBEnabled = (TIMSK0 & _BV(OCIE0B)) && !poweredDown;
+      uint64_t count = clockUs / 4;
+      uint64_t compB = (count + (uint8_t)(OCR0B - count - 1) + 1) * 4;
+      if (compBEnabled && compB < next) next = compB;
+      // Timer1 overflow: the first microsecond the count reaches 65536
+      bool ovf1Enabled = (TIMSK1 & _BV(TOIE1)) && timer1Counting();
+      uint64_t wrap = (timer1Cycles() / 65536 + 1) * 65536 - timer1From;
+      uint64_t ovf1 = timer1FromUs + (wrap + F_CPU / 1000000 - 1) / (F_CPU / 1000000);
+      if (ovf1Enabled && ovf1 < next) next = ovf1;
+      if (!events().empty() && events().begin()->first < next) next = events().begin()->first;
+      if (inFirmware && deadline > clockUs && deadline < next) next = deadline;
+      if (next > clockUs) {
+        if (poweredDown) stoppedUs += next - clockUs;
+        clockUs = next;
+      }
+
+      while (!events().empty() && events().begin()->first <= clockUs) {
+        std::function<void()> fn = events().begin()->second;
+        events().erase(events().begin());
+        isrDepth++;
+        fn();
+        isrDepth--;
+        runPending();
+      }
+      if (tickEnabled && clockUs == tick) raise(VEC_TIMER0_COMPA);
+      if (compBEnabled && clockUs == compB) raise(VEC_TIMER0_COMPB);
+      if (ovf1Enabled && clockUs == ovf1) raise(VEC_TIMER1_OVF);
+
+      if (inFirmware && clockUs >= deadline) yieldToHost();
+      if (clockUs >= target || (sleeping && woke)) break;
+    }
+  }
+
+  // Time spent by the firmware itself (clock reads, waits)
+  void spend(uint64_t us) {
+    if (isrDepth > 0 || us == 0) return;
+    runTo(clockUs + us);
+  }
+
+  void firmwareMain() {
+    if (setup) setup();
+    for (;;) {
+      if (loop) loop();
+      loops++;
+      spend(loopCost);
+    }
+  }
+
+  void initLevels() {
+    if (levelsInit) return;
+    levelsInit = true;
+    memset(levels, HIGH, sizeof(levels));   // Inputs idle high (pull-ups)
+  }
+
+  uint64_t byteTimeUs(uint32_t bytes) {
+    return (bytes * 9ULL * 1000000ULL + twiClock - 1) / twiClock;
+  }
+
+  void waitBus() {
+    if (clockUs < busBusyUntil && isrDepth == 0) runTo(busBusyUntil);
+  }
+
+  void initEeprom() {
+    if (eepromInit) return;
+    eepromInit = true;
+    memset(eepromData, 0xFF, sizeof(eepromData));
+  }
+}
+
+// ===== Clock and interrupts =====
+
+unsigned long millis() {
+  spend(readCost);
+  return (clockUs - stoppedUs) / 1000;
+}
+
+unsigned long micros() {
+  spend(readCost);
+  return clockUs - stoppedUs;
+}
+
+void delay(unsigned long ms) {
+  spend(ms * 1000ULL);
+}
+
+void delayMicroseconds(unsigned int us) {
+  spend(us);
+}
+
+SimSreg::operator uint8_t() const {
+  return irqEnabled ? 0x80 : 0;
+}
+
+SimSreg& SimSreg::operator=(uint8_t sreg) {
+  irqEnabled = sreg & 0x80;
+  runPending();
+  return *this;
+}
+
+SimSreg& simSreg() {
+  static SimSreg sreg;
+  return sreg;
+}
+
+SimTcnt1::operator uint16_t() const {
+  return timer1Counting() ? timer1Cycles() : timer1From;
+}
+
+SimTcnt1& SimTcnt1::operator=(uint16_t count) {
+  timer1From = count;
+  timer1FromUs = clockUs;
+  return *this;
+}
+
+SimTcnt1& simTcnt1() {
+  static SimTcnt1 tcnt1;
+  return tcnt1;
+}
+
+// TOV1 is the overflow interrupt still pending (interrupts off)
+SimTifr1::operator uint8_t() const {
+  return (pending >> VEC_TIMER1_OVF) & 1 ? _BV(TOV1) : 0;
+}
+
+SimTifr1& SimTifr1::operator=(uint8_t clear) {
+  if (clear & _BV(TOV1)) pending &= ~(1u << VEC_TIMER1_OVF);
+  return *this;
+}
+
+SimTifr1& simTifr1() {
+  static SimTifr1 tifr1;
+  return tifr1;
+}
+
+// The caller's frame, near enough: reading SP makes it a call
+uintptr_t simStackPointer() {
+  return (uintptr_t)__builtin_frame_address(0);
+}
+
+void simCli() {
+  irqEnabled = false;
+}
+
+void simSei() {
+  irqEnabled = true;
+  runPending();
+}
+
+uint8_t simIrqSave() {
+  uint8_t state = irqEnabled;
+  irqEnabled = false;
+  return state;
+}
+
+void simIrqRestore(uint8_t state) {
+  irqEnabled = state;
+  runPending();
+}
+
+void set_sleep_mode(int mode) {
+  sleepMode = mode;
+}
+
+// Idle: Timer0 wakes the CPU within a millisecond. Power-down: only a pin
+// change can, so time jumps to the next scripted event.
+void sleep_cpu() {
+  if (isrDepth > 0) return;
+  sleeping = true;
+  woke = false;
+  if (sleepMode == SLEEP_MODE_IDLE) {
+    runTo((clockUs / 1000 + 1) * 1000);
+  } else {
+    poweredDown = true;
+    if (inFirmware) {
+      runTo(UINT64_MAX);       // Until an interrupt; the host gets control at the deadline
+    } else if (!events().empty()) {
+      runTo(events().begin()->first);
+    }
+    poweredDown = false;
+  }
+  sleeping = false;
+}
+
+// ===== Pins =====
+
+uint8_t simPortBBit(uint8_t pin) {
+  return (pin >= 8 && pin <= 11) ? pin - 4 : 0;
+}
+
+// Inputs read high (pull-up) unless a script holds them low
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+  initLevels();
+}
+
+int digitalRead(uint8_t pin) {
+  initLevels();
+  return pin < 32 ? levels[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+  initLevels();
+  if (pin < 32) levels[pin] = level ? HIGH : LOW;
+}
+
+void attachInterrupt(uint8_t pin, void (*fn)(), int mode) {
+  if (pin >= 32) return;
+  extHandler[pin & 7] = fn;
+  extPin[pin & 7] = pin;
+  extMode[pin & 7] = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin < 32) extHandler[pin & 7] = 0;
+}
+
+// ===== Tone, LED =====
+
+void tone(uint8_t pin, unsigned int freq, unsigned long durationMs) {
+  (void)pin;
+  Sim::tones().push_back({clockUs, (uint16_t)freq, (uint32_t)durationMs});
+}
+
+void noTone(uint8_t pin) {
+  (void)pin;
+  Sim::tones().push_back({clockUs, 0, 0});
+}
+
+void Adafruit_NeoPixel::show() {
+  ledShown = color;
+  ledShowCount++;
+  spend(30);                  // 24 bits at 800kHz, interrupts off
+}
+
+// ===== Print and Serial =====
+
+size_t Print::write(const uint8_t* data, size_t len) {
+  size_t n = 0;
+  while (len--) n += write(*data++);
+  return n;
+}
+
+size_t Print::print(const char* s) {
+  return write((const uint8_t*)s, strlen(s));
+}
+
+size_t Print::print(long v, int base) {
+  if (v < 0 && base == DEC) return print('-') + print((unsigned long)-v, base);
+  return print((unsigned long)v, base);
+}
+
+size_t Print::print(unsigned long v, int base) {
+  char buf[8 * sizeof(long) + 1];
+  char* p = buf + sizeof(buf) - 1;
+  *p = '\0';
+  if (base < 2) base = 10;
+  do {
+    uint8_t d = v % base;
+    *--p = d < 10 ? '0' + d : 'A' + d - 10;
+    v /= base;
+  } while (v);
+  return print(p);
+}
+
+size_t Print::print(double v, int digits) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.*f", digits, v);
+  return print(buf);
+}
+
+Serial_ Serial;
+USBDevice_ USBDevice;
+
+bool USBDevice_::configured() {
+  return usbConfigured;
+}
+
+int Serial_::available() {
+  return serialIn().size();
+}
+
+int Serial_::read() {
+  if (serialIn().empty()) return -1;
+  uint8_t c = serialIn().front();
+  serialIn().pop_front();
+  return c;
+}
+
+int Serial_::peek() {
+  return serialIn().empty() ? -1 : serialIn().front();
+}
+
+int Serial_::availableForWrite() {
+  return usbConfigured ? 63 : 0;
+}
+
+size_t Serial_::write(uint8_t c) {
+  if (!usbConfigured) return 0;
+  Sim::serialOutput().push_back((char)c);
+  return 1;
+}
+
+Serial_::operator bool() {
+  return usbConfigured;
+}
+
+// ===== Keyboard, HID =====
+
+// The Keyboard library's US layout: ASCII to usage ID, 0x80 = shift
+const uint8_t KeyboardLayout_en_US[128] = {
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x2A, 0x2B, 0x28, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x2C, 0x9E, 0xB4, 0xA0, 0xA1, 0xA2, 0xA4, 0x34,
+  0xA6, 0xA7, 0xA5, 0xAE, 0x36, 0x2D, 0x37, 0x38,
+  0x27, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24,
+  0x25, 0x26, 0xB3, 0x33, 0xB6, 0x2E, 0xB7, 0xB8,
+  0x9F, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A,
+  0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90, 0x91, 0x92,
+  0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A,
+  0x9B, 0x9C, 0x9D, 0x2F, 0x31, 0x30, 0xA3, 0xAD,
+  0x35, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A,
+  0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12,
+  0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A,
+  0x1B, 0x1C, 0x1D, 0xAF, 0xB1, 0xB0, 0xB5, 0x00,
+};
+Keyboard_ Keyboard;
+
+// One-bank interrupt endpoint: a report waits there for the host's next
+// 1ms poll, and SendReport() blocks while the previous one is still in it
+static uint64_t hidBankFreeUs = 0;
+
+int HID_::SendReport(uint8_t id, const void* data, int len) {
+  if (clockUs < hidBankFreeUs) spend(hidBankFreeUs - clockUs);
+  Sim::HidReport r;
+  r.us = clockUs;
+  r.id = id;
+  memset(r.data, 0, sizeof(r.data));
+  memcpy(r.data, data, len < 8 ? len : 8);
+  Sim::hidReports().push_back(r);
+  hidBankFreeUs = (clockUs / 1000 + 1) * 1000;
+  spend(20);                  // Copy into the endpoint
+  return len;
+}
+
+HID_& HID() {
+  static HID_ hid;
+  return hid;
+}
+
+static uint8_t asciiToUsage(uint8_t c) {
+  return c < 128 ? KeyboardLayout_en_US[c] : 0;
+}
+
+size_t Keyboard_::press(uint8_t k) {
+  if (k >= 0x88) {
+    k -= 0x88;
+  } else if (k >= 0x80) {
+    report[0] |= 1 << (k - 0x80);
+    k = 0;
+  } else {
+    k = asciiToUsage(k);
+    if (k & 0x80) report[0] |= 0x02;
+    k &= 0x7F;
+  }
+  if (k) {
+    for (int i = 2; i < 8; i++) {
+      if (report[i] == k) break;
+      if (!report[i]) { report[i] = k; break; }
+    }
+  }
+  send();
+  return 1;
+}
+
+size_t Keyboard_::release(uint8_t k) {
+  if (k >= 0x88) {
+    k -= 0x88;
+  } else if (k >= 0x80) {
+    report[0] &= ~(1 << (k - 0x80));
+    k = 0;
+  } else {
+    k = asciiToUsage(k);
+    if (k & 0x80) report[0] &= ~0x02;
+    k &= 0x7F;
+  }
+  for (int i = 2; k && i < 8; i++) {
+    if (report[i] == k) report[i] = 0;
+  }
+  send();
+  return 1;
+}
+
+void Keyboard_::releaseAll() {
+  memset(report, 0, sizeof(report));
+  send();
+}
+
+size_t Keyboard_::write(uint8_t c) {
+  press(c);
+  release(c);
+  return 1;
+}
+
+void Keyboard_::send() {
+  HID().SendReport(2, report, sizeof(report));
+}
+
+// ===== EEPROM =====
+
+EEPROMClass EEPROM;
+
+uint8_t EEPROMClass::read(int addr) {
+  initEeprom();
+  return eepromData[addr & E2END];
+}
+
+void EEPROMClass::write(int addr, uint8_t value) {
+  initEeprom();
+  if (clockUs < eepromBusyUntil) spend(eepromBusyUntil - clockUs);
+  eepromData[addr & E2END] = value;
+  eepromBusyUntil = clockUs + 3400;
+}
+
+void EEPROMClass::update(int addr, uint8_t value) {
+  if (read(addr) != value) write(addr, value);
+}
+
+int eeprom_is_ready() {
+  spend(readCost);
+  return clockUs >= eepromBusyUntil;
+}
+
+// ===== TWI =====
+
+TwoWire Wire;
+
+void TwoWire::begin() {
+  twi_init();
+}
+
+void TwoWire::end() {
+  twi_disable();
+}
+
+void TwoWire::setClock(uint32_t hz) {
+  twi_setFrequency(hz);
+}
+
+uint8_t simTcnt0() {
+  return clockUs / 4;
+}
+
+volatile uint8_t& simTwsr() {
+  spend(readCost);
+  twsr = clockUs >= busBusyUntil ? 0xF8 : 0x08;
+  return twsr;
+}
+
+volatile uint8_t& simTwcr() {
+  spend(readCost);
+  twcr = _BV(TWEN) | _BV(TWIE) | _BV(TWEA);
+  return twcr;
+}
+
+extern "C" {
+  void twi_init(void) {
+    busBusyUntil = 0;
+  }
+
+  void twi_disable(void) {}
+
+  void twi_setFrequency(uint32_t hz) {
+    if (hz) twiClock = hz;
+  }
+
+  // 0 ok, 2 address NACK
+  uint8_t twi_writeTo(uint8_t addr, uint8_t* data, uint8_t len, uint8_t wait, uint8_t sendStop) {
+    (void)sendStop;
+    waitBus();
+    Sim::Device* dev = devices[addr & 0x7F];
+    addrBytes[addr & 0x7F] += len + 1;
+    uint64_t busy = byteTimeUs(dev ? len + 1 : 1);
+    if (dev) dev->write(data, len);
+    if (wait) {
+      spend(busy);
+    } else {
+      busBusyUntil = clockUs + busy;
+    }
+    return dev ? 0 : 2;
+  }
+
+  uint8_t twi_readFrom(uint8_t addr, uint8_t* data, uint8_t len, uint8_t sendStop) {
+    (void)sendStop;
+    waitBus();
+    Sim::Device* dev = devices[addr & 0x7F];
+    addrBytes[addr & 0x7F] += len + 1;
+    if (!dev) {
+      spend(byteTimeUs(1));
+      return 0;
+    }
+    dev->read(data, len);
+    spend(byteTimeUs(len + 1));
+    return len;
+  }
+}
+
+// ===== Control API =====
+
+namespace Sim {
+  uint64_t now() {
+    return clockUs;
+  }
+
+  void advance(uint64_t us) {
+    runTo(clockUs + us);
+  }
+
+  void setReadCost(uint32_t us) {
+    readCost = us;
+  }
+
+  void setLoopCost(uint32_t us) {
+    loopCost = us;
+  }
+
+  void run(uint64_t us) {
+    initLevels();
+    deadline = clockUs + us;
+    if (!fwStarted) {
+      static char stack[1 << 20];
+      getcontext(&fwCtx);
+      fwCtx.uc_stack.ss_sp = stack;
+      fwCtx.uc_stack.ss_size = sizeof(stack);
+      __brkval = stack;
+      fwCtx.uc_link = &hostCtx;
+      makecontext(&fwCtx, firmwareMain, 0);
+      fwStarted = true;
+    }
+    inFirmware = true;
+    swapcontext(&hostCtx, &fwCtx);
+    inFirmware = false;
+  }
+
+  uint64_t loopCount() {
+    return loops;
+  }
+
+  void at(uint64_t atUs, std::function<void()> fn) {
+    events().insert(std::make_pair(atUs, fn));
+  }
+
+  void setPin(uint8_t pin, uint8_t level) {
+    initLevels();
+    if (pin >= 32) return;
+    level = level ? HIGH : LOW;
+    uint8_t old = levels[pin];
+    levels[pin] = level;
+    if (old == level) return;
+
+    uint8_t bit = simPortBBit(pin);
+    if (bit) {
+      if (level) PINB |= _BV(bit);
+      else PINB &= ~_BV(bit);
+      if ((PCICR & _BV(PCIE0)) && (PCMSK0 & _BV(bit))) raise(VEC_PCINT0);
+    }
+
+    uint8_t slot = pin & 7;
+    if (extHandler[slot] && extPin[slot] == pin) {
+      int mode = extMode[slot];
+      if (mode == CHANGE || (mode == FALLING && !level) || (mode == RISING && level)) {
+        raise(VEC_EXT + slot);
+      }
+    }
+  }
+
+  uint8_t pinLevel(uint8_t pin) {
+    initLevels();
+    return pin < 32 ? levels[pin] : LOW;
+  }
+
+  void press(uint8_t pin) {
+    setPin(pin, LOW);
+  }
+
+  void release(uint8_t pin) {
+    setPin(pin, HIGH);
+  }
+
+  void click(uint8_t pin, uint32_t holdMs) {
+    press(pin);
+    at(clockUs + holdMs * 1000ULL, [pin]() { release(pin); });
+  }
+
+  void setUsbConfigured(bool configured) {
+    usbConfigured = configured;
+  }
+
+  void serialInput(const std::string& bytes) {
+    serialInput((const uint8_t*)bytes.data(), bytes.size());
+  }
+
+  void serialInput(const uint8_t* data, size_t len) {
+    serialIn().insert(serialIn().end(), data, data + len);
+  }
+
+  std::string& serialOutput() {
+    static std::string out;
+    return out;
+  }
+
+  std::vector<HidReport>& hidReports() {
+    static std::vector<HidReport> reports;
+    return reports;
+  }
+
+  std::vector<ToneEvent>& tones() {
+    static std::vector<ToneEvent> log;
+    return log;
+  }
+
+  uint32_t ledColor() {
+    return ledShown;
+  }
+
+  uint32_t ledShows() {
+    return ledShowCount;
+  }
+
+  uint8_t* eeprom() {
+    initEeprom();
+    return eepromData;
+  }
+
+  void attach(uint8_t addr, Device* dev) {
+    devices[addr & 0x7F] = dev;
+  }
+
+  Device* device(uint8_t addr) {
+    return devices[addr & 0x7F];
+  }
+
+  uint32_t busBytes(uint8_t addr) {
+    return addrBytes[addr & 0x7F];
+  }
+
+  uint32_t busClock() {
+    return twiClock;
+  }
+}
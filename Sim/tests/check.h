@@ -0,0 +1,46 @@
+/*
+ * Minimal checks for the simulator tests - a failed CHECK prints the
+ * expression and location and makes the test exit non-zero
+ */
+
+#pragma once
+#include <stdio.h>
+
+static int checkFailures = 0;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      checkFailures++; \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+    } \
+  } while (0)
+
+#define CHECK_EQ(a, b) \
+  do { \
+    long long va_ = (long long)(a), vb_ = (long long)(b); \
+    if (va_ != vb_) { \
+      checkFailures++; \
+      fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", \
+              __FILE__, __LINE__, #a, #b, va_, vb_); \
+    } \
+  } while (0)
+
+#define CHECK_LE(a, b) \
+  do { \
+    long long va_ = (long long)(a), vb_ = (long long)(b); \
+    if (va_ > vb_) { \
+      checkFailures++; \
+      fprintf(stderr, "%s:%d: CHECK_LE(%s, %s) failed: %lld > %lld\n", \
+              __FILE__, __LINE__, #a, #b, va_, vb_); \
+    } \
+  } while (0)
+
+static int checkResult(const char* name) {
+  if (checkFailures) {
+    fprintf(stderr, "%s: %d check(s) failed\n", name, checkFailures);
+    return 1;
+  }
+  printf("%s: ok\n", name);
+  return 0;
+}
@@ -0,0 +1,68 @@
+/*
+ * BadUSB pacing: the Browser script's key combos are held for
+ * BADUSB_KEYS_HOLD_MS, and its STRING goes out at BADUSB_REPORTS_PER_TICK
+ * reports per scheduler tick, never two in one USB frame
+ */
+
+#include "../../Mauther/Mauther.ino"
+#include "sim.h"
+#include "check.h"
+#include <string.h>
+
+static const char url[] = "https://www.youtube.com/watch?v=e-xoYTHebs8&autoplay=1&mute=1";
+
+static bool allUp(const Sim::HidReport& r) {
+  for (uint8_t i = 0; i < 8; i++) {
+    if (r.data[i]) return false;
+  }
+  return true;
+}
+
+int main() {
+  Sim::runMs(1000);
+  Sim::hidReports().clear();
+  BadUSB::run(0);   // Browser (macOS): GUI SPACE, STRING url, ENTER
+  Sim::runMs(5000);
+  CHECK(!BadUSB::isRunning);
+
+  const std::vector<Sim::HidReport>& hid = Sim::hidReports();
+  const uint64_t holdUs = (BADUSB_KEYS_HOLD_MS - 1) * 1000UL;   // Timer counts whole millis()
+  CHECK(hid.size() > 4);
+  if (hid.size() <= 4) return checkResult("test_badusb");
+
+  // GUI SPACE, held, then all up
+  CHECK_EQ(hid[0].data[0], 0x08);
+  CHECK_EQ(hid[0].data[2], 0x2C);
+  CHECK(allUp(hid[1]));
+  CHECK(hid[1].us - hid[0].us >= holdUs);
+
+  // ENTER, held, then all up; the script end releases everything again
+  size_t enter = 2;
+  while (enter < hid.size() - 1 && hid[enter].data[2] != 0x28) enter++;
+  CHECK(enter < hid.size() - 1);
+  CHECK(allUp(hid[enter + 1]));
+  CHECK(hid[enter + 1].us - hid[enter].us >= holdUs);
+
+  // The STRING: every report between the two combos, ending all up
+  size_t first = 2, last = enter - 1;
+  CHECK(allUp(hid[last]));
+
+  size_t keys = 0;
+  for (size_t i = first; i <= last; i++) {
+    for (uint8_t k = 2; k < 8; k++) keys += hid[i].data[k] != 0;
+    if (i > first) CHECK(hid[i].us / 1000 != hid[i - 1].us / 1000);  // One per USB frame
+  }
+  CHECK_EQ(keys, strlen(url));
+  CHECK_EQ(BadUSB::statChars, strlen(url));
+
+  // Reports per tick: a STRING of n reports takes about n / REPORTS_PER_TICK
+  // ticks (plus one for the partial last tick)
+  size_t reports = last - first + 1;
+  uint64_t spanUs = hid[last].us - hid[first].us;
+  uint64_t boundUs = (reports / BADUSB_REPORTS_PER_TICK + 1) * SCHED_TICK_MS * 1000UL;
+  printf("%zu reports for %zu characters in %llu us (bound %llu us)\n", reports, keys,
+         (unsigned long long)spanUs, (unsigned long long)boundUs);
+  CHECK_LE(spanUs, boundUs);
+
+  return checkResult("test_badusb");
+}
@@ -0,0 +1,66 @@
+/*
+ * BENCH_MODE suite on the simulated watch: every scenario reports, and
+ * the numbers come from simulated time, so two runs of the same tree
+ * print the same lines. With SIM_BENCH set the serial log is written
+ * there; make test checks it against Sim/bench_baseline.json and
+ * Tools/bench_limits.json with Tools/bench_report.py.
+ *
+ * cycles are 16 per simulated microsecond: bus waits, delays, clock reads
+ * and LED shows, not the CPU time of the code itself. stack and free are
+ * host stack bytes on the firmware's own stack.
+ */
+
+#define BENCH_MODE
+#include "../../Mauther/Mauther.ino"
+#include "sim.h"
+#include "check.h"
+#include <stdlib.h>
+
+static const char* const scenarios[] = {
+  "face_full", "face_second", "face_minute", "face_info", "face_idle", "menu",
+  "buttons_tick", "led_render", "alarm", "loop_idle", "loop_all"
+};
+
+// The field after "BENCH name=<name> ", -1 if the line is missing
+static long field(const std::string& out, const char* name, const char* key) {
+  std::string line = std::string("BENCH name=") + name + " ";
+  size_t at = out.find(line);
+  if (at == std::string::npos) return -1;
+  size_t end = out.find('\n', at);
+  size_t k = out.find(std::string(" ") + key + "=", at);
+  if (k == std::string::npos || k > end) return -1;
+  return strtol(out.c_str() + k + strlen(key) + 2, 0, 10);
+}
+
+int main() {
+  const std::string& out = Sim::serialOutput();
+  while (out.find("BENCH done") == std::string::npos && Sim::now() < 20000000ULL) Sim::runMs(100);
+  CHECK(out.find("BENCH done") != std::string::npos);
+
+  for (const char* name : scenarios) {
+    long cycles = field(out, name, "cycles"), max = field(out, name, "max");
+    CHECK(cycles >= 0);
+    CHECK_LE(cycles, max);
+    CHECK(field(out, name, "stack") > 0);
+  }
+  // Nothing changed on the face: nothing goes out on the bus
+  CHECK_EQ(field(out, "face_idle", "i2c"), 0);
+  // A full frame is the whole 128x64 panel at least
+  CHECK(field(out, "face_full", "i2c") >= 1024);
+
+  size_t first = out.find("BENCH ");
+  size_t last = out.find("BENCH done");
+  if (first != std::string::npos && last != std::string::npos) {
+    printf("%s", out.substr(first, last - first).c_str());
+  }
+  if (const char* path = getenv("SIM_BENCH")) {
+    FILE* f = fopen(path, "w");
+    CHECK(f != 0);
+    if (f) {
+      fwrite(out.data(), 1, out.size(), f);
+      fclose(f);
+    }
+  }
+
+  return checkResult("test_bench");
+}
@@ -0,0 +1,105 @@
+/*
+ * Buzzer sequencer on the simulated clock: every note of each PROGMEM
+ * melody starts within a tick of its schedule, and a tone that starts late
+ * is shortened so it still ends on time. A busy task delays the ticks;
+ * over many rounds of a looped melody the lateness never adds up.
+ */
+
+#include "../../Mauther/scheduler.h"
+#include "../../Mauther/actuators.h"
+#include "sim.h"
+#include "check.h"
+
+// Runs just before the sequencer each tick and holds the loop for 0 to
+// 3.3ms, so notes start late by varying amounts
+uint8_t busyTurn = 0;
+
+void busy() {
+  delayMicroseconds(300 * (busyTurn++ % 12));
+}
+
+void setup() {
+  Actuators::begin();
+  Scheduler::add(busy, SCHED_TICK_MS, 5000);
+  Scheduler::add(Actuators::update, SCHED_TICK_MS, 500);
+}
+
+void loop() {
+  Scheduler::run();
+}
+
+static size_t played() {
+  return Sim::tones().size();
+}
+
+// Check the tones logged from index first against m started at startMs,
+// rounds times over. Returns the index after the last note checked.
+static size_t checkMelody(const Actuators::Note* m, unsigned long startMs, uint8_t rounds,
+                          size_t first, const char* name) {
+  const std::vector<Sim::ToneEvent>& log = Sim::tones();
+  unsigned long sched = startMs;
+  size_t at = first;
+  unsigned long worstLateUs = 0;
+  uint16_t shortened = 0;
+  for (uint8_t r = 0; r < rounds; r++) {
+    for (const Actuators::Note* n = m; pgm_read_word(&n->ms); n++) {
+      uint16_t freq = pgm_read_word(&n->freq), ms = pgm_read_word(&n->ms);
+      CHECK(at < log.size());
+      if (at >= log.size()) return at;
+      const Sim::ToneEvent& e = log[at++];
+
+      // Starts within a tick (plus the busy task) of its schedule
+      CHECK(e.us >= sched * 1000ULL);
+      unsigned long lateUs = e.us - sched * 1000ULL;
+      CHECK_LE(lateUs, (SCHED_TICK_MS + 4) * 1000UL);
+      if (lateUs > worstLateUs) worstLateUs = lateUs;
+
+      CHECK_EQ(e.freq, freq);
+      // The tone ends when the note is due to end, whatever it started
+      if (freq) CHECK_EQ(e.us / 1000 + e.ms, sched + ms);
+      shortened += freq && e.ms < ms;
+      sched += ms;
+    }
+  }
+  printf("%s: %u round(s), latest note %lu us behind its schedule, %u tone(s) shortened\n",
+         name, rounds, worstLateUs, shortened);
+  return at;
+}
+
+int main() {
+  Sim::runMs(100);
+
+  // One-shot melodies end with noTone() at the end of the last note
+  const Actuators::Note* once[] = {Actuators::melodyBoot, Actuators::melodyChirp};
+  const char* onceNames[] = {"boot", "chirp"};
+  for (uint8_t i = 0; i < 2; i++) {
+    size_t first = played();
+    unsigned long start = millis();
+    Actuators::play(once[i]);
+    Sim::runMs(500);
+    CHECK(!Actuators::isPlaying(once[i]));
+    size_t end = checkMelody(once[i], start, 1, first, onceNames[i]);
+    CHECK_EQ(played(), end + 1);
+    if (end < played()) CHECK_EQ(Sim::tones()[end].freq, 0);
+  }
+
+  // Looped alarms: note n of round r still starts on its schedule after
+  // many rounds
+  const Actuators::Note* looped[] = {Actuators::melodyAlarm, Actuators::melodyAlarmFast};
+  const char* loopedNames[] = {"alarm", "alarm fast"};
+  for (uint8_t i = 0; i < 2; i++) {
+    unsigned long roundMs = 0;
+    for (const Actuators::Note* n = looped[i]; pgm_read_word(&n->ms); n++) roundMs += pgm_read_word(&n->ms);
+    const uint8_t rounds = 40;
+    size_t first = played();
+    unsigned long start = millis();
+    Actuators::play(looped[i], true);
+    Sim::runMs(rounds * roundMs - roundMs / 2);
+    CHECK(Actuators::isPlaying(looped[i]));
+    checkMelody(looped[i], start, rounds, first, loopedNames[i]);
+    Actuators::stopSound();
+    Sim::runMs(100);
+  }
+
+  return checkResult("test_buzzer");
+}
@@ -0,0 +1,208 @@
+/*
+ * Control protocol framing: requests COBS encoded on the host side come
+ * back as CRC-checked responses, with payloads full of 0x00 bytes and at
+ * the longest frame the receive buffer takes; one byte more is dropped.
+ * Telemetry lists the button events since the previous frame, at most
+ * BUTTON_TRACE_SIZE of them, and flags the ones that did not fit.
+ */
+
+#define FEATURE_CONSOLE
+#include "../../Mauther/Mauther.ino"
+#include "sim.h"
+#include "check.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+// Independent of control.h: general COBS (0xFF blocks included) and a
+// bitwise CRC-16/CCITT as _crc_ccitt_update computes it
+static uint16_t crcCcitt(const Bytes& data) {
+  uint16_t crc = 0xFFFF;
+  for (uint8_t d : data) {
+    d ^= crc & 0xFF;
+    d ^= d << 4;
+    crc = (((uint16_t)d << 8) | (crc >> 8)) ^ (d >> 4) ^ ((uint16_t)d << 3);
+  }
+  return crc;
+}
+
+static Bytes cobsEncode(const Bytes& data) {
+  Bytes out(1, 0);
+  size_t code = 0;
+  for (uint8_t b : data) {
+    if (b == 0) {
+      out[code] = out.size() - code;
+      code = out.size();
+      out.push_back(0);
+    } else {
+      out.push_back(b);
+      if (out.size() - code == 0xFF) {
+        out[code] = 0xFF;
+        code = out.size();
+        out.push_back(0);
+      }
+    }
+  }
+  out[code] = out.size() - code;
+  return out;
+}
+
+static bool cobsDecode(const Bytes& in, Bytes& out) {
+  out.clear();
+  size_t i = 0;
+  while (i < in.size()) {
+    uint8_t code = in[i];
+    if (code == 0 || i + code > in.size()) return false;
+    out.insert(out.end(), in.begin() + i + 1, in.begin() + i + code);
+    i += code;
+    if (code < 0xFF && i < in.size()) out.push_back(0);
+  }
+  return true;
+}
+
+// 0x00, COBS(type, payload, CRC), 0x00 - the encoded part is returned too
+static Bytes frame(uint8_t type, const Bytes& payload, size_t* encodedLen = nullptr) {
+  Bytes body(1, type);
+  body.insert(body.end(), payload.begin(), payload.end());
+  uint16_t crc = crcCcitt(body);
+  body.push_back(crc);
+  body.push_back(crc >> 8);
+  Bytes enc = cobsEncode(body);
+  if (encodedLen) *encodedLen = enc.size();
+  enc.insert(enc.begin(), 0);
+  enc.push_back(0);
+  return enc;
+}
+
+// Every frame in the serial output, decoded and without the CRC; a frame
+// that fails to decode or whose CRC is wrong fails the test
+static std::vector<Bytes> frames() {
+  std::vector<Bytes> result;
+  const std::string& out = Sim::serialOutput();
+  size_t i = 0;
+  while ((i = out.find('\0', i)) != std::string::npos) {
+    size_t end = out.find('\0', i + 1);
+    if (end == std::string::npos) break;
+    if (end == i + 1) {           // Back-to-back delimiters
+      i = end;
+      continue;
+    }
+    Bytes enc(out.begin() + i + 1, out.begin() + end), body;
+    bool ok = cobsDecode(enc, body) && body.size() >= 3;
+    if (ok) {
+      uint16_t crc = body[body.size() - 2] | (body[body.size() - 1] << 8);
+      body.resize(body.size() - 2);
+      ok = crc == crcCcitt(body);
+    }
+    CHECK(ok);
+    if (ok) result.push_back(body);
+    i = end + 1;
+  }
+  return result;
+}
+
+static std::vector<Bytes> request(const Bytes& wire) {
+  Sim::serialOutput().clear();
+  Sim::serialInput(wire.data(), wire.size());
+  Sim::runMs(50);
+  return frames();
+}
+
+// One response to type with the given status
+static bool answered(const std::vector<Bytes>& got, uint8_t type, uint8_t status) {
+  return got.size() == 1 && got[0].size() >= 2 && got[0][0] == (type | 0x80) && got[0][1] == status;
+}
+
+int main() {
+  Sim::runMs(1000);
+
+  std::vector<Bytes> got = request(frame(Control::MSG_PING, {}));
+  CHECK(answered(got, Control::MSG_PING, Control::ST_OK));
+  if (!got.empty() && got[0].size() > 2) CHECK_EQ(got[0][2], CONTROL_PROTOCOL_VERSION);
+
+  // 0x00-dense requests: every byte after the type is zero
+  got = request(frame(Control::MSG_SET_TIME, Bytes(7, 0)));
+  CHECK(answered(got, Control::MSG_SET_TIME, Control::ST_BAD_VALUE));
+  got = request(frame(Control::MSG_GET_SETTING, Bytes(1, 0)));
+  CHECK(answered(got, Control::MSG_GET_SETTING, Control::ST_OK));
+  got = request(frame(Control::MSG_SET_SETTING, Bytes(3, 0)));
+  CHECK(answered(got, Control::MSG_SET_SETTING, Control::ST_OK));
+  if (!got.empty() && got[0].size() == 5) {
+    int16_t value = got[0][3] | (got[0][4] << 8);
+    CHECK_EQ(value, Settings::getMin(0));   // 0 clamped into range
+  }
+
+  // Zero payloads of every length up to the longest frame rx holds: the
+  // decoded frame is CONTROL_FRAME_MAX bytes, COBS adds one
+  const size_t maxPayload = CONTROL_FRAME_MAX - 3;
+  for (size_t len = 0; len <= maxPayload; len++) {
+    size_t encoded;
+    Bytes wire = frame(0x7F, Bytes(len, 0), &encoded);
+    got = request(wire);
+    CHECK(answered(got, 0x7F, Control::ST_UNKNOWN_TYPE));
+    if (len == maxPayload) CHECK_EQ(encoded, sizeof(Control::rx));
+  }
+
+  // Longest frame with no zero bytes at all: a single COBS code byte
+  Bytes dense(maxPayload, 0xA5);
+  got = request(frame(0x7F, dense));
+  CHECK(answered(got, 0x7F, Control::ST_UNKNOWN_TYPE));
+
+  // One byte longer: dropped without a reply, and the next frame still works
+  uint16_t bad = Control::badFrames;
+  got = request(frame(0x7F, Bytes(maxPayload + 1, 0)));
+  CHECK(got.empty());
+  CHECK_EQ(Control::badFrames, bad + 1);
+  got = request(frame(Control::MSG_PING, {}));
+  CHECK(answered(got, Control::MSG_PING, Control::ST_OK));
+
+  // Telemetry every 2s; the first frame comes right away
+  got = request(frame(Control::MSG_TELEMETRY, {0xD0, 0x07}));
+  CHECK_EQ(got.size(), 2);
+
+  // Three clicks (6 events) in one period: listed oldest first
+  Sim::serialOutput().clear();
+  Sim::serialInput("uds");
+  Sim::runMs(2000);
+  got = frames();
+  CHECK_EQ(got.size(), 1);
+  if (got.size() == 1 && got[0].size() >= 12) {
+    const Bytes& t = got[0];
+    CHECK_EQ(t[0], Control::MSG_TELEMETRY_DATA);
+    CHECK_EQ(t[11], 6);
+    CHECK_EQ(t.size(), 12 + 6);
+    const uint8_t want[] = {0x11, 0x12, 0x21, 0x22, 0x31, 0x32};   // button << 4 | type
+    for (size_t i = 0; i < 6 && 12 + i < t.size(); i++) CHECK_EQ(t[12 + i], want[i]);
+  }
+
+  // Five clicks (10 events): the first BUTTON_TRACE_SIZE and the lost flag
+  Sim::serialOutput().clear();
+  Sim::serialInput("ududu");
+  Sim::runMs(2000);
+  got = frames();
+  CHECK_EQ(got.size(), 1);
+  if (got.size() == 1 && got[0].size() >= 12) {
+    const Bytes& t = got[0];
+    CHECK_EQ(t[11], 0x80 | BUTTON_TRACE_SIZE);
+    CHECK_EQ(t.size(), CONTROL_TELEMETRY_MAX - 2);
+    for (size_t i = 0; i < BUTTON_TRACE_SIZE && 12 + i < t.size(); i++) {
+      CHECK_EQ(t[12 + i], ((i / 2 % 2 ? 2 : 1) << 4) | (i % 2 ? 2 : 1));
+    }
+  }
+
+  // Nothing since: an empty list and the flag cleared
+  Sim::serialOutput().clear();
+  Sim::runMs(2000);
+  got = frames();
+  CHECK_EQ(got.size(), 1);
+  if (got.size() == 1) {
+    CHECK_EQ(got[0].size(), 12);
+    if (got[0].size() >= 12) CHECK_EQ(got[0][11], 0);
+  }
+
+  got = request(frame(Control::MSG_TELEMETRY, {0, 0}));
+  Sim::serialOutput().clear();
+  Sim::runMs(3000);
+  CHECK(frames().empty());
+
+  return checkResult("test_control");
+}
@@ -0,0 +1,81 @@
+/*
+ * Debug screen (FEATURE_PROFILER): after the profiler sections comes a
+ * page of counters kept since boot, showing the same figures the modules
+ * hold. A stalled loop() shows up there as dropped sensor samples.
+ */
+
+#define FEATURE_PROFILER
+#include "../../Mauther/Mauther.ino"
+#include "sim.h"
+#include "check.h"
+
+static void click(uint8_t pin, uint32_t holdMs = 80) {
+  Sim::click(pin, holdMs);
+  Sim::runMs(holdMs + 150);
+}
+
+// Frame and skip counts as the screen in view read them for its next frame
+static unsigned long drawnAt, skippedAt;
+
+// Run until the next frame of the screen in view is drawn, then until all
+// of it is on the panel: its lower pages are still on the bus for a while
+static void nextFrame() {
+  unsigned long drawn = View::getFramesDrawn();
+  uint64_t until = Sim::now() + 2000000;
+  while (View::getFramesDrawn() == drawn && Sim::now() < until) Sim::run(500);
+  drawnAt = View::getFramesDrawn();
+  skippedAt = View::getFramesSkipped();   // Menu runs every 10ms: not again yet
+  Sim::runMs(100);
+}
+
+int main() {
+  Sim::setDistance(700);
+  Sim::runMs(2000);
+
+  // Long press UP on the face opens the debug screen; UP from the first
+  // section wraps round to the counters
+  click(PIN_BUTTON_UP, 1000);
+  click(PIN_BUTTON_UP);
+  uint16_t bytes = Display::getLastFrameBytes();   // The page reports the frame before it
+  uint16_t shows = Actuators::getShowCount();
+  nextFrame();
+  CHECK(Sim::displayShows("Counters"));
+
+  char line[32];
+  snprintf(line, sizeof(line), "Frm %lu/%lu", drawnAt, skippedAt);
+  CHECK(Sim::displayShows(line));
+  CHECK(skippedAt > drawnAt);   // Most Menu passes draw nothing
+  snprintf(line, sizeof(line), "Last frame %uB", bytes);
+  CHECK(Sim::displayShows(line));
+  CHECK(bytes > 0);
+  printf("counters page: %s\n", line);
+
+  // Every show() but the one in begin() is counted; the modelled pixel
+  // holds interrupts off for 30us, plus the time to read the clock. The
+  // LED keeps changing, so the page shows a count from while it was drawn.
+  CHECK(shows > 0);
+  CHECK_EQ(Actuators::getShowCount() + 1, Sim::ledShows());
+  CHECK(Actuators::getIrqOffMaxUs() >= 30 && Actuators::getIrqOffMaxUs() <= 34);
+  bool shown = false;
+  for (uint16_t n = shows; n <= Actuators::getShowCount() && !shown; n++) {
+    snprintf(line, sizeof(line), "LED %ux max %uus", n, Actuators::getIrqOffMaxUs());
+    shown = Sim::displayShows(line);
+  }
+  CHECK(shown);
+  printf("counters page: %s\n", line);
+
+  // Stall loop() for 150ms a pass - about 4 sensor periods - for 2s: the
+  // sensor overwrites its results meanwhile and those count as dropped
+  unsigned long dropped = Sensors::getDroppedSamples();
+  Sim::setLoopCost(150000);
+  Sim::runMs(2000);
+  Sim::setLoopCost(20);
+  unsigned long stalled = Sensors::getDroppedSamples() - dropped;
+  CHECK(stalled >= 2000 / 150 * 3);   // At least 3 of every 4
+  nextFrame();
+  snprintf(line, sizeof(line), "Dropped %lu", Sensors::getDroppedSamples());
+  CHECK(Sim::displayShows(line));
+  printf("counters page: %s (%lu before the stall)\n", line, dropped);
+
+  return checkResult("test_debug");
+}
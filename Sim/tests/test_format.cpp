@@ -0,0 +1,73 @@
+/*
+ * Number formatting: every format.h formatter prints what the snprintf
+ * call it replaced printed, over the whole range of its argument, and the
+ * FORMAT_BENCHMARK run (float "%.1fC" reference included) reports a line
+ * per formatter
+ */
+
+#define FORMAT_BENCHMARK
+#include "../../Mauther/format.h"
+#include "sim.h"
+#include "check.h"
+#include <string.h>
+
+static bool same(const char* got, const char* want, const char* what, long v) {
+  if (strcmp(got, want) == 0) return true;
+  fprintf(stderr, "%s(%ld): \"%s\", snprintf \"%s\"\n", what, v, got, want);
+  return false;
+}
+
+int main() {
+  char got[16], want[16];
+  int bad = 0;
+
+  for (long v = 0; v <= 0xFFFF; v++) {
+    Format::putStr(Format::putUInt(got, v), "mm");
+    snprintf(want, sizeof(want), "%ldmm", v);
+    bad += !same(got, want, "putUInt", v);
+    Format::putUInt(got, v, 2);
+    snprintf(want, sizeof(want), "%02ld", v);
+    bad += !same(got, want, "putUInt width 2", v);
+  }
+
+  for (unsigned long v : {0UL, 9UL, 10UL, 65535UL, 65536UL, 999999999UL, 1000000000UL, 4294967295UL}) {
+    Format::putULong(got, v);
+    snprintf(want, sizeof(want), "%lu", v);
+    bad += !same(got, want, "putULong", v);
+  }
+
+  for (long v = -32768; v <= 32767; v++) {
+    Format::putInt(got, v);
+    snprintf(want, sizeof(want), "%ld", v);
+    bad += !same(got, want, "putInt", v);
+    if (v == -32768) continue;   // -v does not fit, like on the watch
+    Format::putTenths(got, v);
+    snprintf(want, sizeof(want), "%.1f", v / 10.0);
+    bad += !same(got, want, "putTenths", v);
+  }
+
+  // DS3231 range, -128 to +127.75 degrees. "%.1f" rounds the x.25/x.75
+  // ties to even; putQuarters rounds them away from zero on purpose.
+  for (long q = -512; q <= 511; q++) {
+    Format::putChar(Format::putQuarters(got, q), 'C');
+    double away = (q % 2) ? 0.001 * (q < 0 ? -1 : 1) : 0;
+    snprintf(want, sizeof(want), "%.1fC", q / 4.0 + away);
+    bad += !same(got, want, "putQuarters", q);
+  }
+  CHECK_EQ(bad, 0);
+
+  Format::putQuarters(got, 101);
+  CHECK(strcmp(got, "25.3") == 0);
+  Format::putQuarters(got, -101);
+  CHECK(strcmp(got, "-25.3") == 0);
+
+  Sim::serialOutput().clear();
+  Format::benchmark();
+  const std::string& out = Sim::serialOutput();
+  printf("%s", out.c_str());
+  CHECK(out.find("BENCH fmt=distance snprintf=") != std::string::npos);
+  CHECK(out.find("BENCH fmt=temp snprintf=") != std::string::npos);
+  CHECK(out.find("BENCH fmt=time snprintf=") != std::string::npos);
+
+  return checkResult("test_format");
+}
@@ -0,0 +1,104 @@
+/*
+ * I2C engine on the simulated bus: a page row of display writes is queued
+ * without waiting for the wire and goes out back to back from the
+ * completion interrupt while nothing calls service(); a queued high
+ * priority read stops the chain until service() runs it, ahead of the
+ * rest of the row; a write nobody answers reports the NACK to its
+ * callback from service()
+ */
+
+#include "../../Mauther/i2c_bus.h"
+#include "sim.h"
+#include "check.h"
+
+void setup() {
+  I2CBus::begin();
+}
+
+void loop() {}   // Never calls service(): only the interrupt moves the queue
+
+// SH1106 page row as the display queues it: page and column, then 128
+// bytes in U8g2's 24-byte data transfers
+static uint32_t queueRow() {
+  const uint8_t cmd[] = {0x00, 0xB3, 0x10, 0x02};
+  I2CBus::write(OLED_I2C_ADDR, cmd, sizeof(cmd), I2CBus::PRIO_LOW);
+  uint32_t bytes = sizeof(cmd) + 1;
+  uint8_t data[25] = {0x40};
+  for (uint8_t left = 128; left; ) {
+    uint8_t n = left < 24 ? left : 24;
+    memset(data + 1, left, n);
+    I2CBus::write(OLED_I2C_ADDR, data, n + 1, I2CBus::PRIO_LOW);
+    bytes += n + 2;
+    left -= n;
+  }
+  return bytes;
+}
+
+static bool drained() {
+  return !I2CBus::inFlight && !I2CBus::queues[I2CBus::PRIO_HIGH].count &&
+         !I2CBus::queues[I2CBus::PRIO_LOW].count;
+}
+
+static uint8_t readStatus = 0xFF;
+static uint32_t readAtDisplayBytes;
+
+static void onRead(uint8_t status, const uint8_t* data, uint8_t len) {
+  readStatus = status;
+  readAtDisplayBytes = Sim::busBytes(OLED_I2C_ADDR);
+}
+
+static uint8_t writeStatus = 0xFF;
+
+static void onWrite(uint8_t status, const uint8_t* data, uint8_t len) {
+  writeStatus = status;
+}
+
+int main() {
+  Sim::runMs(10);
+  const double byteUs = 9e6 / Sim::busClock();
+
+  // A whole row fits the display queue: queuing it never waits for the bus
+  uint32_t start = Sim::busBytes(OLED_I2C_ADDR);
+  uint64_t t0 = Sim::now();
+  uint32_t bytes = queueRow();
+  CHECK_LE(Sim::now() - t0, 50);
+  CHECK_EQ(I2CBus::queues[I2CBus::PRIO_LOW].count, I2C_LOW_QUEUE_LEN - 1);   // One on the wire
+
+  // ...and goes out back to back with loop() doing nothing
+  while (!drained() && Sim::now() < t0 + 20000) Sim::run(10);
+  uint64_t tookUs = Sim::now() - t0;
+  CHECK(drained());
+  CHECK_EQ(Sim::busBytes(OLED_I2C_ADDR) - start, bytes);
+  CHECK_LE(tookUs, bytes * byteUs * 1.1 + 10 * I2C_LOW_QUEUE_LEN);
+  CHECK_EQ(I2CBus::lastStatus, 0);
+  printf("page row: %u bytes in %llu us (%.0f us on the wire)\n", bytes,
+         (unsigned long long)tookUs, bytes * byteUs);
+
+  // A sensor read queued behind the write on the wire: the interrupt does
+  // not start the rest of the row ahead of it, and service() runs it next
+  start = Sim::busBytes(OLED_I2C_ADDR);
+  bytes = queueRow();
+  I2CBus::readAsync(VL53L0X_ADDR, 0xC0, 1, onRead);
+  Sim::runMs(2);
+  CHECK_EQ(readStatus, 0xFF);
+  CHECK_EQ(I2CBus::queues[I2CBus::PRIO_LOW].count, I2C_LOW_QUEUE_LEN - 1);
+  I2CBus::service();
+  CHECK_EQ(readStatus, 0);
+  CHECK(readAtDisplayBytes - start < bytes);
+  Sim::runMs(10);
+  CHECK(drained());
+  CHECK_EQ(Sim::busBytes(OLED_I2C_ADDR) - start, bytes);
+
+  // No device at 0x50: Wire's NACK status reaches the callback, which
+  // runs from the next service() rather than the interrupt
+  const uint8_t reg = 0;
+  I2CBus::write(0x50, &reg, 1, I2CBus::PRIO_HIGH, onWrite);
+  Sim::runMs(2);
+  CHECK_EQ(writeStatus, 0xFF);
+  I2CBus::service();
+  CHECK_EQ(writeStatus, 2);
+  CHECK_EQ(I2CBus::lastStatus, 2);
+  CHECK(drained());
+
+  return checkResult("test_i2c");
+}
@@ -0,0 +1,101 @@
+/*
+ * Scheduler dispatch latency with CO_* tasks on the simulated clock: long
+ * work split with CO_YIELD keeps every pass short, so a 5ms input task is
+ * never late by more than one pass; the same work done in one go shows up
+ * in the latency figures and as overruns
+ */
+
+#include "../../Mauther/scheduler.h"
+#include "sim.h"
+#include "check.h"
+
+#define CHUNKS    8
+#define CHUNK_US  2000
+#define RENDER_US 3000
+
+// Input: cheap, every tick; records how late each run was
+unsigned long lastInputUs = 0;
+unsigned long worstInputLateUs = 0;
+uint32_t inputRuns = 0;
+
+void input() {
+  unsigned long now = micros();
+  if (inputRuns++ > 0) {
+    unsigned long late = now - lastInputUs - SCHED_TICK_MS * 1000UL;
+    if ((long)late > 0 && late > worstInputLateUs) worstInputLateUs = late;
+  }
+  lastInputUs = now;
+  delayMicroseconds(50);
+}
+
+// Long job: CHUNKS pieces of work, then a pause. With split set it
+// yields between pieces like the firmware's sequences do.
+Continuation jobCo;
+bool split = true;
+uint8_t chunk;
+uint32_t jobsDone = 0;
+
+bool jobStep() {
+  CO_BEGIN(jobCo);
+  for (chunk = 0; chunk < CHUNKS; chunk++) {
+    delayMicroseconds(CHUNK_US);
+    if (split) CO_YIELD(jobCo);
+  }
+  jobsDone++;
+  CO_DELAY(jobCo, 100);
+  CO_END(jobCo);
+}
+
+void job() {
+  jobStep();
+}
+
+void render() {
+  delayMicroseconds(RENDER_US);
+}
+
+int8_t inputId, jobId, renderId;
+
+void setup() {
+  inputId = Scheduler::add(input, SCHED_TICK_MS, 200);
+  jobId = Scheduler::add(job, 10, CHUNK_US + 500);
+  renderId = Scheduler::add(render, 10, RENDER_US + 500);
+}
+
+void loop() {
+  Scheduler::run();
+}
+
+int main() {
+  // Worst pass: every task due at once, plus clock reads
+  const unsigned long passBoundUs = 50 + CHUNK_US + RENDER_US + 200;
+
+  Sim::runMs(10000);
+  CHECK(inputRuns > 10000 / (SCHED_TICK_MS + 1) * 9 / 10);
+  CHECK(jobsDone >= 10000 / (CHUNKS * 10 + 100) * 9 / 10);
+  CHECK_LE(Scheduler::getMaxLatencyUs(), passBoundUs);
+  CHECK_LE(Scheduler::getMaxLatencyUs(), SCHED_LATENCY_BOUND_US);
+  // Dispatch is checked once per millis() tick, hence the extra 1ms
+  CHECK_LE(worstInputLateUs, Scheduler::getMaxLatencyUs() + 1000);
+  CHECK_EQ(Scheduler::tasks[inputId].overruns, 0);
+  CHECK_EQ(Scheduler::tasks[jobId].overruns, 0);
+  CHECK_EQ(Scheduler::tasks[renderId].overruns, 0);
+  CHECK_LE(Scheduler::tasks[jobId].maxUs, CHUNK_US + 100);
+  printf("split: max pass %lu us, input late by at most %lu us\n",
+         Scheduler::getMaxLatencyUs(), worstInputLateUs);
+
+  // The same job without yields: one pass holds the loop for all chunks
+  Scheduler::takeWindowMaxUs();
+  worstInputLateUs = 0;
+  split = false;
+  uint32_t jobsBefore = jobsDone;
+  Sim::runMs(2000);
+  CHECK(jobsDone > jobsBefore);
+  unsigned long blockedUs = Scheduler::takeWindowMaxUs();
+  CHECK(blockedUs >= CHUNKS * CHUNK_US);
+  CHECK(worstInputLateUs >= CHUNKS * CHUNK_US - SCHED_TICK_MS * 1000UL);
+  CHECK(Scheduler::tasks[jobId].overruns > 0);
+  printf("blocking: max pass %lu us, input late by at most %lu us\n",
+         blockedUs, worstInputLateUs);
+  return checkResult("test_scheduler");
+}
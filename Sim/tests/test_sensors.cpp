@@ -0,0 +1,51 @@
+/*
+ * Distance screen statistics: after a profile change the noise figure
+ * covers only the samples taken since, wherever the ring head is, and
+ * the profile names come out of flash
+ */
+
+#include "../../Mauther/Mauther.ino"
+#include "sim.h"
+#include "check.h"
+
+static void click(uint8_t pin) {
+  Sim::click(pin);
+  Sim::runMs(150);
+}
+
+int main() {
+  // Target moving between 400 and 600mm: a lot of noise
+  Sim::setDistanceFn([](uint64_t us) -> uint16_t { return (us / 10000) % 2 ? 600 : 400; });
+  Sim::runMs(1000);
+
+  // Main menu > Distance
+  click(PIN_BUTTON_SEL);
+  click(PIN_BUTTON_DOWN);
+  click(PIN_BUTTON_SEL);
+  CHECK(Sim::displayShows("Default"));
+  Sim::runMs(1000);
+  CHECK_EQ(Sensors::ringCount, SENSOR_RING_SIZE);
+  CHECK(Sensors::getNoiseX10() > 500);
+
+  // DOWN picks the next profile and empties the ring; from then on the
+  // target stands still
+  Sim::click(PIN_BUTTON_DOWN);
+  uint64_t until = Sim::now() + 500000;
+  while (Sensors::ringCount != 0 && Sim::now() < until) Sim::run(1000);
+  CHECK_EQ(Sensors::getProfile(), Sensors::PROFILE_HIGH_SPEED);
+  Sim::setDistance(500);
+  while (Sensors::ringCount < 3 && Sim::now() < until) Sim::run(1000);
+
+  // The newest samples are not at the start of the array, so reading
+  // ring[0..count) would mix in samples from before the change
+  CHECK(Sensors::ringHead != Sensors::ringCount);
+  CHECK(Sensors::ringCount < SENSOR_RING_SIZE);
+  CHECK_EQ(Sensors::getNoiseX10(), 0);
+
+  Sim::runMs(200);
+  CHECK(Sim::displayShows("Fast"));
+  CHECK(Sim::displayShows("500mm"));
+  CHECK(Sim::displayShows("0.0mm"));
+
+  return checkResult("test_sensors");
+}
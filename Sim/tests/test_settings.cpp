@@ -0,0 +1,42 @@
+/*
+ * Settings at boot: a record that fails its CRC is ignored, and with no
+ * valid record left every value comes from the defaults - nothing is read
+ * out of the broken bytes
+ */
+
+#include "../../Mauther/Mauther.ino"
+#include "sim.h"
+#include "check.h"
+
+int main() {
+  // Slot 0 holds a record torn by a reset: right version, values changed
+  // from the defaults, CRC not matching; the other slots are erased
+  Settings::Record r;
+  memcpy_P(&r.values, &Settings::defaults, sizeof(r.values));
+  r.version = SETTINGS_VERSION;
+  r.seq = 7;
+  r.values.sensorProfile = Sensors::PROFILE_HIGH_SPEED;
+  r.values.alarmMm += 100;
+  r.crc = Settings::crc(r) ^ 0x5A5A;
+  memcpy(Sim::eeprom() + Settings::slotAddr(0), &r, sizeof(r));
+
+  Sim::runMs(500);
+
+  Settings::Values defaults;
+  memcpy_P(&defaults, &Settings::defaults, sizeof(defaults));
+  CHECK(memcmp(&Settings::values, &defaults, sizeof(defaults)) == 0);
+  CHECK_EQ(Settings::values.sensorProfile, defaults.sensorProfile);
+  CHECK_EQ(Sensors::getProfile(), defaults.sensorProfile);
+
+  // The first save goes to slot 0 and replaces the broken record
+  Settings::set(Settings::SET_ALARM_MM, defaults.alarmMm + 50);
+  Settings::saveNow();
+  Sim::runMs(500);
+  CHECK(!Settings::isSaving());
+  Settings::Record saved;
+  memcpy(&saved, Sim::eeprom() + Settings::slotAddr(0), sizeof(saved));
+  CHECK_EQ(saved.crc, Settings::crc(saved));
+  CHECK_EQ(saved.values.alarmMm, defaults.alarmMm + 50);
+
+  return checkResult("test_settings");
+}
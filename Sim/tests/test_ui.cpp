@@ -0,0 +1,196 @@
+/*
+ * UI flow on the simulated watch: boot to the face, partial redraw of
+ * the seconds, menu navigation, no redraw of an unchanged screen, menu
+ * timeout, power-down and idle sleep and wake
+ */
+
+#include "../../Mauther/Mauther.ino"
+#include "sim.h"
+#include "check.h"
+#include <chrono>
+
+// The face shows the time the RTC was last set to plus whole seconds of
+// simulated time since (09:15:00 at power-on)
+static uint32_t rtcSetSeconds = 9 * 3600 + 15 * 60;
+static uint64_t rtcSetUs = 0;
+
+static void setRtc(uint8_t hour, uint8_t minute, uint8_t second) {
+  Sim::setRtcTime(2026, 3, 1, hour, minute, second);
+  rtcSetSeconds = hour * 3600UL + minute * 60 + second;
+  rtcSetUs = Sim::now();
+}
+
+static void expectedTime(char* out) {
+  uint32_t s = rtcSetSeconds + (Sim::now() - rtcSetUs) / 1000000;
+  snprintf(out, 9, "%02u:%02u:%02u", (s / 3600) % 24, (s / 60) % 60, s % 60);
+}
+
+// Digits on the panel, compared byte for byte with face_digits.h
+static bool faceShows(const char* time) {
+  uint8_t x = FACE_LEFT;
+  for (uint8_t i = 0; i < 8; i++) {
+    uint8_t w;
+    const uint8_t* glyph = Display::faceGlyph(time, i, w);
+    for (uint8_t p = 0; p < FACE_DIGIT_PAGES; p++) {
+      for (uint8_t c = 0; c < w; c++) {
+        uint8_t panel = 0;
+        for (uint8_t b = 0; b < 8; b++) {
+          panel |= Sim::displayPixel(x + c, (FACE_TOP_PAGE + p) * 8 + b) << b;
+        }
+        if (panel != glyph[p * w + c]) return false;
+      }
+    }
+    x += w;
+  }
+  return true;
+}
+
+static bool faceShowsNow() {
+  char time[9];
+  expectedTime(time);
+  return faceShows(time);
+}
+
+// Run on to the middle of a second, when the face has caught up
+static void toMidSecond() {
+  uint64_t into = (Sim::now() - rtcSetUs) % 1000000;
+  Sim::run(into <= 500000 ? 500000 - into : 1500000 - into);
+}
+
+// Seconds tick over with the RTC: right at several points of one second
+// (a frame may take up to ~100ms to follow the tick)
+static bool faceInStepWithRtc() {
+  bool ok = true;
+  uint64_t second = Sim::now() + 1000000 - (Sim::now() - rtcSetUs) % 1000000;
+  for (uint32_t at = 150000; at < 1000000; at += 200000) {
+    Sim::run(second + at - Sim::now());
+    ok = ok && faceShowsNow();
+  }
+  return ok;
+}
+
+static void click(uint8_t pin) {
+  Sim::click(pin);
+  Sim::runMs(150);
+}
+
+int main() {
+  auto started = std::chrono::steady_clock::now();
+
+  setRtc(9, 15, 0);
+  Sim::setDistance(640);
+
+  // Boot: face with time, temperature and distance
+  Sim::runMs(1000);
+  toMidSecond();
+  CHECK(Sim::displayOn());
+  CHECK(faceShowsNow());
+  CHECK(Sim::displayShows("25.0C"));
+  CHECK(Sim::displayShows("640mm"));
+
+  // A new second only sends the digit pages that changed (no minute
+  // or ten-second rollover between :02 and :07)
+  uint32_t before = Sim::displayDataBytes();
+  Sim::runMs(5000);
+  CHECK(faceShowsNow());
+  CHECK_LE(Sim::displayDataBytes() - before, 5 * FACE_DIGIT_PAGES * FACE_DIGIT_WIDTH);
+
+  Sim::setDistance(830);
+  Sim::runMs(200);
+  CHECK(Sim::displayShows("830mm"));
+
+  // Menu, then the distance screen
+  click(PIN_BUTTON_SEL);
+  CHECK(Sim::displayShows("MENU"));
+  CHECK(Sim::displayShows("Back"));
+  CHECK_EQ(Menu::menuSelection, 0);
+  click(PIN_BUTTON_DOWN);
+  CHECK_EQ(Menu::menuSelection, 1);
+  click(PIN_BUTTON_SEL);
+  CHECK(Sim::displayShows("830mm"));
+  CHECK(Sim::displayShows("30.4Hz"));
+
+  // Back on the face after MENU_TIMEOUT_MS without input
+  Sim::runMs(MENU_TIMEOUT_MS);
+  toMidSecond();
+  CHECK(!Sim::displayShows("30.4Hz"));
+  CHECK(faceShowsNow());
+
+  // System > Info shows the date and is not redrawn while it stays the
+  // same: every Menu pass asks, every one is skipped
+  click(PIN_BUTTON_SEL);
+  for (uint8_t i = 0; i < 5; i++) click(PIN_BUTTON_DOWN);
+  click(PIN_BUTTON_SEL);
+  click(PIN_BUTTON_DOWN);
+  click(PIN_BUTTON_SEL);
+  CHECK(Sim::displayShows("2026-03-01"));
+  before = Sim::displayDataBytes();
+  unsigned long drawn = View::getFramesDrawn(), skipped = View::getFramesSkipped();
+  Sim::runMs(3000);
+  CHECK_EQ(Sim::displayDataBytes(), before);
+  CHECK_EQ(View::getFramesDrawn(), drawn);
+  CHECK(View::getFramesSkipped() - skipped >= 3000 / 10 * 9 / 10);   // Every Menu pass
+  Sim::runMs(MENU_TIMEOUT_MS);
+
+  // Sleep from the menu; without USB the MCU powers down
+  Sim::setUsbConfigured(false);
+  click(PIN_BUTTON_SEL);
+  for (uint8_t i = 0; i < 6; i++) click(PIN_BUTTON_DOWN);
+  CHECK(Sim::displayShows("Sleep"));
+  CHECK_EQ(Menu::menuSelection, 6);
+  click(PIN_BUTTON_SEL);
+  CHECK(Sim::displayShows("Sleep Mode"));
+  Sim::runMs(1500);
+  CHECK(!Sim::displayOn());
+  CHECK(!Sim::sensorRanging());
+
+  uint64_t loops = Sim::loopCount();
+  unsigned long ms = millis();
+  Sim::runMs(60000);
+  CHECK_EQ(Sim::loopCount(), loops);   // Asleep: loop() never ran
+  CHECK_LE(millis() - ms, 1);          // ...and Timer0 stood still
+
+  // The RTC reads the same second the RAM clock stopped at, but its
+  // seconds tick half way between those of the stopped millis(): the
+  // wake must find the RTC's second boundary again
+  uint64_t ramTickUs = RTCModule::secondStart * 1000ULL + (Sim::now() - micros());
+  Sim::run((1500000 - (Sim::now() - ramTickUs) % 1000000) % 1000000);
+  setRtc(RTCModule::lastTime.hour, RTCModule::lastTime.minute, RTCModule::lastTime.second);
+
+  // Any button wakes it to the face; that press does nothing else
+  Sim::click(PIN_BUTTON_UP);
+  Sim::runMs(100);
+  CHECK(Sim::displayOn());
+  CHECK(Sim::sensorRanging());
+  Sim::runMs(2000);
+  CHECK(faceInStepWithRtc());
+  CHECK(!Sim::displayShows("MENU"));
+
+  // On USB the MCU only idles: Timer0 keeps millis() counting past
+  // MENU_TIMEOUT_MS, and the wake must still come back with the display on
+  Sim::setUsbConfigured(true);
+  click(PIN_BUTTON_SEL);
+  for (uint8_t i = 0; i < 6; i++) click(PIN_BUTTON_DOWN);
+  click(PIN_BUTTON_SEL);
+  Sim::runMs(1500);
+  CHECK(!Sim::displayOn());
+  ms = millis();
+  Sim::runMs(MENU_TIMEOUT_MS + 10000);
+  CHECK(millis() - ms >= MENU_TIMEOUT_MS);
+  CHECK(!Sim::displayOn());
+
+  Sim::click(PIN_BUTTON_UP);
+  Sim::runMs(100);
+  CHECK(Sim::displayOn());
+  CHECK(Sim::sensorRanging());
+  toMidSecond();
+  CHECK(faceShowsNow());
+
+  // All of the above is ~3 minutes of watch time
+  double hostMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+  double simMs = Sim::now() / 1000.0;
+  printf("%.0f ms simulated in %.0f ms\n", simMs, hostMs);
+  CHECK(simMs > 10 * hostMs);
+
+  return checkResult("test_ui");
+}
@@ -0,0 +1,241 @@
+/*
+ * U8g2 for the host simulator - page buffer drawing and the SH1106 I2C
+ * byte stream (see hal/U8g2lib.h)
+ */
+
+#include <U8g2lib.h>
+#include "sim.h"
+
+static const u8g2_cb_t rotation0 = {0};
+const u8g2_cb_t* U8G2_R0 = &rotation0;
+
+// Placeholder - the simulator draws text with glyphs5x7 below
+const uint8_t u8g2_font_6x10_tf[] = {0};
+
+// Printable ASCII, 5 columns per glyph, LSB at the top
+static const uint8_t glyphs5x7[95][5] = {
+  {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+  {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+  {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x08, 0x07, 0x03, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+  {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+  {0x00, 0x80, 0x70, 0x30, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x00, 0x60, 0x60, 0x00},
+  {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+  {0x72, 0x49, 0x49, 0x49, 0x46}, {0x21, 0x41, 0x49, 0x4D, 0x33}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+  {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07},
+  {0x36, 0x49, 0x49, 0x49, 0x36}, {0x46, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x00, 0x14, 0x00, 0x00},
+  {0x00, 0x40, 0x34, 0x00, 0x00}, {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},
+  {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x59, 0x09, 0x06}, {0x3E, 0x41, 0x5D, 0x59, 0x4E},
+  {0x7C, 0x12, 0x11, 0x12, 0x7C}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+  {0x7F, 0x41, 0x41, 0x41, 0x3E}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01},
+  {0x3E, 0x41, 0x41, 0x51, 0x73}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+  {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+  {0x7F, 0x02, 0x1C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+  {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+  {0x26, 0x49, 0x49, 0x49, 0x32}, {0x03, 0x01, 0x7F, 0x01, 0x03}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+  {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+  {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x59, 0x49, 0x4D, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x41},
+  {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x41, 0x7F}, {0x04, 0x02, 0x01, 0x02, 0x04},
+  {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x03, 0x07, 0x08, 0x00}, {0x20, 0x54, 0x54, 0x78, 0x40},
+  {0x7F, 0x28, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x28}, {0x38, 0x44, 0x44, 0x28, 0x7F},
+  {0x38, 0x54, 0x54, 0x54, 0x18}, {0x00, 0x08, 0x7E, 0x09, 0x02}, {0x18, 0xA4, 0xA4, 0x9C, 0x78},
+  {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x40, 0x3D, 0x00},
+  {0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x78, 0x04, 0x78},
+  {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0xFC, 0x18, 0x24, 0x24, 0x18},
+  {0x18, 0x24, 0x24, 0x18, 0xFC}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x24},
+  {0x04, 0x04, 0x3F, 0x44, 0x24}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},
+  {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x4C, 0x90, 0x90, 0x90, 0x7C},
+  {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x77, 0x00, 0x00},
+  {0x00, 0x41, 0x36, 0x08, 0x00}, {0x02, 0x01, 0x02, 0x04, 0x02},
+};
+
+// One I2C transfer through the byte procedure
+static void transfer(u8x8_t* u8x8, const uint8_t* data, uint8_t len) {
+  u8x8->byteCb(u8x8, U8X8_MSG_BYTE_START_TRANSFER, 0, 0);
+  u8x8->byteCb(u8x8, U8X8_MSG_BYTE_SEND, len, (void*)data);
+  u8x8->byteCb(u8x8, U8X8_MSG_BYTE_END_TRANSFER, 0, 0);
+}
+
+uint8_t u8x8_gpio_and_delay_arduino(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr) {
+  (void)u8x8;
+  (void)msg;
+  (void)arg_int;
+  (void)arg_ptr;
+  return 1;
+}
+
+void u8g2_Setup_sh1106_i2c_128x64_noname_1(u8g2_t* u8g2, const u8g2_cb_t* rotation,
+                                          u8x8_msg_cb byteCb, u8x8_msg_cb gpioCb) {
+  (void)rotation;
+  u8g2->u8x8.byteCb = byteCb;
+  u8g2->u8x8.gpioCb = gpioCb;
+  u8g2->u8x8.i2c_address = 0x78;
+}
+
+uint8_t u8x8_GetI2CAddress(u8x8_t* u8x8) {
+  return u8x8->i2c_address;
+}
+
+void u8x8_SetI2CAddress(u8x8_t* u8x8, uint8_t addr) {
+  u8x8->i2c_address = addr;
+}
+
+// Page and column (SH1106 RAM starts 2 columns left of the panel), then
+// the tile bytes in chunks
+uint8_t u8x8_DrawTile(u8x8_t* u8x8, uint8_t x, uint8_t y, uint8_t cnt, uint8_t* tiles) {
+  uint8_t col = x * 8 + 2;
+  uint8_t cmd[] = {0x00, (uint8_t)(0xB0 | y), (uint8_t)(0x10 | (col >> 4)), (uint8_t)(col & 0x0F)};
+  transfer(u8x8, cmd, sizeof(cmd));
+
+  uint16_t left = cnt * 8;
+  uint8_t buf[SIM_U8X8_CHUNK + 1];
+  buf[0] = 0x40;
+  while (left) {
+    uint8_t n = left < SIM_U8X8_CHUNK ? left : SIM_U8X8_CHUNK;
+    memcpy(buf + 1, tiles, n);
+    transfer(u8x8, buf, n + 1);
+    tiles += n;
+    left -= n;
+  }
+  return 1;
+}
+
+void u8x8_RefreshDisplay(u8x8_t* u8x8) {
+  (void)u8x8;                 // SH1106 shows its RAM directly
+}
+
+U8G2::U8G2() {
+  memset(&u8g2, 0, sizeof(u8g2));
+  memset(buffer, 0, sizeof(buffer));
+}
+
+// U8g2's SH1106 init sequence, then a cleared screen, display on
+bool U8G2::begin() {
+  u8x8_t* u8x8 = getU8x8();
+  u8x8->byteCb(u8x8, U8X8_MSG_BYTE_INIT, 0, 0);
+
+  static const uint8_t init[] = {
+    0x00, 0xAE, 0xD5, 0x80, 0xA8, 0x3F, 0xD3, 0x00, 0x40, 0x8D, 0x14,
+    0xA1, 0xC8, 0xDA, 0x12, 0x81, 0xCF, 0xD9, 0xF1, 0xDB, 0x40, 0xA4, 0xA6
+  };
+  transfer(u8x8, init, sizeof(init));
+
+  clearBuffer();
+  for (uint8_t row = 0; row < 8; row++) u8x8_DrawTile(u8x8, 0, row, 16, buffer);
+  setPowerSave(0);
+  return true;
+}
+
+void U8G2::setContrast(uint8_t value) {
+  uint8_t cmd[] = {0x00, 0x81, value};
+  transfer(getU8x8(), cmd, sizeof(cmd));
+}
+
+void U8G2::setPowerSave(uint8_t on) {
+  uint8_t cmd[] = {0x00, (uint8_t)(on ? 0xAE : 0xAF)};
+  transfer(getU8x8(), cmd, sizeof(cmd));
+}
+
+void U8G2::drawPixel(u8g2_uint_t x, u8g2_uint_t y) {
+  if (x < 128 && (y >> 3) == tileRow) buffer[x] |= 1 << (y & 7);
+}
+
+// Every character ever passed to drawStr()
+static bool drawn[256];
+
+// With SIM_GLYPHS=file the drawn characters are appended to it at exit,
+// for Tools/font_subset.py --check --drawn
+static struct GlyphLog {
+  ~GlyphLog() {
+    const char* path = getenv("SIM_GLYPHS");
+    if (!path) return;
+    FILE* f = fopen(path, "ab");
+    if (!f) return;
+    fputs(Sim::drawnGlyphs().c_str(), f);
+    fclose(f);
+  }
+} glyphLog;
+
+// 6x10 cell; with setFontPosTop() y is the top of the cell, otherwise the
+// baseline
+void U8G2::drawStr(u8g2_uint_t x, u8g2_uint_t y, const char* s) {
+  int top = posTop ? y + 1 : y - 7;
+  for (; *s; s++, x += 6) {
+    uint8_t c = (uint8_t)*s;
+    drawn[c] = true;
+    if (c < 0x20 || c > 0x7E) continue;
+    for (uint8_t col = 0; col < 5; col++) {
+      uint8_t bits = glyphs5x7[c - 0x20][col];
+      for (uint8_t row = 0; row < 8; row++) {
+        int py = top + row;
+        if ((bits >> row) & 1 && py >= 0 && py < 64) drawPixel(x + col, py);
+      }
+    }
+  }
+}
+
+void U8G2::drawBox(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h) {
+  for (uint16_t j = 0; j < h; j++) drawHLine(x, y + j, w);
+}
+
+void U8G2::drawHLine(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w) {
+  for (uint16_t i = 0; i < w; i++) drawPixel(x + i, y);
+}
+
+void U8G2::clearBuffer() {
+  memset(buffer, 0, sizeof(buffer));
+}
+
+void U8G2::sendBuffer() {
+  u8x8_DrawTile(getU8x8(), 0, tileRow, 16, buffer);
+}
+
+void U8G2::firstPage() {
+  clearBuffer();
+  tileRow = 0;
+}
+
+uint8_t U8G2::nextPage() {
+  sendBuffer();
+  if (++tileRow >= 8) {
+    tileRow = 0;
+    return 0;
+  }
+  clearBuffer();
+  return 1;
+}
+
+// Match each glyph's 5x8 pixels (not the gap column) against the panel
+bool Sim::displayShows(const char* text) {
+  size_t len = strlen(text);
+  if (!len || len * 6 > 128 + 1) return false;
+  for (int y = -1; y <= 64 - 7; y++) {
+    for (int x = 0; x + (int)len * 6 - 1 <= 128; x++) {
+      bool match = true;
+      for (size_t i = 0; i < len && match; i++) {
+        uint8_t c = (uint8_t)text[i];
+        if (c < 0x20 || c > 0x7E) return false;
+        for (uint8_t col = 0; col < 5 && match; col++) {
+          uint8_t bits = glyphs5x7[c - 0x20][col];
+          for (uint8_t row = 0; row < 8 && match; row++) {
+            int py = y + row;
+            if (py < 0 || py >= 64) {
+              match = !((bits >> row) & 1);
+            } else {
+              match = ((bits >> row) & 1) == displayPixel(x + i * 6 + col, py);
+            }
+          }
+        }
+      }
+      if (match) return true;
+    }
+  }
+  return false;
+}
+
+std::string Sim::drawnGlyphs() {
+  std::string out;
+  for (int c = 1; c < 256; c++) {
+    if (drawn[c]) out += (char)c;
+  }
+  return out;
+}
@@ -0,0 +1,235 @@
+#!/usr/bin/env python3
+"""
+Collect the BENCH_MODE scenario numbers and compare them with a baseline.
+
+Build the firmware with BENCH_MODE (and FORMAT_BENCHMARK if wanted). The
+suite runs at the end of every boot and prints BENCH lines over USB serial.
+
+    python3 bench_report.py --serial /dev/ttyACM0 -o bench.json   # then reset the watch
+    python3 bench_report.py --log boot.txt -o bench.json           # a saved serial log
+    python3 bench_report.py --log boot.txt --baseline bench.json   # exit 1 on a regression
+    python3 bench_report.py --log boot.txt --elf Mauther.ino.elf -o bench.json
+    python3 bench_report.py --log boot.txt --limits bench_limits.json  # exit 1 over a budget
+
+make -C Sim test runs the suite in the host simulator and checks its log
+(Sim/build/bench.txt) against Sim/bench_baseline.json and the limits.
+
+--serial waits for the port to (re)appear, since the Leonardo drops off USB
+while it resets, and reads until "BENCH done". The JSON holds one entry
+per scenario: cycles (fastest run), max, i2c (bytes per run), stack and
+free (bytes of RAM). A scenario regresses when its cycles grow by more
+than --tolerance percent, its I2C bytes grow at all, or its stack grows
+by more than --stack-slack bytes (an interrupt landing at the deepest
+point adds its frame).
+
+--elf records the build's footprint from avr-size (flash = text + data,
+RAM = data + bss) under "_size"; against a baseline that has one, flash
+growing by more than --flash-slack bytes is a regression too.
+
+--limits checks absolute budgets instead of a previous run: a JSON of
+{scenario: {field: {"max": n} or {"min": n}}}, e.g. {"loop_all": {"max":
+{"max": 480000}}} for the slowest loop pass. A scenario the limits name
+but the run lacks is a failure too (drop it from the file for a build
+without that feature); "_size" is only checked with --elf.
+bench_limits.json holds the budgets the firmware is written to.
+"""
+
+import argparse
+import json
+import subprocess
+import sys
+import time
+
+
+def parse_line(line):
+    """(key, fields) for a BENCH line, None for anything else."""
+    line = line.strip()
+    if not line.startswith("BENCH "):
+        return None
+    fields = dict(kv.split("=", 1) for kv in line[6:].split() if "=" in kv)
+    if "name" in fields:
+        key = fields.pop("name")
+    elif "fmt" in fields:           # FORMAT_BENCHMARK: snprintf vs formatter
+        key = "fmt." + fields.pop("fmt")
+    elif "f_cpu" in fields:
+        key = "_meta"
+    else:
+        return None
+    return key, {k: int(v) if v.lstrip("-").isdigit() else v for k, v in fields.items()}
+
+
+def parse_log(lines):
+    results = {}
+    for line in lines:
+        if line.strip() == "BENCH done":
+            break
+        parsed = parse_line(line)
+        if parsed:
+            results[parsed[0]] = parsed[1]
+    return results
+
+
+def elf_size(path, tool="avr-size"):
+    """{"flash": text + data, "ram": data + bss} from avr-size's Berkeley output."""
+    try:
+        out = subprocess.run([tool, path], check=True, stdout=subprocess.PIPE,
+                             universal_newlines=True).stdout
+    except (OSError, subprocess.CalledProcessError) as e:
+        sys.exit("bench_report: %s %s failed: %s" % (tool, path, e))
+    return parse_size(out)
+
+
+def parse_size(out):
+    lines = out.strip().splitlines()
+    if len(lines) < 2 or lines[0].split()[:3] != ["text", "data", "bss"]:
+        sys.exit("bench_report: unexpected avr-size output:\n" + out)
+    text, data, bss = (int(v) for v in lines[1].split()[:3])
+    return {"flash": text + data, "ram": data + bss}
+
+
+def read_serial(port, timeout):
+    import serial  # pyserial
+
+    deadline = time.time() + timeout
+    print("Waiting for %s - reset the watch" % port, file=sys.stderr)
+    lines = []
+    while time.time() < deadline:
+        try:
+            with serial.Serial(port, 115200, timeout=0.5) as s:
+                while time.time() < deadline:
+                    line = s.readline().decode("ascii", "replace")
+                    if not line:
+                        continue
+                    lines.append(line)
+                    if line.strip() == "BENCH done":
+                        return lines
+        except (serial.SerialException, OSError):
+            time.sleep(0.2)         # Not enumerated yet, or gone for a reset
+    sys.exit("bench_report: no \"BENCH done\" within %d s (is BENCH_MODE enabled?)" % timeout)
+
+
+def print_table(results):
+    meta = results.get("_meta", {})
+    if meta:
+        print("f_cpu %d Hz, timing overhead %d cycles" % (meta.get("f_cpu", 0), meta.get("overhead", 0)))
+    size = results.get("_size")
+    if size:
+        print("flash %d bytes, static RAM %d bytes" % (size["flash"], size["ram"]))
+    print("%-14s %10s %10s %9s %6s %6s %6s" % ("scenario", "cycles", "max", "us", "i2c", "stack", "free"))
+    mhz = meta.get("f_cpu", 16000000) / 1e6
+    for name, r in results.items():
+        if "cycles" not in r:
+            continue
+        print("%-14s %10d %10d %9.1f %6d %6d %6d" % (name, r["cycles"], r["max"], r["cycles"] / mhz,
+                                                     r["i2c"], r["stack"], r["free"]))
+    for name, r in results.items():
+        if name.startswith("fmt."):
+            print("%-14s snprintf %d, formatter %d cycles" % (name, r["snprintf"], r["format"]))
+
+
+def compare(results, baseline, tolerance, stack_slack, flash_slack=0):
+    """List of regression messages, empty if none."""
+    problems = []
+    for name, base in baseline.items():
+        if name == "_meta":
+            continue
+        if name == "_size":
+            now = results.get(name)
+            if now and now["flash"] > base["flash"] + flash_slack:
+                problems.append("flash %d -> %d bytes" % (base["flash"], now["flash"]))
+            continue
+        now = results.get(name)
+        if now is None:
+            problems.append("%s: missing" % name)
+            continue
+        for key in ("cycles", "format"):
+            if key in base and now[key] > base[key] * (1 + tolerance / 100.0):
+                problems.append("%s: %s %d -> %d (+%.1f%%)" % (name, key, base[key], now[key],
+                                                               100.0 * (now[key] - base[key]) / max(base[key], 1)))
+        if "i2c" in base and now["i2c"] > base["i2c"]:
+            problems.append("%s: i2c %d -> %d bytes" % (name, base["i2c"], now["i2c"]))
+        if "stack" in base and now["stack"] > base["stack"] + stack_slack:
+            problems.append("%s: stack %d -> %d bytes" % (name, base["stack"], now["stack"]))
+    return problems
+
+
+def check_limits(results, limits):
+    """List of budget violations, empty if none."""
+    problems = []
+    for name, fields in limits.items():
+        now = results.get(name)
+        if name == "_size" and now is None:
+            print("note: no --elf, flash and RAM budgets not checked")
+            continue
+        if now is None:
+            problems.append("%s: missing" % name)
+            continue
+        for field, bound in fields.items():
+            if field not in now:
+                problems.append("%s: no %s in this run" % (name, field))
+                continue
+            if "max" in bound and now[field] > bound["max"]:
+                problems.append("%s: %s %d > %d" % (name, field, now[field], bound["max"]))
+            if "min" in bound and now[field] < bound["min"]:
+                problems.append("%s: %s %d < %d" % (name, field, now[field], bound["min"]))
+    return problems
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    src = ap.add_mutually_exclusive_group(required=True)
+    src.add_argument("--serial", metavar="PORT", help="read the boot output of the watch")
+    src.add_argument("--log", metavar="FILE", help="read a saved serial log")
+    ap.add_argument("-o", "--output", metavar="FILE", help="write the results as JSON")
+    ap.add_argument("--baseline", metavar="FILE", help="JSON from an earlier run to compare against")
+    ap.add_argument("--limits", metavar="FILE", help="JSON of absolute budgets per scenario (bench_limits.json)")
+    ap.add_argument("--tolerance", type=float, default=5.0, help="allowed cycle growth in %% (default: %(default)s)")
+    ap.add_argument("--stack-slack", type=int, default=16, help="allowed stack growth in bytes (default: %(default)s)")
+    ap.add_argument("--elf", metavar="FILE", help="record flash/RAM of this build with avr-size")
+    ap.add_argument("--flash-slack", type=int, default=0, help="allowed flash growth in bytes (default: %(default)s)")
+    ap.add_argument("--timeout", type=int, default=30, help="seconds to wait with --serial (default: %(default)s)")
+    args = ap.parse_args()
+
+    if args.serial:
+        lines = read_serial(args.serial, args.timeout)
+    else:
+        with open(args.log) as f:
+            lines = f.readlines()
+
+    results = parse_log(lines)
+    if not results:
+        sys.exit("bench_report: no BENCH lines found")
+    if args.elf:
+        results["_size"] = elf_size(args.elf)
+    print_table(results)
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+            f.write("\n")
+
+    failed = False
+    if args.limits:
+        with open(args.limits) as f:
+            problems = check_limits(results, json.load(f))
+        for p in problems:
+            print("OVER BUDGET " + p)
+        failed = bool(problems)
+        if not problems:
+            print("OK: within the budgets in %s" % args.limits)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            problems = compare(results, json.load(f), args.tolerance, args.stack_slack, args.flash_slack)
+        for p in problems:
+            print("REGRESSION " + p)
+        failed = failed or bool(problems)
+        if not problems:
+            print("OK: no regressions against %s" % args.baseline)
+
+    if failed:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
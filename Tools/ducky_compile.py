@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+"""
+Compile DuckyScript-style text into Mauther BadUSB bytecode.
+
+    python3 ducky_compile.py scripts/*.txt -o ../Mauther/badusb_scripts.h
+
+Each input file becomes one entry in the BadUSB menu. Optional header lines:
+
+    REM NAME Browser       name shown in the menu (default: file name)
+    REM TARGET MAC         only listed while the badusb_os setting is Mac
+    REM TARGET WINDOWS     only listed while the badusb_os setting is Windows
+    REM TARGET BENCH       only built with BADUSB_BENCHMARK
+
+Supported commands: REM, DELAY ms, DEFAULT_DELAY / DEFAULTDELAY ms,
+STRING text, STRINGLN text, REPEAT n, and key lines such as "GUI r",
+"CTRL ALT DELETE" or "ENTER".
+
+Bytecode (see badusb.h):
+
+    0x00                    END
+    0x01 lo hi              DELAY ms
+    0x02 lo hi              DEFAULT_DELAY ms (after every STRING / key line)
+    0x03 n c1..cn           STRING - type n characters
+    0x04 n k1..kn           KEYS - press n keys together, then release all
+"""
+
+import argparse
+import os
+import sys
+
+OP_END, OP_DELAY, OP_DEFAULT_DELAY, OP_STRING, OP_KEYS = range(5)
+MAX_STRING = 255
+MAX_KEYS = 6
+
+# Arduino Keyboard.h key codes
+KEYS = {
+    "CTRL": 0x80, "CONTROL": 0x80, "SHIFT": 0x81, "ALT": 0x82,
+    "GUI": 0x83, "WINDOWS": 0x83, "COMMAND": 0x83,
+    "RIGHT_CTRL": 0x84, "RIGHT_SHIFT": 0x85, "RIGHT_ALT": 0x86, "RIGHT_GUI": 0x87,
+    "UP": 0xDA, "UPARROW": 0xDA, "DOWN": 0xD9, "DOWNARROW": 0xD9,
+    "LEFT": 0xD8, "LEFTARROW": 0xD8, "RIGHT": 0xD7, "RIGHTARROW": 0xD7,
+    "BACKSPACE": 0xB2, "TAB": 0xB3, "ENTER": 0xB0, "RETURN": 0xB0,
+    "ESC": 0xB1, "ESCAPE": 0xB1, "INSERT": 0xD1, "DELETE": 0xD4, "DEL": 0xD4,
+    "PAGEUP": 0xD3, "PAGEDOWN": 0xD6, "HOME": 0xD2, "END": 0xD5,
+    "CAPSLOCK": 0xC1, "PRINTSCREEN": 0xCE, "SCROLLLOCK": 0xCF, "PAUSE": 0xD0,
+    "BREAK": 0xD0, "MENU": 0xED, "APP": 0xED, "SPACE": ord(" "),
+}
+KEYS.update({"F%d" % i: 0xC2 + i - 1 for i in range(1, 13)})
+
+# Target: (OS tag, build guard). OS-specific scripts are always built and
+# filtered at runtime, so the target can change without reflashing.
+TARGETS = {
+    None: ("BADUSB_OS_ANY", None),
+    "MAC": ("BADUSB_OS_MAC", None),
+    "WINDOWS": ("BADUSB_OS_WINDOWS", None),
+    "BENCH": ("BADUSB_OS_ANY", "#ifdef BADUSB_BENCHMARK"),
+}
+
+
+class CompileError(Exception):
+    pass
+
+
+def word(v):
+    if not 0 <= v <= 0xFFFF:
+        raise CompileError("value out of range: %d" % v)
+    return [v & 0xFF, v >> 8]
+
+
+def compile_string(text):
+    data = text.encode("ascii")
+    out = []
+    for i in range(0, len(data), MAX_STRING):
+        chunk = data[i:i + MAX_STRING]
+        out += [OP_STRING, len(chunk)] + list(chunk)
+    return out
+
+
+def compile_keys(tokens):
+    codes = []
+    for tok in tokens:
+        up = tok.upper()
+        if up in KEYS:
+            codes.append(KEYS[up])
+        elif len(tok) == 1:
+            codes.append(ord(tok.lower()))
+        else:
+            raise CompileError("unknown key: %s" % tok)
+    if len(codes) > MAX_KEYS:
+        raise CompileError("more than %d keys at once" % MAX_KEYS)
+    return [OP_KEYS, len(codes)] + codes
+
+
+def compile_script(lines):
+    """Return (name, target, bytecode) for one script."""
+    name = target = None
+    code = []
+    last = []
+
+    for lineno, raw in enumerate(lines, 1):
+        line = raw.rstrip("\r\n")
+        cmd, _, arg = line.strip().partition(" ")
+        try:
+            if not cmd:
+                continue
+            if cmd == "REM":
+                key, _, value = arg.partition(" ")
+                if key == "NAME":
+                    name = value.strip()
+                elif key == "TARGET":
+                    target = value.strip().upper()
+                    if target not in TARGETS:
+                        raise CompileError("unknown target: %s" % target)
+                continue
+            if cmd == "REPEAT":
+                code += last * int(arg)
+                continue
+
+            if cmd == "DELAY":
+                op = [OP_DELAY] + word(int(arg))
+            elif cmd in ("DEFAULT_DELAY", "DEFAULTDELAY"):
+                op = [OP_DEFAULT_DELAY] + word(int(arg))
+            elif cmd == "STRING":
+                op = compile_string(line.lstrip()[len("STRING "):])
+            elif cmd == "STRINGLN":
+                op = compile_string(line.lstrip()[len("STRINGLN "):]) + compile_keys(["ENTER"])
+            else:
+                op = compile_keys(line.split())
+        except (CompileError, ValueError, UnicodeEncodeError) as e:
+            raise CompileError("line %d: %s" % (lineno, e))
+        code += op
+        last = op
+
+    return name, target, code + [OP_END]
+
+
+def c_bytes(code):
+    rows = []
+    for i in range(0, len(code), 12):
+        rows.append("  " + ", ".join("0x%02X" % b for b in code[i:i + 12]) + ",")
+    return "\n".join(rows)
+
+
+def generate(scripts):
+    out = [
+        "/*",
+        " * BadUSB scripts - bytecode for the BadUSB interpreter",
+        " * Generated by Tools/ducky_compile.py from Tools/scripts - do not edit",
+        " */",
+        "",
+        "#pragma once",
+        "#include <Arduino.h>",
+        '#include "config.h"',
+        '#include "ui_text.h"',
+        "",
+        "struct BadUSBScript {",
+        "  const char* name;      // PROGMEM",
+        "  const uint8_t* code;   // PROGMEM",
+        "  uint16_t size;",
+        "  uint8_t os;            // BADUSB_OS_* the script is for",
+        "};",
+        "",
+    ]
+    entries = []
+    for i, (path, name, target, code) in enumerate(scripts):
+        os_tag, guard = TARGETS[target]
+        ident = "badusbScript%d" % i
+        if guard:
+            out.append(guard)
+        out.append("// %s (%d bytes)" % (os.path.basename(path), len(code)))
+        out.append('UI_PSTR(%sName, "%s");' % (ident, name))
+        out.append("const uint8_t %sCode[] PROGMEM = {" % ident)
+        out.append(c_bytes(code))
+        out.append("};")
+        out.append('static_assert(sizeof(%sCode) <= MAX_SCRIPT_SIZE, "%s too large");'
+                   % (ident, os.path.basename(path)))
+        if guard:
+            out.append("#endif")
+        out.append("")
+        entries.append((guard, "  {%sName, %sCode, sizeof(%sCode), %s},"
+                        % (ident, ident, ident, os_tag)))
+
+    out.append("const BadUSBScript badusbScripts[] PROGMEM = {")
+    for guard, entry in entries:
+        if guard:
+            out.append("  " + guard)
+        out.append(entry)
+        if guard:
+            out.append("  #endif")
+    out.append("};")
+    out.append("")
+    out.append("#define BADUSB_SCRIPT_COUNT (sizeof(badusbScripts) / sizeof(badusbScripts[0]))")
+    out.append("")
+    return "\n".join(out)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("scripts", nargs="+", help="DuckyScript text files")
+    ap.add_argument("-o", "--output", default="-", help="header to write (default: stdout)")
+    args = ap.parse_args()
+
+    scripts = []
+    for path in sorted(args.scripts):
+        with open(path) as f:
+            try:
+                name, target, code = compile_script(f)
+            except CompileError as e:
+                sys.exit("%s: %s" % (path, e))
+        if name is None:
+            name = os.path.splitext(os.path.basename(path))[0]
+        if '"' in name or "\\" in name:
+            sys.exit("%s: name must not contain quotes or backslashes" % path)
+        scripts.append((path, name, target, code))
+
+    header = generate(scripts)
+    if args.output == "-":
+        sys.stdout.write(header)
+    else:
+        with open(args.output, "w") as f:
+            f.write(header)
+
+
+if __name__ == "__main__":
+    main()
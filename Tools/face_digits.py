@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""
+Generate the large watch face digits in the SH1106 tile format.
+
+    python3 face_digits.py -o ../Mauther/face_digits.h
+    python3 face_digits.py --preview          # print the glyphs as text
+
+Digits are 16x32 pixel seven segment glyphs with bevelled segments, plus
+an 8x32 colon. They are written pre-rendered the way the display takes
+them - 8 pixel high pages of column bytes, LSB at the top - so display.h
+can hand a changed digit to u8x8_DrawTile() with a copy out of flash and
+no drawing at run time. (An XBM bitmap is stored row by row and would
+have to be transposed on every blit.)
+"""
+
+import argparse
+import os
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+OUTPUT = os.path.join(HERE, "..", "Mauther", "face_digits.h")
+
+WIDTH, HEIGHT = 16, 32
+COLON_WIDTH = 8
+THICK = 3
+
+#      a
+#    f   b
+#      g
+#    e   c
+#      d
+SEGMENTS = {
+    "0": "abcdef", "1": "bc", "2": "abdeg", "3": "abcdg", "4": "bcfg",
+    "5": "acdfg", "6": "acdefg", "7": "abc", "8": "abcdefg", "9": "abcdfg",
+}
+
+# Inside a 14 pixel wide box, one blank column either side for spacing
+LEFT, RIGHT = 1, WIDTH - 2
+MID = HEIGHT // 2 - 1
+
+
+def horizontal(px, top):
+    """Bevelled bar: the middle row is full length, the outer rows one
+    pixel shorter at each end."""
+    for dy in range(THICK):
+        inset = 1 if dy != THICK // 2 else 0
+        for x in range(LEFT + THICK + inset, RIGHT - THICK + 1 - inset):
+            px.add((x, top + dy))
+
+
+def vertical(px, left, top, bottom):
+    for dx in range(THICK):
+        inset = 1 if dx != THICK // 2 else 0
+        for y in range(top + inset, bottom + 1 - inset):
+            px.add((left + dx, y))
+
+
+def digit(c):
+    px = set()
+    seg = SEGMENTS[c]
+    if "a" in seg: horizontal(px, 0)
+    if "g" in seg: horizontal(px, MID - THICK // 2)
+    if "d" in seg: horizontal(px, HEIGHT - THICK)
+    upper = (THICK, MID - 2)
+    lower = (MID + 2, HEIGHT - THICK - 1)
+    if "f" in seg: vertical(px, LEFT, *upper)
+    if "b" in seg: vertical(px, RIGHT - THICK + 1, *upper)
+    if "e" in seg: vertical(px, LEFT, *lower)
+    if "c" in seg: vertical(px, RIGHT - THICK + 1, *lower)
+    return px
+
+
+def colon():
+    px = set()
+    for cy in (HEIGHT // 3, HEIGHT * 2 // 3):
+        for x in range(2, 5):
+            for y in range(cy - 1, cy + 2):
+                px.add((x + 1, y))
+    return px
+
+
+def tiles(px, width):
+    """Pages of column bytes, LSB at the top."""
+    return [[sum(1 << bit for bit in range(8) if (x, page * 8 + bit) in px) for x in range(width)]
+            for page in range(HEIGHT // 8)]
+
+
+def preview(px, width):
+    return "\n".join("".join("#" if (x, y) in px else "." for x in range(width)) for y in range(HEIGHT))
+
+
+def c_rows(pages, indent):
+    return ",\n".join(indent + "{" + ", ".join("0x%02X" % b for b in page) + "}" for page in pages)
+
+
+def generate():
+    out = [
+        "/*",
+        " * Watch face digits - %dx%d seven segment glyphs and a %dx%d colon" % (WIDTH, HEIGHT, COLON_WIDTH, HEIGHT),
+        " * Generated by Tools/face_digits.py - do not edit",
+        " *",
+        " * Stored in the SH1106 tile format: FACE_DIGIT_PAGES pages of column bytes,",
+        " * LSB at the top, ready for u8x8_DrawTile().",
+        " */",
+        "",
+        "#pragma once",
+        "#include <Arduino.h>",
+        "",
+        "#define FACE_DIGIT_WIDTH %d" % WIDTH,
+        "#define FACE_COLON_WIDTH %d" % COLON_WIDTH,
+        "#define FACE_DIGIT_PAGES %d" % (HEIGHT // 8),
+        "",
+        "const uint8_t faceDigits[10][FACE_DIGIT_PAGES][FACE_DIGIT_WIDTH] PROGMEM = {",
+    ]
+    glyphs = []
+    for c in "0123456789":
+        glyphs.append("  // %s\n  {\n%s\n  }" % (c, c_rows(tiles(digit(c), WIDTH), "    ")))
+    out.append(",\n".join(glyphs))
+    out += [
+        "};",
+        "",
+        "const uint8_t faceColon[FACE_DIGIT_PAGES][FACE_COLON_WIDTH] PROGMEM = {",
+        c_rows(tiles(colon(), COLON_WIDTH), "  "),
+        "};",
+        "",
+    ]
+    return "\n".join(out)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("-o", "--output", default=OUTPUT, help="header to write (default: %(default)s)")
+    ap.add_argument("--preview", action="store_true", help="print the glyphs instead")
+    args = ap.parse_args()
+
+    if args.preview:
+        for c in "0123456789":
+            print(c)
+            print(preview(digit(c), WIDTH))
+        print(":")
+        print(preview(colon(), COLON_WIDTH))
+        return
+
+    with open(args.output, "w") as f:
+        f.write(generate())
+    size = 10 * WIDTH * HEIGHT // 8 + COLON_WIDTH * HEIGHT // 8
+    print("%s: 10 digits and a colon, %d bytes of flash" % (args.output, size))
+
+
+if __name__ == "__main__":
+    main()
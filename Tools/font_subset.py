@@ -0,0 +1,382 @@
+#!/usr/bin/env python3
+"""
+Generate a U8g2 font holding only the glyphs the Mauther UI can draw.
+
+    python3 font_subset.py -o ../Mauther/font_subset.h
+    python3 font_subset.py --glyphs-only    # glyph list only, no U8g2 needed
+    python3 font_subset.py --check          # fail if font_subset.h is stale
+    python3 font_subset.py --check --drawn ../Sim/build/glyphs.txt
+
+The firmware sources are scanned for string literals. Literals passed to
+F() only ever go to Serial and are skipped. printf-style conversions are
+expanded to every character they can produce (%d: digits and '-', %02d:
+digits, %5d: digits, '-' and ' ', ...). A conversion whose output cannot
+be bounded (%c) is an error, and so is a character the stock font lacks,
+so a subset that could drop a glyph is never written.
+
+--drawn takes the characters the firmware actually drew in the host
+simulator (Sim/, `make -C Sim test` writes them). Any of them the source
+scan does not find is an error too: the scan, not the simulator run,
+decides what the subset keeps.
+
+The glyphs are copied from the stock font in the installed U8g2 library
+(src/clib/u8g2_fonts.c). Pass --u8g2 if it is not in a standard Arduino
+library folder. font_subset.h is checked in and the build needs it: its
+glyph list (FONT_SUBSET_GLYPHS) is what ui_text.h checks UI_TEXT() and
+UI_PSTR() literals against at compile time. --glyphs-only writes just the
+list; display.h then draws with the stock font, as the header says.
+
+U8g2 font layout (see u8g2_font.c): a 23 byte header, then glyphs sorted by
+encoding - encoding:u8, size:u8 (whole entry), bitmap - ended by a zero
+size byte and the unicode lookup table. Header bytes 17..22 hold the
+offsets (big endian, from the end of the header) of the first glyph >= 'A',
+the first glyph >= 'a' and the unicode table. Subsetting only drops glyph
+entries, so the bitmaps are copied unchanged.
+"""
+
+import argparse
+import glob
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SOURCES = os.path.join(HERE, "..", "Mauther")
+OUTPUT = os.path.join(SOURCES, "font_subset.h")
+FONT = "u8g2_font_6x10_tf"
+SUBSET = "u8g2_font_6x10_subset"
+
+HEADER_SIZE = 23
+POS_UPPER_A, POS_LOWER_A, POS_UNICODE = 17, 19, 21
+
+LIBRARY_DIRS = [
+    "~/Arduino/libraries/U8g2",
+    "~/Documents/Arduino/libraries/U8g2",
+    "~/snap/arduino/current/Arduino/libraries/U8g2",
+]
+
+DIGITS = "0123456789"
+CONVERSIONS = {
+    "d": DIGITS + "-", "i": DIGITS + "-", "u": DIGITS,
+    "o": "01234567", "x": DIGITS + "abcdef", "X": DIGITS + "ABCDEF",
+    # avr-libc's default printf has no float support and prints '?'
+    "f": DIGITS + "-.?", "e": DIGITS + "-.?", "g": DIGITS + "-.?",
+    "s": "",  # Arguments are literals scanned on their own
+    "%": "%",
+}
+FORMAT_RE = re.compile(r"%([-+ #0]*)(\d+|\*)?(?:\.(\d+|\*))?(?:hh|h|ll|l|z|j|t|L)?(.)")
+SKIP_GENERATED = {"font_subset.h"}
+
+
+class SubsetError(Exception):
+    pass
+
+
+# ===== Source scanning =====
+
+def c_literals(text):
+    """Yield (literal, preceding code) for every string and char literal,
+    ignoring comments."""
+    i, n = 0, len(text)
+    line_start = 0
+    while i < n:
+        c = text[i]
+        if c == "\n":
+            line_start = i + 1
+        if text.startswith("//", i):
+            i = text.find("\n", i)
+            if i < 0:
+                return
+            continue
+        if text.startswith("/*", i):
+            i = text.find("*/", i) + 2
+            continue
+        if c in "\"'":
+            j = i + 1
+            while text[j] != c:
+                j += 2 if text[j] == "\\" else 1
+            yield c, decode_c_string(text[i + 1:j]).decode("latin-1"), text[line_start:i]
+            i = j + 1
+            continue
+        i += 1
+
+
+def decode_c_string(body):
+    out = bytearray()
+    i = 0
+    while i < len(body):
+        c = body[i]
+        if c != "\\":
+            out += c.encode("latin-1")
+            i += 1
+            continue
+        e = body[i + 1]
+        if e in "01234567":
+            m = re.match(r"[0-7]{1,3}", body[i + 1:])
+            out.append(int(m.group(0), 8) & 0xFF)
+            i += 1 + len(m.group(0))
+        elif e == "x":
+            m = re.match(r"[0-9a-fA-F]+", body[i + 2:])
+            out.append(int(m.group(0), 16) & 0xFF)
+            i += 2 + len(m.group(0))
+        else:
+            out += {"n": b"\n", "t": b"\t", "r": b"\r", "a": b"\a", "b": b"\b",
+                    "f": b"\f", "v": b"\v"}.get(e, e.encode("latin-1"))
+            i += 2
+    return bytes(out)
+
+
+def format_chars(literal, where):
+    """Characters a literal can put on screen, format conversions expanded."""
+    chars = set()
+    pos = 0
+    for m in FORMAT_RE.finditer(literal):
+        chars.update(literal[pos:m.start()])
+        pos = m.end()
+        flags, width, _prec, conv = m.groups()
+        if conv not in CONVERSIONS:
+            raise SubsetError("%s: %r - output of %%%s cannot be bounded"
+                              % (where, literal, conv))
+        chars.update(CONVERSIONS[conv])
+        if width and ("0" not in flags or "-" in flags) or " " in flags:
+            chars.add(" ")
+        if "+" in flags:
+            chars.add("+")
+    chars.update(literal[pos:])
+    return chars
+
+
+def skip_literal(kind, code):
+    code = code.strip()
+    return (code.endswith("F(") or code.startswith("#include") or "Serial." in code
+            or "static_assert" in code or "SECTION(" in code)
+
+
+def scan_sources(src_dir):
+    chars = set()
+    for path in sorted(glob.glob(os.path.join(src_dir, "*.h")) +
+                       glob.glob(os.path.join(src_dir, "*.ino"))):
+        if os.path.basename(path) in SKIP_GENERATED:
+            continue
+        with open(path, encoding="latin-1") as f:
+            text = f.read()
+        for kind, literal, code in c_literals(text):
+            if skip_literal(kind, code):
+                continue
+            where = os.path.basename(path)
+            if kind == "'":
+                chars.update(literal)
+            else:
+                chars.update(format_chars(literal, where))
+    return {c for c in chars if " " <= c <= "~"}
+
+
+# ===== U8g2 font =====
+
+def find_fonts_c(u8g2):
+    candidates = [u8g2] if u8g2 else [os.path.expanduser(d) for d in LIBRARY_DIRS]
+    for c in candidates:
+        if os.path.isfile(c):
+            return c
+        path = os.path.join(c, "src", "clib", "u8g2_fonts.c")
+        if os.path.isfile(path):
+            return path
+    raise SubsetError("u8g2_fonts.c not found - pass --u8g2 <U8g2 library folder>")
+
+
+def load_font(path, name):
+    with open(path, encoding="latin-1") as f:
+        text = f.read()
+    m = re.search(r"\b%s\[\d*\][^=]*=((?:\s*\"(?:[^\"\\]|\\.)*\")+)\s*;" % re.escape(name), text)
+    if not m:
+        raise SubsetError("%s not found in %s" % (name, path))
+    return decode_c_string("".join(re.findall(r"\"((?:[^\"\\]|\\.)*)\"", m.group(1))))
+
+
+def glyphs(font):
+    """(encoding, entry bytes) for every 8-bit glyph, and the offset of the
+    terminator from the end of the header."""
+    out = []
+    pos = HEADER_SIZE
+    while font[pos + 1] != 0:
+        size = font[pos + 1]
+        out.append((font[pos], font[pos:pos + size]))
+        pos += size
+    return out, pos - HEADER_SIZE
+
+
+def word(font, pos):
+    return (font[pos] << 8) | font[pos + 1]
+
+
+def subset_font(font, keep):
+    entries, end = glyphs(font)
+    available = {chr(e) for e, _ in entries}
+    missing = sorted(keep - available)
+    if missing:
+        raise SubsetError("stock font has no glyph for %r" % "".join(missing))
+
+    body = bytearray()
+    upper = lower = None
+    for enc, entry in entries:
+        if chr(enc) not in keep:
+            continue
+        if upper is None and enc >= ord("A"):
+            upper = len(body)
+        if lower is None and enc >= ord("a"):
+            lower = len(body)
+        body += entry
+    term = len(body)
+    upper = term if upper is None else upper
+    lower = term if lower is None else lower
+
+    # Terminator and unicode table are copied as they are
+    unicode_pos = term + word(font, POS_UNICODE) - end
+    header = bytearray(font[:HEADER_SIZE])
+    header[0] = sum(1 for e, _ in entries if chr(e) in keep)
+    for pos, value in ((POS_UPPER_A, upper), (POS_LOWER_A, lower), (POS_UNICODE, unicode_pos)):
+        header[pos:pos + 2] = bytes([value >> 8, value & 0xFF])
+    return bytes(header + body + font[HEADER_SIZE + end:])
+
+
+def lookup(font, ch):
+    """Glyph entry for ch the way u8g2_font_get_glyph_data() finds it."""
+    enc = ord(ch)
+    pos = HEADER_SIZE
+    if enc >= ord("a"):
+        pos += word(font, POS_LOWER_A)
+    elif enc >= ord("A"):
+        pos += word(font, POS_UPPER_A)
+    while font[pos + 1] != 0:
+        if font[pos] == enc:
+            return font[pos:pos + font[pos + 1]]
+        pos += font[pos + 1]
+    return None
+
+
+# ===== Output =====
+
+def c_string(data, width=64):
+    lines, cur = [], ""
+    for b in data:
+        c = chr(b)
+        if (c.isascii() and c.isalnum()) or (c in " !#$%&'()*+,-./:;<=>@[]^_`{|}~"):
+            piece = c
+        else:
+            piece = "\\%03o" % b
+        if len(cur) + len(piece) > width:
+            lines.append(cur)
+            cur = ""
+        cur += piece
+    lines.append(cur)
+    return "\n".join('  "%s"' % l for l in lines)
+
+
+def glyph_literal(chars):
+    return "".join(chars).replace("\\", "\\\\").replace('"', '\\"')
+
+
+def generate(chars, data, stock_size):
+    """Header text; data None writes the glyph list alone."""
+    glyph_str = glyph_literal(chars)
+    if data is None:
+        return "\n".join([
+            "/*",
+            " * Font subset - the glyphs the UI can draw, from %s" % FONT,
+            " * Generated by Tools/font_subset.py --glyphs-only - do not edit",
+            " * %d glyphs. No font data: display.h draws with the stock font until this" % len(chars),
+            " * is regenerated with U8g2 installed; ui_text.h checks UI text either way.",
+            " */",
+            "",
+            "#pragma once",
+            "",
+            '#define FONT_SUBSET_GLYPHS "%s"' % glyph_str,
+            "",
+        ])
+    return "\n".join([
+        "/*",
+        " * Font subset - %s reduced to the glyphs the UI can draw" % FONT,
+        " * Generated by Tools/font_subset.py - do not edit",
+        " * %d glyphs, %d bytes (stock font %d bytes, %d saved)"
+        % (len(chars), len(data), stock_size, stock_size - len(data)),
+        " */",
+        "",
+        "#pragma once",
+        "#include <U8g2lib.h>",
+        "",
+        '#define FONT_SUBSET_GLYPHS "%s"' % glyph_str,
+        "#define FONT_SUBSET_FONT %s" % SUBSET,
+        "",
+        'const uint8_t %s[%d] U8G2_FONT_SECTION("%s") =' % (SUBSET, len(data) + 1, SUBSET),
+        c_string(data) + ";",
+        "",
+    ])
+
+
+def existing_glyphs(path):
+    with open(path) as f:
+        m = re.search(r'#define FONT_SUBSET_GLYPHS "((?:[^"\\]|\\.)*)"', f.read())
+    return set(decode_c_string(m.group(1)).decode("latin-1")) if m else set()
+
+
+def read_drawn(path):
+    with open(path, encoding="latin-1") as f:
+        return {c for c in f.read() if " " <= c <= "~"}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("-o", "--output", default=OUTPUT, help="header to write (default: %(default)s)")
+    ap.add_argument("--u8g2", help="U8g2 library folder or u8g2_fonts.c")
+    ap.add_argument("--src", default=SOURCES, help="firmware sources (default: %(default)s)")
+    ap.add_argument("--extra", default="", help="more characters to keep")
+    ap.add_argument("--drawn", metavar="FILE",
+                    help="characters drawn in the simulator; fail if the scan misses any")
+    ap.add_argument("--check", action="store_true",
+                    help="only verify that --output covers every glyph the sources need")
+    ap.add_argument("--glyphs-only", action="store_true",
+                    help="write the glyph list without font data (no U8g2 needed)")
+    args = ap.parse_args()
+
+    try:
+        chars = sorted(scan_sources(args.src) | set(args.extra))
+        if args.drawn:
+            unscanned = sorted(read_drawn(args.drawn) - set(chars))
+            if unscanned:
+                raise SubsetError("the firmware drew %r, which the source scan does not find"
+                                  " - fix the scan or pass --extra" % "".join(unscanned))
+        if args.check:
+            if not os.path.exists(args.output):
+                raise SubsetError("%s missing - the firmware does not build without it" % args.output)
+            missing = sorted(set(chars) - existing_glyphs(args.output))
+            if missing:
+                raise SubsetError("%s lacks %r - regenerate it" % (args.output, "".join(missing)))
+            with open(args.output) as f:
+                font = "FONT_SUBSET_FONT" in f.read()
+            print("OK: %s covers all %d glyphs%s" % (args.output, len(chars),
+                  "" if font else " (glyph list only - stock font in use)"))
+            return
+
+        if args.glyphs_only:
+            with open(args.output, "w") as f:
+                f.write(generate(chars, None, 0))
+            print("%d glyphs, no font data - rerun without --glyphs-only to subset the font"
+                  % len(chars))
+            return
+
+        font = load_font(find_fonts_c(args.u8g2), FONT)
+        data = subset_font(font, set(chars))
+        for c in chars:
+            assert lookup(data, c) == lookup(font, c), c
+    except SubsetError as e:
+        sys.exit("font_subset: %s" % e)
+
+    with open(args.output, "w") as f:
+        f.write(generate(chars, data, len(font)))
+    saved = len(font) - len(data)
+    print("%d of %d glyphs, %d -> %d bytes: %d bytes of flash saved (%.0f%%)"
+          % (len(chars), len(glyphs(font)[0]), len(font), len(data), saved, 100.0 * saved / len(font)))
+
+
+if __name__ == "__main__":
+    main()
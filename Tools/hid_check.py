@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""
+Check the BadUSB typing engine against the benchmark script.
+
+Build the firmware with BADUSB_BENCHMARK and run "Benchmark" from the
+BadUSB menu. Then either:
+
+  Decode the HID reports the watch mirrors over USB serial (needs pyserial):
+
+      python3 hid_check.py --serial /dev/ttyACM0
+      python3 hid_check.py --log capture.txt        # a saved serial log
+
+  Reports are turned back into text the way a host keyboard driver does it
+  (only keys that were not held in the previous report produce a
+  character, in slot order), and compared with scripts/benchmark.txt.
+
+  Or let the real host be the capture: start
+
+      python3 hid_check.py --typed
+
+  in a terminal, run the benchmark and keep the terminal focused. The
+  typed lines are read from stdin, compared and timed.
+"""
+
+import argparse
+import os
+import sys
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SCRIPT = os.path.join(HERE, "scripts", "benchmark.txt")
+
+MOD_SHIFT = 0x22  # Left or right shift
+
+# US layout: HID usage -> (plain, shifted)
+US_KEYS = {0x28: ("\n", "\n"), 0x2B: ("\t", "\t"), 0x2C: (" ", " ")}
+for i, c in enumerate("abcdefghijklmnopqrstuvwxyz"):
+    US_KEYS[0x04 + i] = (c, c.upper())
+for i, (c, s) in enumerate(zip("1234567890", "!@#$%^&*()")):
+    US_KEYS[0x1E + i] = (c, s)
+for usage, c, s in [(0x2D, "-", "_"), (0x2E, "=", "+"), (0x2F, "[", "{"),
+                    (0x30, "]", "}"), (0x31, "\\", "|"), (0x33, ";", ":"),
+                    (0x34, "'", '"'), (0x35, "`", "~"), (0x36, ",", "<"),
+                    (0x37, ".", ">"), (0x38, "/", "?")]:
+    US_KEYS[usage] = (c, s)
+
+
+def expected_text(path=SCRIPT):
+    out = []
+    with open(path) as f:
+        for line in f:
+            line = line.rstrip("\r\n")
+            cmd = line.lstrip().split(" ", 1)[0]
+            if cmd == "STRING":
+                out.append(line.lstrip()[len("STRING "):])
+            elif cmd == "STRINGLN":
+                out.append(line.lstrip()[len("STRINGLN "):] + "\n")
+    return "".join(out)
+
+
+def decode_reports(reports):
+    """Host-side model: new key-downs in slot order, shifted by the report's modifiers."""
+    text = []
+    held = set()
+    for report in reports:
+        modifiers, keys = report[0], [k for k in report[2:8] if k]
+        shifted = bool(modifiers & MOD_SHIFT)
+        for k in keys:
+            if k not in held and k in US_KEYS:
+                text.append(US_KEYS[k][shifted])
+        held = set(keys)
+    return "".join(text)
+
+
+def parse_log(lines):
+    """Split serial lines into HID reports and BENCH stat lines."""
+    reports, bench = [], []
+    for line in lines:
+        line = line.strip()
+        if line.startswith("R "):
+            reports.append([int(b, 16) for b in line[2:].split()])
+        elif line.startswith("BENCH "):
+            bench.append(dict(kv.split("=") for kv in line[6:].split()))
+    return reports, bench
+
+
+def read_serial(port, idle=3.0):
+    import serial  # pyserial
+
+    lines = []
+    with serial.Serial(port, 115200, timeout=idle) as s:
+        print("Waiting for the benchmark - run it from the BadUSB menu", file=sys.stderr)
+        while True:
+            line = s.readline().decode("ascii", "replace")
+            if not line:
+                if lines:
+                    return lines
+                continue
+            lines.append(line)
+
+
+def read_typed(expected):
+    print("Run the benchmark now and keep this window focused", file=sys.stderr)
+    lines = []
+    start = None
+    for _ in range(expected.count("\n")):
+        line = sys.stdin.readline()
+        if start is None:
+            start = time.time()
+        lines.append(line)
+    return "".join(lines), time.time() - start
+
+
+def compare(expected, got):
+    if got == expected:
+        print("OK: %d characters match" % len(expected))
+        return True
+    n = next((i for i, (a, b) in enumerate(zip(expected, got)) if a != b),
+             min(len(expected), len(got)))
+    print("MISMATCH at character %d" % n)
+    print("  expected: %r" % expected[max(0, n - 20):n + 20])
+    print("  got:      %r" % got[max(0, n - 20):n + 20])
+    return False
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    src = ap.add_mutually_exclusive_group(required=True)
+    src.add_argument("--serial", metavar="PORT", help="read mirrored reports from the watch")
+    src.add_argument("--log", metavar="FILE", help="read a saved serial log")
+    src.add_argument("--typed", action="store_true", help="read the typed text from stdin")
+    ap.add_argument("--script", default=SCRIPT, help="benchmark script (default: %(default)s)")
+    args = ap.parse_args()
+
+    expected = expected_text(args.script)
+
+    if args.typed:
+        got, seconds = read_typed(expected)
+        ok = compare(expected, got)
+        # The first line is timed from its Enter, so leave it out of the rate
+        first = expected.index("\n") + 1
+        if seconds > 0:
+            print("host-measured rate: %.0f chars/s" % ((len(expected) - first) / seconds))
+        sys.exit(0 if ok else 1)
+
+    if args.serial:
+        lines = read_serial(args.serial)
+    else:
+        with open(args.log) as f:
+            lines = f.readlines()
+
+    reports, bench = parse_log(lines)
+    ok = compare(expected, decode_reports(reports))
+
+    chars = sum(int(b["chars"]) for b in bench)
+    us = sum(int(b["us"]) for b in bench)
+    print("%d reports, %d STRING runs" % (len(reports), len(bench)))
+    if us:
+        print("device-measured rate: %.0f chars/s (%.2f chars/report)"
+              % (chars * 1e6 / us, chars / max(1, sum(int(b["reports"]) for b in bench))))
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
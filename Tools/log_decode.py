@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+Decode the Mauther history log (logger.h) into CSV.
+
+Reads a dump straight from the watch over USB serial (needs pyserial):
+
+    python3 log_decode.py /dev/ttyACM0 > log.csv
+
+or from a file saved earlier with --raw:
+
+    python3 log_decode.py /dev/ttyACM0 --raw dump.bin
+    python3 log_decode.py dump.bin
+
+Output columns: time (ISO 8601, or uptime seconds if the watch has no RTC),
+distance_mm (empty when out of range), temp_c. Blocks whose CRC does not
+match are skipped with a warning.
+"""
+
+import argparse
+import datetime
+import struct
+import sys
+
+MAGIC = b"MLOG"
+HEADER = struct.Struct("<BIHHh")   # seq, time, interval_s, distance, temp_q
+ESCAPE = 0x80
+UNUSED = 0xFF
+DISTANCE_MAX_RANGE = 1200          # config.h
+EPOCH_2000 = datetime.datetime(2000, 1, 1)
+UPTIME_LIMIT = 10 * 365 * 86400    # Smaller times are uptime seconds
+
+
+def crc16(data):
+    """CRC-16/CCITT as avr-libc's _crc_ccitt_update, init 0xFFFF."""
+    crc = 0xFFFF
+    for d in data:
+        d ^= crc & 0xFF
+        d ^= (d << 4) & 0xFF
+        crc = (((d << 8) | (crc >> 8)) ^ (d >> 4) ^ (d << 3)) & 0xFFFF
+    return crc
+
+
+def block_valid(block):
+    return crc16(block[:-2]) == struct.unpack_from("<H", block, len(block) - 2)[0]
+
+
+def unzigzag(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+def read_varint(block, pos):
+    value = shift = 0
+    while True:
+        b = block[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return value, pos
+
+
+def decode_block(block):
+    """Yield (time, distance_mm, temp_quarters) for every sample in a block."""
+    _seq, t, interval, distance, temp = HEADER.unpack_from(block)
+    yield t, distance, temp
+
+    end = len(block) - 2   # CRC
+    pos = HEADER.size
+    while pos < end and block[pos] != UNUSED:
+        b = block[pos]
+        pos += 1
+        if b == ESCAPE:
+            dd, pos = read_varint(block, pos)
+            dt, pos = read_varint(block, pos)
+            dd, dt = unzigzag(dd), unzigzag(dt)
+        else:
+            dd, dt = unzigzag(b >> 3), unzigzag(b & 0x07)
+        distance = (distance + dd) & 0xFFFF
+        temp += dt
+        t += interval
+        yield t, distance, temp
+
+
+def parse_dump(data):
+    start = data.find(MAGIC)
+    if start < 0:
+        raise ValueError("no MLOG header in dump")
+    block_size, count = data[start + 4], data[start + 5]
+    body = data[start + 6:]
+    if len(body) < block_size * count:
+        raise ValueError("dump truncated: %d of %d blocks"
+                         % (len(body) // block_size, count))
+    return [body[i * block_size:(i + 1) * block_size] for i in range(count)]
+
+
+def read_serial(port, timeout=2.0):
+    import serial  # pyserial
+
+    with serial.Serial(port, 115200, timeout=timeout) as s:
+        s.reset_input_buffer()
+        s.write(b"L")
+        head = s.read(6)
+        if len(head) < 6 or head[:4] != MAGIC:
+            raise ValueError("watch did not answer (is FEATURE_LOGGER enabled?)")
+        return head + s.read(head[4] * head[5])
+
+
+def format_time(t):
+    if t < UPTIME_LIMIT:
+        return str(t)
+    return (EPOCH_2000 + datetime.timedelta(seconds=t)).isoformat()
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("source", help="serial port or dump file")
+    ap.add_argument("--raw", metavar="FILE", help="also save the raw dump")
+    args = ap.parse_args()
+
+    if args.source.startswith(("/dev/", "COM")):
+        data = read_serial(args.source)
+    else:
+        with open(args.source, "rb") as f:
+            data = f.read()
+
+    if args.raw:
+        with open(args.raw, "wb") as f:
+            f.write(data)
+
+    out = sys.stdout
+    out.write("time,distance_mm,temp_c\n")
+    for i, block in enumerate(parse_dump(data)):
+        if not block_valid(block):
+            sys.stderr.write("block %d: bad CRC, skipped\n" % i)
+            continue
+        for t, distance, temp in decode_block(block):
+            dist = "" if distance > DISTANCE_MAX_RANGE else str(distance)
+            out.write("%s,%s,%.2f\n" % (format_time(t), dist, temp / 4.0))
+
+
+if __name__ == "__main__":
+    main()
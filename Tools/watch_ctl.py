@@ -0,0 +1,294 @@
+#!/usr/bin/env python3
+"""
+Configure the watch and stream telemetry over the USB serial control protocol.
+
+Needs FEATURE_CONSOLE in config.h and pyserial. The protocol is described
+in Mauther/control.h: COBS frames between 0x00 delimiters with a
+CRC-16/CCITT, so it shares the port with watch_remote.py and debug output.
+
+    python3 watch_ctl.py /dev/ttyACM0 ping
+    python3 watch_ctl.py /dev/ttyACM0 status               # boot time, uptime, ...
+    python3 watch_ctl.py /dev/ttyACM0 time                 # read the RTC
+    python3 watch_ctl.py /dev/ttyACM0 time --set now       # host clock
+    python3 watch_ctl.py /dev/ttyACM0 time --set "2025-12-11 18:30:00"
+    python3 watch_ctl.py /dev/ttyACM0 get                  # list all settings
+    python3 watch_ctl.py /dev/ttyACM0 set alarm_mm 800
+    python3 watch_ctl.py /dev/ttyACM0 stream --period 50 --count 200 > run.csv
+
+stream writes CSV: host time, watch millis, distance (mm), temperature (C),
+worst loop pass (us), the button events since the previous row (oldest
+first, separated by ';') and whether more happened than a frame holds.
+"""
+
+import argparse
+import datetime
+import struct
+import sys
+import time
+
+PING, SET_TIME, GET_TIME, GET_SETTING, SET_SETTING, TELEMETRY, GET_STATUS = range(1, 8)
+RESPONSE = 0x80
+TELEMETRY_DATA = 0x90
+
+STATUS = ["ok", "bad length", "unknown type", "unknown setting id",
+          "bad value", "unavailable (feature off or hardware missing)"]
+ST_BAD_ID = 3
+BUTTONS = ["-", "UP", "DOWN", "SELECT"]
+EVENTS = ["-", "press", "release", "long"]
+
+
+class ControlError(Exception):
+    pass
+
+
+# ===== Framing =====
+
+def crc16(data):
+    """CRC-16/CCITT as avr-libc's _crc_ccitt_update, init 0xFFFF."""
+    crc = 0xFFFF
+    for d in data:
+        d ^= crc & 0xFF
+        d ^= (d << 4) & 0xFF
+        crc = (((d << 8) | (crc >> 8)) ^ (d >> 4) ^ (d << 3)) & 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code = 0
+    for b in data:
+        if b == 0:
+            out[code] = len(out) - code
+            code = len(out)
+            out.append(0)
+        else:
+            out.append(b)
+            if len(out) - code == 0xFF:
+                out[code] = 0xFF
+                code = len(out)
+                out.append(0)
+    out[code] = len(out) - code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def encode_frame(msg_type, payload=b""):
+    body = bytes([msg_type]) + payload
+    return b"\0" + cobs_encode(body + struct.pack("<H", crc16(body))) + b"\0"
+
+
+class FrameReader:
+    """Splits a byte stream at 0x00 and keeps the segments that decode and
+    pass the CRC - anything else on the port (debug text, screenshots) is
+    dropped."""
+
+    def __init__(self):
+        self.buf = bytearray()
+
+    def feed(self, data):
+        frames = []
+        for b in data:
+            if b != 0:
+                self.buf.append(b)
+                continue
+            body = cobs_decode(bytes(self.buf)) if self.buf else None
+            self.buf.clear()
+            if body and len(body) >= 3 and crc16(body[:-2]) == struct.unpack("<H", body[-2:])[0]:
+                frames.append((body[0], body[1:-2]))
+        return frames
+
+
+# ===== Requests =====
+
+class Watch:
+    def __init__(self, port):
+        self.port = port
+        self.reader = FrameReader()
+        self.pending = []
+
+    def frames(self, timeout):
+        """Yield frames until timeout seconds pass without one."""
+        deadline = time.time() + timeout
+        while True:
+            while self.pending:
+                yield self.pending.pop(0)
+                deadline = time.time() + timeout
+            if time.time() > deadline:
+                return
+            self.pending += self.reader.feed(self.port.read(self.port.in_waiting or 1))
+
+    def request(self, msg_type, payload=b"", timeout=1.0):
+        """Send a request and return the response payload after the status."""
+        self.port.write(encode_frame(msg_type, payload))
+        for t, body in self.frames(timeout):
+            if t == msg_type | RESPONSE:
+                if body[0] != 0:
+                    raise ControlError(STATUS[body[0]] if body[0] < len(STATUS) else "status %d" % body[0])
+                return body[1:]
+        raise ControlError("no response (is FEATURE_CONSOLE enabled?)")
+
+    def ping(self):
+        r = self.request(PING)
+        return r[0], r[1:].decode("ascii", "replace")
+
+    def status(self):
+        boot_us, wake_us, uptime_ms, loop_us, flags, alarm_us = struct.unpack(
+            "<IHIIBH", self.request(GET_STATUS))
+        return {"boot_us": boot_us, "wake_us": wake_us, "uptime_ms": uptime_ms,
+                "max_loop_us": loop_us, "cold_start": bool(flags & 1), "alarm_us": alarm_us}
+
+    def get_time(self):
+        return datetime.datetime(*struct.unpack("<HBBBBB", self.request(GET_TIME)))
+
+    def set_time(self, t):
+        self.request(SET_TIME, struct.pack("<HBBBBB", t.year, t.month, t.day,
+                                           t.hour, t.minute, t.second))
+
+    def get_setting(self, sid):
+        r = self.request(GET_SETTING, bytes([sid]))
+        _, value, lo, hi = struct.unpack("<Bhhh", r[:7])
+        return r[7:].decode("ascii", "replace"), value, lo, hi
+
+    def settings(self):
+        """(id, name, value, min, max) for every setting; None fields if
+        the setting is unavailable in this build."""
+        out = []
+        for sid in range(256):
+            try:
+                out.append((sid,) + self.get_setting(sid))
+            except ControlError as e:
+                if str(e) == STATUS[ST_BAD_ID]:
+                    break
+                out.append((sid, None, None, None, None))
+        return out
+
+    def set_setting(self, sid, value):
+        return struct.unpack("<Bh", self.request(SET_SETTING, struct.pack("<Bh", sid, value)))[1]
+
+    def telemetry(self, period_ms):
+        self.request(TELEMETRY, struct.pack("<H", period_ms))
+
+
+def parse_telemetry(body):
+    """(ms, distance, temp_c, loop_max_us, events, lost), None if malformed."""
+    if len(body) < 11 or len(body) != 11 + (body[10] & 0x7F):
+        return None
+    ms, distance, temp_q, loop_us, count = struct.unpack("<IHhHB", body[:11])
+    events = ";".join("%s %s" % (BUTTONS[(e >> 4) & 3], EVENTS[e & 3]) for e in body[11:])
+    return ms, distance, temp_q / 4.0, loop_us, events or "-", count >> 7
+
+
+# ===== Commands =====
+
+def find_setting(watch, name):
+    for sid, n, *_ in watch.settings():
+        if n == name:
+            return sid
+    raise ControlError("unknown setting: %s" % name)
+
+
+def cmd_ping(watch, args):
+    proto, version = watch.ping()
+    print("Mauther %s, protocol %d" % (version, proto))
+
+
+def cmd_status(watch, args):
+    s = watch.status()
+    print("boot to first frame: %.1f ms (%s start)"
+          % (s["boot_us"] / 1000.0, "cold" if s["cold_start"] else "warm"))
+    print("wake to first frame: %.1f ms" % (s["wake_us"] / 1000.0) if s["wake_us"]
+          else "wake to first frame: -")
+    print("uptime:              %.1f s" % (s["uptime_ms"] / 1000.0))
+    print("worst loop pass:     %d us" % s["max_loop_us"])
+    print("worst alarm latency: %d us (sample to zone update)" % s["alarm_us"])
+
+
+def cmd_time(watch, args):
+    if args.set:
+        t = (datetime.datetime.now() if args.set == "now"
+             else datetime.datetime.strptime(args.set, "%Y-%m-%d %H:%M:%S"))
+        watch.set_time(t)
+    print(watch.get_time().strftime("%Y-%m-%d %H:%M:%S"))
+
+
+def cmd_get(watch, args):
+    for sid, name, value, lo, hi in watch.settings():
+        if args.name and name != args.name:
+            continue
+        if name is None:
+            print("%2d  (unavailable)" % sid)
+        else:
+            print("%2d  %-10s %6d  [%d..%d]" % (sid, name, value, lo, hi))
+
+
+def cmd_set(watch, args):
+    value = watch.set_setting(find_setting(watch, args.name), args.value)
+    print("%s = %d" % (args.name, value))
+
+
+def cmd_stream(watch, args):
+    watch.telemetry(args.period)
+    print("host_s,ms,distance_mm,temp_c,loop_max_us,events,events_lost")
+    n = 0
+    try:
+        for t, body in watch.frames(max(2.0, args.period / 250.0)):
+            row = parse_telemetry(body) if t == TELEMETRY_DATA else None
+            if row is None:
+                continue
+            print("%.3f,%d,%d,%.2f,%d,%s,%d" % ((time.time(),) + row))
+            sys.stdout.flush()
+            n += 1
+            if args.count and n >= args.count:
+                break
+    except KeyboardInterrupt:
+        pass
+    finally:
+        watch.telemetry(0)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("port", help="serial port of the watch")
+    sub = ap.add_subparsers(dest="command", required=True)
+    sub.add_parser("ping", help="protocol and firmware version").set_defaults(fn=cmd_ping)
+    sub.add_parser("status", help="boot and wake times, uptime, worst loop pass and alarm latency").set_defaults(fn=cmd_status)
+    p = sub.add_parser("time", help="read or set the RTC")
+    p.add_argument("--set", metavar="now|'YYYY-MM-DD HH:MM:SS'")
+    p.set_defaults(fn=cmd_time)
+    p = sub.add_parser("get", help="list settings")
+    p.add_argument("name", nargs="?")
+    p.set_defaults(fn=cmd_get)
+    p = sub.add_parser("set", help="change a setting (clamped to its range)")
+    p.add_argument("name")
+    p.add_argument("value", type=int)
+    p.set_defaults(fn=cmd_set)
+    p = sub.add_parser("stream", help="telemetry as CSV on stdout")
+    p.add_argument("--period", type=int, default=100, help="ms between samples (min 20)")
+    p.add_argument("--count", type=int, default=0, help="stop after N samples")
+    p.set_defaults(fn=cmd_stream)
+    args = ap.parse_args()
+
+    import serial  # pyserial
+
+    with serial.Serial(args.port, 115200, timeout=0.05) as port:
+        try:
+            args.fn(Watch(port), args)
+        except ControlError as e:
+            sys.exit("watch_ctl: %s" % e)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""
+Drive the watch over USB serial: scripted button presses and screenshots.
+
+Needs FEATURE_CONSOLE in config.h and pyserial. Commands come from the
+command line or a file (-f), one per line or argument pair:
+
+    click UP|DOWN|SELECT     short press
+    hold UP|DOWN|SELECT      long press
+    wait MS                  pause on the host
+    shot FILE.pbm            save the next frame as a PBM image
+
+Example - open the menu, go to the second entry and grab both screens:
+
+    python3 watch_remote.py /dev/ttyACM0 click SELECT wait 200 shot menu.pbm \\
+        click DOWN click SELECT wait 300 shot distance.pbm
+"""
+
+import argparse
+import sys
+import time
+
+BUTTONS = {"UP": "u", "DOWN": "d", "SELECT": "s"}
+PBM_HEADER = b"P4\n128 64\n"
+PBM_BYTES = 128 * 64 // 8
+
+
+def parse(tokens):
+    cmds = []
+    it = iter(tokens)
+    for cmd in it:
+        arg = next(it, None)
+        if arg is None:
+            sys.exit("missing argument for %s" % cmd)
+        cmd = cmd.lower()
+        if cmd in ("click", "hold"):
+            if arg.upper() not in BUTTONS:
+                sys.exit("unknown button: %s" % arg)
+            key = BUTTONS[arg.upper()]
+            cmds.append(("send", key.upper() if cmd == "hold" else key))
+        elif cmd == "wait":
+            cmds.append(("wait", int(arg)))
+        elif cmd == "shot":
+            cmds.append(("shot", arg))
+        else:
+            sys.exit("unknown command: %s" % cmd)
+    return cmds
+
+
+def read_frame(port, timeout=2.0):
+    deadline = time.time() + timeout
+    buf = b""
+    while PBM_HEADER not in buf:
+        if time.time() > deadline:
+            raise TimeoutError("no frame received (is FEATURE_CONSOLE enabled?)")
+        buf += port.read(1)
+    body = port.read(PBM_BYTES)
+    if len(body) < PBM_BYTES:
+        raise TimeoutError("frame truncated")
+    return PBM_HEADER + body
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("port", help="serial port of the watch")
+    ap.add_argument("commands", nargs="*", help="commands, see above")
+    ap.add_argument("-f", "--file", help="read commands from a file")
+    args = ap.parse_args()
+
+    tokens = list(args.commands)
+    if args.file:
+        with open(args.file) as f:
+            for line in f:
+                if not line.strip().startswith("#"):
+                    tokens += line.split()
+    cmds = parse(tokens)
+
+    import serial  # pyserial
+
+    with serial.Serial(args.port, 115200, timeout=0.5) as port:
+        port.reset_input_buffer()
+        for cmd, arg in cmds:
+            if cmd == "send":
+                port.write(arg.encode())
+            elif cmd == "wait":
+                time.sleep(arg / 1000.0)
+            elif cmd == "shot":
+                port.reset_input_buffer()
+                port.write(b"p")
+                with open(arg, "wb") as f:
+                    f.write(read_frame(port))
+                print("saved %s" % arg)
+
+
+if __name__ == "__main__":
+    main()